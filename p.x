@@ -0,0 +1,56 @@
+
+Disassembly of section .text:
+
+0000000000000000 <.text>:
+   0:	0f 58 d1             	addps  %xmm1,%xmm2
+   3:	66 0f 58 18          	addpd  (%rax),%xmm3
+   7:	f3 45 0f 58 d1       	addss  %xmm9,%xmm10
+   c:	0f 29 44 24 10       	movaps %xmm0,0x10(%rsp)
+  11:	66 44 0f 6f 24 cf    	movdqa (%rdi,%rcx,8),%xmm12
+  17:	f3 0f 7f 0e          	movdqu %xmm1,(%rsi)
+  1b:	66 0f ef c0          	pxor   %xmm0,%xmm0
+  1f:	66 0f fe d1          	paddd  %xmm1,%xmm2
+  23:	66 0f 70 d1 1b       	pshufd $0x1b,%xmm1,%xmm2
+  28:	66 0f 38 00 d1       	pshufb %xmm1,%xmm2
+  2d:	66 0f 38 40 e3       	pmulld %xmm3,%xmm4
+  32:	66 0f 38 17 d1       	ptest  %xmm1,%xmm2
+  37:	66 0f 3a 63 0f 0c    	pcmpistri $0xc,(%rdi),%xmm1
+  3d:	66 0f 74 d1          	pcmpeqb %xmm1,%xmm2
+  41:	66 0f d7 c0          	pmovmskb %xmm0,%eax
+  45:	66 0f 6e c0          	movd   %eax,%xmm0
+  49:	66 48 0f 6e c0       	movq   %rax,%xmm0
+  4e:	66 48 0f 7e c0       	movq   %xmm0,%rax
+  53:	f3 0f 7e d1          	movq   %xmm1,%xmm2
+  57:	f2 48 0f 2a c0       	cvtsi2sd %rax,%xmm0
+  5c:	f3 0f 2a c0          	cvtsi2ss %eax,%xmm0
+  60:	f2 48 0f 2c c0       	cvttsd2si %xmm0,%rax
+  65:	0f c6 d1 44          	shufps $0x44,%xmm1,%xmm2
+  69:	66 0f 3a 16 c0 01    	pextrd $0x1,%xmm0,%eax
+  6f:	66 48 0f 3a 22 c0 01 	pinsrq $0x1,%rax,%xmm0
+  76:	66 0f 3a 14 00 03    	pextrb $0x3,%xmm0,(%rax)
+  7c:	66 0f 38 14 d1       	blendvps %xmm0,%xmm1,%xmm2
+  81:	66 0f 3a 0b d1 04    	roundsd $0x4,%xmm1,%xmm2
+  87:	66 0f 51 d1          	sqrtpd %xmm1,%xmm2
+  8b:	0f 50 c0             	movmskps %xmm0,%eax
+  8e:	66 0f 3a 0f d1 08    	palignr $0x8,%xmm1,%xmm2
+  94:	0f 14 d1             	unpcklps %xmm1,%xmm2
+  97:	0f c2 d1 01          	cmpltps %xmm1,%xmm2
+  9b:	66 0f 2e d1          	ucomisd %xmm1,%xmm2
+  9f:	0f 12 d1             	movhlps %xmm1,%xmm2
+  a2:	0f 12 08             	movlps (%rax),%xmm1
+  a5:	0f c3 07             	movnti %eax,(%rdi)
+  a8:	66 0f e7 07          	movntdq %xmm0,(%rdi)
+  ac:	0f 2b 07             	movntps %xmm0,(%rdi)
+  af:	66 0f 38 2a 07       	movntdqa (%rdi),%xmm0
+  b4:	0f 18 08             	prefetcht0 (%rax)
+  b7:	0f 18 47 40          	prefetchnta 0x40(%rdi)
+  bb:	0f 0d 08             	prefetchw (%rax)
+  be:	0f ae 38             	clflush (%rax)
+  c1:	66 0f ae 38          	clflushopt (%rax)
+  c5:	66 0f ae 30          	clwb   (%rax)
+  c9:	0f ae e8             	lfence
+  cc:	0f ae f8             	sfence
+  cf:	0f ae f0             	mfence
+  d2:	66 0f 73 d9 04       	psrldq $0x4,%xmm1
+  d7:	66 0f 72 f2 03       	pslld  $0x3,%xmm2
+  dc:	66 0f f3 d1          	psllq  %xmm1,%xmm2
@@ -15,70 +15,2693 @@
  * You should have received a copy of the GNU General Public License along
  * with this program; See COPYING file for copyright and license details.
  */
+#define _GNU_SOURCE
 #include <ctype.h>
+#include <dlfcn.h>
 #include <elf.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <string.h>
+#include <strings.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #define ALIGNTO8(X) (X + ((8 - (X % 8)) * ((X % 8) != 0)))
 #define OUTFILE_DEFAULT "a.out"
+/* zeroed bytes kept after the source so vector loads never leave the buffer */
+#define SRC_PADDING 64
+/* fills up to this many bytes are stored as plain data */
+#define FILL_INLINE_MAX 256
+/* the line number program's special opcodes, as the GNU assembler has them */
+#define LINE_BASE   -5
+#define LINE_RANGE  14
+#define OPCODE_BASE 13
+
+#ifndef ELFCOMPRESS_ZSTD
+#define ELFCOMPRESS_ZSTD 2
+#endif
 
 /* enums */
-enum { ID, LABEL, DIRECTIVE, CONSTANT, REGISTER, COMMA,
-       NEWLINE, ENDOFFILE, TYPES_COUNT };
+enum { ID, LABEL, DIRECTIVE, CONSTANT, REGISTER, COMMA, STRING, OPERATOR,
+       IMMEDIATE, NEWLINE, ENDOFFILE };
+enum { FRAG_DATA, FRAG_FILL, FRAG_FILE };
+enum {
+    OPERAND_R = 1, OPERAND_RM, OPERAND_M, OPERAND_ACC, OPERAND_CL,
+    OPERAND_ONE, OPERAND_R8, OPERAND_R16, OPERAND_R32, OPERAND_RM8,
+    OPERAND_RM16, OPERAND_RM32, OPERAND_IMM8, OPERAND_UIMM8, OPERAND_IMM,
+    OPERAND_IMM16, OPERAND_IMM64, OPERAND_REL32, OPERAND_TARGET,
+    OPERAND_RLQ, OPERAND_RMLQ, OPERAND_X, OPERAND_XM, OPERAND_XR,
+    OPERAND_XMM0, OPERAND_Y, OPERAND_YM, OPERAND_YR, OPERAND_XV, OPERAND_YV,
+    OPERAND_XI, OPERAND_YI, OPERAND_Z, OPERAND_ZM, OPERAND_ZR, OPERAND_ZV,
+    OPERAND_K, OPERAND_KM, OPERAND_KR, OPERAND_KV, OPERAND_RV, OPERAND_RL,
+    OPERAND_R64,
+    /* memory with a vector index, VSIB, of %xmm, %ymm or %zmm registers */
+    OPERAND_XS, OPERAND_YS, OPERAND_ZS,
+    /* avx512_insns: vectors of the row's length, or of a half, a quarter or
+       an eighth of it */
+    OPERAND_V, OPERAND_VM, OPERAND_VR, OPERAND_VV, OPERAND_H, OPERAND_HM,
+    OPERAND_QM, OPERAND_OM, OPERAND_VS, OPERAND_HS
+};
+/* the operand sizes a form takes, each flag is the size in bytes */
+enum {
+    INSN_B = 1, INSN_W = 2, INSN_L = 4, INSN_Q = 8, INSN_WL = 6,
+    INSN_WQ = 10, INSN_LQ = 12, INSN_WLQ = 14,
+    INSN_D64 = 16,     /* 64-bit by default, REX.W isn't needed */
+    INSN_PLUSR = 32,   /* the register is added to the opcode */
+    INSN_VEX = 64,     /* VEX encoded, 128-bit or scalar */
+    INSN_VEX_W = 128,  /* with VEX.W set */
+    INSN_VEX_L = 256,  /* with VEX.L set */
+    INSN_VEX256 = 320, /* INSN_VEX | INSN_VEX_L, 256-bit */
+    INSN_EVEX = 512,   /* EVEX encoded, VEX_W and VEX_L stand for its bits */
+    INSN_EVEX_LL = 1024, /* with EVEX.L'L = 2, 512-bit */
+    INSN_ER = 2048,    /* takes {rn-sae} and the other roundings */
+    INSN_SAE = 4096,   /* takes {sae} */
+    /* avx512_insns: the vector lengths forms are made for */
+    INSN_128 = 8192, INSN_256 = 16384, INSN_512 = 32768, INSN_VL = 57344,
+    INSN_NOMASK = 65536, /* takes no write mask */
+    INSN_REX_W = 131072  /* with REX.W set, whatever the operand size */
+};
+/* how EVEX scales a disp8: by the memory operand's share of the vector, or
+   by a fixed size */
+enum {
+    TUPLE_FV = 1, TUPLE_HV, TUPLE_FVM, TUPLE_HVM, TUPLE_QVM, TUPLE_OVM,
+    TUPLE_DUP, TUPLE_N1, TUPLE_N2, TUPLE_N4, TUPLE_N8, TUPLE_N16, TUPLE_N32
+};
+enum { ARG_REG = 1, ARG_IMM, ARG_MEM, ARG_ROUND };
+enum { REG_GPR = 1, REG_SEG, REG_RIP, REG_XMM, REG_YMM, REG_ZMM, REG_K };
+enum {
+    FIXUP_PCREL = 1, FIXUP_BRANCH = 2, FIXUP_SIGNED = 4, FIXUP_LEB128 = 8,
+    FIXUP_GOTPCRELX = 16, FIXUP_REX = 32
+};
+enum {
+    DW_CFA_advance_loc = 0x40, DW_CFA_offset = 0x80, DW_CFA_restore = 0xC0,
+    DW_CFA_nop = 0x00, DW_CFA_advance_loc1 = 0x02, DW_CFA_advance_loc2 = 0x03,
+    DW_CFA_advance_loc4 = 0x04, DW_CFA_restore_extended = 0x06,
+    DW_CFA_undefined = 0x07, DW_CFA_same_value = 0x08, DW_CFA_register = 0x09,
+    DW_CFA_remember_state = 0x0A, DW_CFA_restore_state = 0x0B,
+    DW_CFA_def_cfa = 0x0C, DW_CFA_def_cfa_register = 0x0D,
+    DW_CFA_def_cfa_offset = 0x0E, DW_CFA_offset_extended_sf = 0x11,
+    DW_CFA_val_offset = 0x14, DW_CFA_val_offset_sf = 0x15
+};
+enum {
+    DW_LNS_copy = 0x01, DW_LNS_advance_pc = 0x02, DW_LNS_advance_line = 0x03,
+    DW_LNS_set_file = 0x04, DW_LNS_set_column = 0x05,
+    DW_LNS_negate_stmt = 0x06, DW_LNS_set_basic_block = 0x07,
+    DW_LNS_const_add_pc = 0x08, DW_LNS_set_prologue_end = 0x0A,
+    DW_LNS_set_epilogue_begin = 0x0B, DW_LNS_set_isa = 0x0C,
+    DW_LNE_end_sequence = 0x01, DW_LNE_set_address = 0x02,
+    DW_LNE_set_discriminator = 0x04
+};
+enum {
+    LINE_STMT = 1, LINE_BASIC_BLOCK = 2, LINE_PROLOGUE_END = 4,
+    LINE_EPILOGUE_BEGIN = 8
+};
 
 /* structs */
+typedef struct {
+    int      type;
+    uint8_t *data;        /* FRAG_DATA: the bytes, FRAG_FILE: the mapping */
+    size_t   size;        /* the number of bytes written for the fragment */
+    size_t   capacity;
+    uint8_t  pattern[8];  /* FRAG_FILL: repeated until size is reached */
+    size_t   pattern_len;
+    int      fd;          /* FRAG_FILE: copied from fd at offset */
+    off_t    offset;
+} frag_t;
+
+typedef struct {
+    uint64_t offset;
+    uint32_t type;
+    size_t   section; /* against this section's symbol */
+    size_t   sym;     /* or against syms[sym - 1] when set */
+    int64_t  addend;
+} reloc_t;
+
+typedef struct {
+    char     *name;
+    uint32_t  type;
+    uint64_t  flags;
+    uint64_t  addralign;
+    uint64_t  entsize;
+    frag_t   *frags;      /* SHT_NOBITS sections have none */
+    size_t    frag_count;
+    size_t    size;
+    reloc_t  *relocs;
+    size_t    reloc_count;
+    size_t    base;       /* -ffunction-sections: split from this section */
+} section_t;
+
+typedef struct {
+    char     *name;
+    Elf64_Sym sym;
+    int       defined;
+    int       local;   /* declared with .local */
+    size_t    pad_seq; /* the .align right after it, which had no padding */
+} symbol_t;
+
+typedef struct {
+    int64_t value;
+    size_t  section; /* relative to this section, 0 when absolute */
+    size_t  sym;     /* or relative to syms[sym - 1] when set */
+    size_t  minus;   /* minus a location in this section, when set */
+    int     pending; /* refers to symbols that are not defined yet, or to
+                        locations that relaxation may still move */
+    int     reloc;   /* R_X86_64_PLT32 or _GOTPCREL for `@PLT`, `@GOTPCREL` */
+} expr_t;
+
+/* an expression parsed again once every label has its final value */
+typedef struct {
+    size_t   sym;     /* .size: the symbol being sized */
+    size_t   src;     /* where the expression starts in the source */
+    size_t   section; /* `.` where it appeared */
+    uint64_t dot;
+} deferred_t;
+
+/* a field that is filled in, or relocated, once every label is known */
+typedef struct {
+    deferred_t expr;
+    size_t     frag;   /* where the field is, in expr.section */
+    size_t     offset; /* within the fragment */
+    uint64_t   place;  /* within the section */
+    int        size;
+    int        flags;
+    int64_t    adjust; /* added to pc-relative values */
+} fixup_t;
+
+/* a jmp or jcc emitted with a rel32 target, made rel8 when it is near */
+typedef struct {
+    size_t  fixup;  /* of the rel32 field */
+    uint8_t opcode; /* of the rel8 form */
+} branch_t;
+
+/* the padding of an .align, sized again when the code before it moves */
+typedef struct {
+    size_t   section;
+    uint64_t start;
+    uint64_t len;
+    uint64_t align;
+    int64_t  max;   /* the most padding, none when 0 or less */
+    int64_t  fill;  /* the byte, NOPs in code when negative */
+    size_t   seq;   /* from 1, in the order they were written */
+} align_t;
+
+/* a range of a section's bytes replaced by a fragment */
+typedef struct {
+    uint64_t start;
+    uint64_t len;
+    frag_t   frag; /* may be empty */
+} splice_t;
+
+/* one CFI directive, and where in the function it takes effect */
+typedef struct {
+    uint64_t loc;
+    size_t   offset;  /* of its DW_CFA_* bytes in fde_t.insns */
+    size_t   len;
+    int      initial; /* may move into the CIE when at the very start */
+} cfi_row_t;
+
+/* the call frame information of one .cfi_startproc/.cfi_endproc pair */
+typedef struct {
+    size_t     section;
+    uint64_t   start;
+    uint64_t   end;
+    int        signal_frame;
+    uint64_t   return_column;
+    uint8_t    personality_encoding;
+    size_t     personality;     /* syms[personality - 1] */
+    size_t     personality_src;
+    uint8_t    lsda_encoding;
+    size_t     lsda_src;
+    uint8_t   *insns;
+    size_t     insns_len;
+    cfi_row_t *rows;
+    size_t     row_count;
+    int64_t    cfa_offset;
+    int64_t   *remembered;      /* cfa_offset at each .cfi_remember_state */
+    size_t     remembered_count;
+} fde_t;
+
+/* .file N entries, the line number program's file table */
+typedef struct {
+    char  *name;
+    size_t dir;  /* index in elf64_obj_t.dirs */
+} file_t;
+
+/* a row of the line number program */
+typedef struct {
+    size_t   section;
+    uint64_t loc;
+    uint64_t file;
+    uint64_t line;
+    uint64_t column;
+    uint64_t isa;
+    uint64_t discriminator;
+    int      flags;
+} line_t;
+
+typedef struct {
+    int debug;          /* -g, line information for the assembly source itself */
+    int compress_debug; /* ELFCOMPRESS_* for debug sections, 0 for none */
+    int function_sections; /* -ffunction-sections */
+    char **order;       /* --symbol-ordering-file, function names */
+    size_t order_count;
+    uint64_t align_loops;     /* -falign-loops=N:M, 0 when not aligning */
+    uint64_t align_loops_max; /* the most padding for it, M - 1 */
+    int optimize;       /* -O level, picking shorter encodings */
+    int optimize_space; /* -Os */
+} options_t;
+
 typedef struct {
     Elf64_Ehdr *ehdr;
-    uint8_t    *assembly;
-    size_t      assembly_size;
-    Elf64_Sym  *syms;
+    options_t  *options;
+    section_t  *sections; /* sections[0] is the null section */
     size_t      section_count;
+    size_t      section;  /* the section being assembled into */
+    size_t      previous; /* for .previous */
+    size_t     *section_stack; /* .pushsection, pairs of section, previous */
+    size_t      section_depth;
+    symbol_t   *syms;
+    size_t      sym_count;
+    deferred_t *deferred;
+    size_t      deferred_count;
+    fixup_t    *fixups;
+    size_t      fixup_count;
+    fde_t      *fdes;
+    size_t      fde_count;
+    expr_t     *loop_heads;  /* targets of backward jumps */
+    size_t      loop_head_count;
+    branch_t   *branches;
+    size_t      branch_count;
+    align_t    *aligns;
+    size_t      align_count;
+    /* the labels defined since the last byte of label_section */
+    size_t     *labels;
     size_t      label_count;
-    size_t      glabel_count;
-    char      **strtab;
-    size_t      strtab_count;
-    char      **shstrtab;
-    size_t      shstrtab_count;
-    Elf64_Shdr *shdrs;
-    size_t      shdr_count;
+    size_t      label_section;
+    uint64_t    label_end;
+    int         cfi_open;    /* inside .cfi_startproc */
+    int         no_eh_frame; /* .cfi_sections without .eh_frame */
+    int         debug_frame; /* .cfi_sections with .debug_frame */
+    file_t     *files;       /* files[0] is the primary source file */
+    size_t      file_count;
+    char      **dirs;        /* dirs[0] is the compilation directory */
+    size_t      dir_count;
+    line_t     *lines;
+    size_t      line_count;
+    line_t      loc;         /* the last .loc */
+    int         loc_pending; /* until an instruction takes it */
+    /* the view number of the last .loc, 0 when it has an address of its own */
+    uint64_t    view;
+    size_t      view_section;
+    uint64_t    view_end;
+    int         gen_debug;   /* generating rows for -g */
+    /*
+     * The last .align, so -ffunction-sections can move it along with the
+     * function label that follows it.
+     */
+    size_t      pad_section;
+    uint64_t    pad_end;
+    size_t      pad_len;
+    uint64_t    pad_align;
+    uint64_t    pad_addralign; /* of pad_section before the .align */
+    /* the end of the last jmp, ret or ud2, nothing falls through it */
+    size_t      stop_section;
+    uint64_t    stop_end;
+    deferred_t *evaluating;  /* set while a deferred expression is parsed */
 } elf64_obj_t;
 
+/* a debug section being compressed by a worker thread */
+typedef struct {
+    section_t *sec;
+    int        type;    /* ELFCOMPRESS_* */
+    int        started; /* there is a thread to join */
+    pthread_t  thread;
+    uint8_t   *data;    /* the Elf64_Chdr and the compressed contents */
+    size_t     size;    /* 0 when the section is better left as is */
+} compress_job_t;
+
+/* one form of an instruction */
+typedef struct {
+    const char *mnemonic;
+    uint32_t    opcode;        /* with its mandatory prefix and escape bytes */
+    int         ext;           /* the ModRM reg field when not a register */
+    int         flags;
+    int         operand_count;
+    int         operands[4];   /* OPERAND_*, in AT&T order */
+    int         tuple;         /* TUPLE_*, of EVEX forms */
+} insn_t;
+
+/* an operand as written */
+typedef struct {
+    int     type;     /* ARG_* */
+    int     kind;     /* ARG_REG: REG_* */
+    int     reg;      /* ARG_ROUND: {rn-sae} to {rz-sae} are 0-3, {sae} 4 */
+    int     size;     /* of the register */
+    int     high;     /* %ah, %ch, %dh or %bh */
+    int     rex;      /* needs a REX prefix to be encoded */
+    int     indirect; /* `*`, the target of a jump or call */
+    int     base;     /* ARG_MEM: the registers, -1 when not given */
+    int     index;
+    int     vsib;     /* the index is a vector register, its REG_* kind */
+    int     scale;
+    int     rip;      /* relative to %rip */
+    int     addr32;   /* with 32-bit registers */
+    uint8_t segment;  /* the override prefix, 0 for none */
+    expr_t  value;    /* the immediate or displacement */
+    size_t  src;      /* where its expression starts in the source */
+    int     mask;     /* {%k1}, the write mask, 0 for none */
+    int     zeroing;  /* {z} */
+    int     broadcast; /* {1to16}, the element count */
+} arg_t;
+
 typedef struct {
-    int    type;
-    int    len;
-    size_t start;
+    int      type;
+    int      len;
+    size_t   start;
+    uint64_t value; /* CONSTANT: its value, STRING: the escape count */
 } token_t;
 
 typedef struct {
-    char  *src;
-    size_t i;
+    char       *src;
+    size_t      i;
+    const char *name;
+    size_t      line;     /* the line number at line_pos */
+    size_t      line_pos;
 } unit_t;
 
 /* function declarations */
-static int assemble_file(char *filename, char *outfile);
-static int assemble_x86_64(char *src, char *outfile);
-static int default_shdrtabs_x86_64(elf64_obj_t *obj);
-static int default_symtabs_x86_64(elf64_obj_t *obj);
+static void add_cfi_row(fde_t *fde, uint64_t loc, const uint8_t *insn,
+                        size_t len, int initial);
+static int add_fixup(elf64_obj_t *obj, size_t src, uint64_t dot, int size,
+                     int flags, int64_t adjust);
+static void add_line(unit_t *unit, elf64_obj_t *obj, size_t pos);
+static void add_reloc(elf64_obj_t *obj, uint64_t offset, uint32_t type,
+                      size_t section, int64_t addend);
+static size_t add_section(elf64_obj_t *obj, const char *name, uint32_t type,
+                          uint64_t flags);
+static int align_loops(elf64_obj_t *obj);
+static int assemble_file(char *filename, char *outfile, options_t *options);
+static int assemble_x86_64(char *src, char *filename, char *outfile,
+                           options_t *options);
+static int compare_aligns(const void *a, const void *b);
+static int compare_insns(const void *a, const void *b);
+static void *compress_section(void *arg);
+static size_t decode_string(const char *s, size_t len, uint8_t *out);
+static int default_sections_x86_64(elf64_obj_t *obj);
+static int disp8_scale(const insn_t *insn, const arg_t *rm);
+static int eh_pointer_size(uint8_t encoding, int *flags);
+static int emit_align(elf64_obj_t *obj, uint64_t align, int64_t fill,
+                      int64_t max);
+static void emit_bytes(elf64_obj_t *obj, const uint8_t *bytes, size_t len);
+static void emit_debug_info(unit_t *unit, elf64_obj_t *obj,
+                            uint64_t line_offset);
+static int emit_debug_line(unit_t *unit, elf64_obj_t *obj);
+static int emit_eh_frame(elf64_obj_t *obj);
+static int emit_fill(elf64_obj_t *obj, const uint8_t *pattern,
+                     size_t pattern_len, size_t count);
+static int emit_frame(elf64_obj_t *obj, int debug);
+static int encode_insn(elf64_obj_t *obj, const insn_t *insn, arg_t *args,
+                       int prefix, int round, int size, uint64_t dot);
+static size_t encode_sleb128(uint8_t *p, int64_t value);
+static size_t encode_uleb128(uint8_t *p, uint64_t value);
+static int evaluate_deferred(unit_t *unit, elf64_obj_t *obj);
+static insn_t evex_form(const insn_t *insn, int length);
+static int expr_constant(const expr_t *value);
+static size_t expr_location(elf64_obj_t *obj, expr_t *expr, int64_t *offset);
+static void fill_nops(uint8_t *p, size_t len);
+static void function_section(elf64_obj_t *obj, symbol_t *sym);
+static const insn_t **find_insns(const char *mnemonic, size_t *count);
+static size_t find_section(elf64_obj_t *obj, const char *name);
+static symbol_t *find_symbol(elf64_obj_t *obj, const char *name);
+static symbol_t *get_symbol(elf64_obj_t *obj, const char *name);
 static int lex(unit_t *unit, token_t *token);
 static int lex_constant(unit_t *unit, token_t *token);
 static int lex_id(unit_t *unit, token_t *token);
+static int lex_string(unit_t *unit, token_t *token);
+static int load_zstd();
+static int lockable(const insn_t *insn, const arg_t *args, int arg_count);
+static int match_arg(int operand, const arg_t *arg, int *size);
+static int match_evex(const insn_t *insn, const arg_t *args, int arg_count,
+                      int round);
+static int match_imm(int operand, const arg_t *arg, int size);
+static const insn_t *match_insn(const insn_t **forms, size_t count,
+                                arg_t *args, int arg_count, int round,
+                                int *size);
+static int may_relax(elf64_obj_t *obj, size_t section, uint64_t a, uint64_t b);
+static int needs_evex(const arg_t *args, int arg_count);
+static int needs_vex3(const insn_t *insn, const arg_t *args, int size);
+static int operator_level(unit_t *unit, token_t *token);
+static const char *optimize_insn(elf64_obj_t *obj, const char *mnemonic,
+                                 arg_t *args, int count, int *size);
+static const char *optimize_vector(elf64_obj_t *obj, const char *mnemonic,
+                                   arg_t *args, int count);
+static int order_functions(elf64_obj_t *obj);
+static int parse_absolute(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                          int64_t *value);
+static int parse_align(unit_t *unit, elf64_obj_t *obj, int power);
+static int parse_arg(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                     arg_t *arg);
+static int parse_binary(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                        expr_t *value, int level);
+static int parse_binding(unit_t *unit, elf64_obj_t *obj, int binding,
+                         int visibility);
+static int parse_cfi(unit_t *unit, elf64_obj_t *obj, const char *directive);
+static int parse_comm(unit_t *unit, elf64_obj_t *obj, int local);
+static int parse_data(unit_t *unit, elf64_obj_t *obj, int size);
+static int parse_decorators(unit_t *unit, token_t *token, arg_t *arg);
+static int parse_dwarf_register(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                                uint64_t *reg);
+static int parse_expression(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                            expr_t *value);
+static int parse_file(unit_t *unit, elf64_obj_t *obj);
+static int parse_fill(unit_t *unit, elf64_obj_t *obj, int fill);
+static int parse_ident(unit_t *unit, elf64_obj_t *obj);
+static int parse_incbin(unit_t *unit, elf64_obj_t *obj);
+static int parse_instruction(unit_t *unit, elf64_obj_t *obj,
+                             const char *mnemonic);
+static int parse_leb128(unit_t *unit, elf64_obj_t *obj, int is_signed);
+static int parse_loc(unit_t *unit, elf64_obj_t *obj);
+static int parse_operand(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                         expr_t *value);
+static int parse_register(unit_t *unit, token_t *token, arg_t *arg);
+static int parse_section(unit_t *unit, elf64_obj_t *obj);
+static int parse_size(unit_t *unit, elf64_obj_t *obj);
+static int parse_strings(unit_t *unit, elf64_obj_t *obj, int terminate);
+static int parse_symbol(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                        symbol_t **sym);
+static int parse_type(unit_t *unit, elf64_obj_t *obj);
 static int parse_x86_64(unit_t *unit, elf64_obj_t *obj);
+static int relax_branches(unit_t *unit, elf64_obj_t *obj);
+static int repeatable(const insn_t *insn);
+static uint8_t *reserve_bytes(elf64_obj_t *obj, size_t len);
+static int read_symbol_order(options_t *options, const char *filename);
+static int resolve_fixups(unit_t *unit, elf64_obj_t *obj);
+static size_t scan_string(const char *s);
+static void section_defaults(const char *name, uint32_t *type,
+                             uint64_t *flags);
+static void set_section(elf64_obj_t *obj, size_t index);
+static uint64_t shift_before(const uint64_t *at, const size_t *seqs,
+                             const uint64_t *added, size_t n, uint64_t offset,
+                             size_t seq);
+static uint64_t shift_offset(const uint64_t *at, const uint64_t *added,
+                             size_t n, uint64_t offset);
+static void shift_section(elf64_obj_t *obj, size_t section, const uint64_t *at,
+                          const size_t *seqs, const uint64_t *added, size_t n);
+static void shrink_bytes(elf64_obj_t *obj, size_t len);
+static int size_leb128(unit_t *unit, elf64_obj_t *obj);
 static void skip_comments(unit_t *unit);
+static void splice_section(section_t *sec, splice_t *splices, size_t n);
+static int token_is(unit_t *unit, token_t *token, const char *text);
 static void usage();
+static int write_blob(FILE *fd, frag_t *frag);
 static int write_file_x86_64(char *outfile, elf64_obj_t *obj);
+static int write_frags(FILE *fd, section_t *sec);
+static int write_fill(FILE *fd, const uint8_t *pattern, size_t pattern_len,
+                      size_t len);
+static int write_padding(FILE *fd, size_t len);
+static int write_sections(FILE *fd, elf64_obj_t *obj, const Elf64_Shdr *shdrs,
+                          const compress_job_t *jobs, int compressed,
+                          size_t *written);
 
 /* variables */
-static const char *token_types[TYPES_COUNT] = {
-    "Identifier", "Label", "Directive", "Constant", "Register", "Comma",
-    "NewLine", "EndOfFile"
+static const char *gpr_names[4][16] = {
+    { "al", "cl", "dl", "bl", "spl", "bpl", "sil", "dil", "r8b", "r9b",
+      "r10b", "r11b", "r12b", "r13b", "r14b", "r15b" },
+    { "ax", "cx", "dx", "bx", "sp", "bp", "si", "di", "r8w", "r9w", "r10w",
+      "r11w", "r12w", "r13w", "r14w", "r15w" },
+    { "eax", "ecx", "edx", "ebx", "esp", "ebp", "esi", "edi", "r8d", "r9d",
+      "r10d", "r11d", "r12d", "r13d", "r14d", "r15d" },
+    { "rax", "rcx", "rdx", "rbx", "rsp", "rbp", "rsi", "rdi", "r8", "r9",
+      "r10", "r11", "r12", "r13", "r14", "r15" }
+};
+
+/* the condition codes, jcc, setcc and cmovcc are made for each name */
+static const struct {
+    const char *name;
+    int         code;
+} conditions[] = {
+    { "o",   0x0 }, { "no",  0x1 }, { "b",   0x2 }, { "c",   0x2 },
+    { "nae", 0x2 }, { "ae",  0x3 }, { "nb",  0x3 }, { "nc",  0x3 },
+    { "e",   0x4 }, { "z",   0x4 }, { "ne",  0x5 }, { "nz",  0x5 },
+    { "be",  0x6 }, { "na",  0x6 }, { "a",   0x7 }, { "nbe", 0x7 },
+    { "s",   0x8 }, { "ns",  0x9 }, { "p",   0xA }, { "pe",  0xA },
+    { "np",  0xB }, { "po",  0xB }, { "l",   0xC }, { "nge", 0xC },
+    { "ge",  0xD }, { "nl",  0xD }, { "le",  0xE }, { "ng",  0xE },
+    { "g",   0xF }, { "nle", 0xF }
+};
+
+/* the forms of each mnemonic are tried in order, the shorter ones first */
+static const insn_t insns[] = {
+    { "add",     0x83,     0, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "add",     0x05,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "add",     0x81,     0, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "add",     0x04,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "add",     0x80,     0, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "add",     0x01,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "add",     0x00,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "add",     0x03,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "add",     0x02,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "or",      0x83,     1, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "or",      0x0D,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "or",      0x81,     1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "or",      0x0C,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "or",      0x80,     1, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "or",      0x09,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "or",      0x08,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "or",      0x0B,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "or",      0x0A,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "adc",     0x83,     2, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "adc",     0x15,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "adc",     0x81,     2, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "adc",     0x14,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "adc",     0x80,     2, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "adc",     0x11,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "adc",     0x10,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "adc",     0x13,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "adc",     0x12,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "sbb",     0x83,     3, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "sbb",     0x1D,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "sbb",     0x81,     3, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "sbb",     0x1C,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "sbb",     0x80,     3, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "sbb",     0x19,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "sbb",     0x18,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "sbb",     0x1B,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "sbb",     0x1A,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "and",     0x83,     4, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "and",     0x25,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "and",     0x81,     4, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "and",     0x24,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "and",     0x80,     4, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "and",     0x21,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "and",     0x20,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "and",     0x23,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "and",     0x22,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "sub",     0x83,     5, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "sub",     0x2D,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "sub",     0x81,     5, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "sub",     0x2C,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "sub",     0x80,     5, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "sub",     0x29,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "sub",     0x28,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "sub",     0x2B,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "sub",     0x2A,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "xor",     0x83,     6, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "xor",     0x35,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "xor",     0x81,     6, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "xor",     0x34,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "xor",     0x80,     6, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "xor",     0x31,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "xor",     0x30,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "xor",     0x33,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "xor",     0x32,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "cmp",     0x83,     7, INSN_WLQ, 2, { OPERAND_IMM8, OPERAND_RM } },
+    { "cmp",     0x3D,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "cmp",     0x81,     7, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "cmp",     0x3C,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "cmp",     0x80,     7, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "cmp",     0x39,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "cmp",     0x38,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "cmp",     0x3B,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "cmp",     0x3A,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "bsf",     0x0FBC,  -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "bsr",     0x0FBD,  -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "bswap",   0x0FC8,  -1, INSN_LQ | INSN_PLUSR, 1, { OPERAND_R } },
+    { "bt",      0x0FA3,  -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "bt",      0x0FBA,   4, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "bts",     0x0FAB,  -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "bts",     0x0FBA,   5, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "cmps",    0xA7,    -1, INSN_WLQ, 0 },
+    { "cmps",    0xA6,    -1, INSN_B, 0 },
+    { "cmpsd",   0xA7,    -1, INSN_L, 0 },
+    { "cmpxchg", 0x0FB1,  -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "cmpxchg", 0x0FB0,  -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "cmpxchg8b", 0x0FC7, 1, 0, 1, { OPERAND_M } },
+    { "cmpxchg16b", 0x0FC7, 1, INSN_Q, 1, { OPERAND_M } },
+    { "cpuid",   0x0FA2,  -1, 0, 0 },
+    { "btr",     0x0FB3,  -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "btr",     0x0FBA,   6, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "btc",     0x0FBB,  -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "btc",     0x0FBA,   7, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "call",    0xE8,    -1, INSN_D64, 1, { OPERAND_REL32 } },
+    { "call",    0xFF,     2, INSN_Q | INSN_D64, 1, { OPERAND_TARGET } },
+    { "cbtw",    0x98,    -1, INSN_W, 0 },
+    { "cbw",     0x98,    -1, INSN_W, 0 },
+    { "cwtl",    0x98,    -1, INSN_L, 0 },
+    { "cwde",    0x98,    -1, INSN_L, 0 },
+    { "cltq",    0x98,    -1, INSN_Q, 0 },
+    { "cdqe",    0x98,    -1, INSN_Q, 0 },
+    { "cwtd",    0x99,    -1, INSN_W, 0 },
+    { "cwd",     0x99,    -1, INSN_W, 0 },
+    { "cltd",    0x99,    -1, INSN_L, 0 },
+    { "cdq",     0x99,    -1, INSN_L, 0 },
+    { "cqto",    0x99,    -1, INSN_Q, 0 },
+    { "cqo",     0x99,    -1, INSN_Q, 0 },
+    { "clc",     0xF8,    -1, 0, 0 },
+    { "cld",     0xFC,    -1, 0, 0 },
+    { "cli",     0xFA,    -1, 0, 0 },
+    { "clflush", 0x0FAE,   7, 0, 1, { OPERAND_M } },
+    { "clflushopt", 0x660FAE, 7, 0, 1, { OPERAND_M } },
+    { "clwb",    0x660FAE, 6, 0, 1, { OPERAND_M } },
+    { "cmc",     0xF5,    -1, 0, 0 },
+    { "dec",     0xFF,     1, INSN_WLQ, 1, { OPERAND_RM } },
+    { "dec",     0xFE,     1, INSN_B, 1, { OPERAND_RM } },
+    { "inc",     0xFF,     0, INSN_WLQ, 1, { OPERAND_RM } },
+    { "inc",     0xFE,     0, INSN_B, 1, { OPERAND_RM } },
+    { "not",     0xF7,     2, INSN_WLQ, 1, { OPERAND_RM } },
+    { "not",     0xF6,     2, INSN_B, 1, { OPERAND_RM } },
+    { "neg",     0xF7,     3, INSN_WLQ, 1, { OPERAND_RM } },
+    { "neg",     0xF6,     3, INSN_B, 1, { OPERAND_RM } },
+    { "mul",     0xF7,     4, INSN_WLQ, 1, { OPERAND_RM } },
+    { "mul",     0xF6,     4, INSN_B, 1, { OPERAND_RM } },
+    { "div",     0xF7,     6, INSN_WLQ, 1, { OPERAND_RM } },
+    { "div",     0xF6,     6, INSN_B, 1, { OPERAND_RM } },
+    { "idiv",    0xF7,     7, INSN_WLQ, 1, { OPERAND_RM } },
+    { "idiv",    0xF6,     7, INSN_B, 1, { OPERAND_RM } },
+    { "imul",    0xF7,     5, INSN_WLQ, 1, { OPERAND_RM } },
+    { "imul",    0xF6,     5, INSN_B, 1, { OPERAND_RM } },
+    { "imul",    0x0FAF,  -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "imul",    0x6B,    -1, INSN_WLQ, 3, { OPERAND_IMM8, OPERAND_RM, OPERAND_R } },
+    { "imul",    0x69,    -1, INSN_WLQ, 3, { OPERAND_IMM, OPERAND_RM, OPERAND_R } },
+    { "hlt",     0xF4,    -1, 0, 0 },
+    { "int",     0xCD,    -1, 0, 1, { OPERAND_UIMM8 } },
+    { "int3",    0xCC,    -1, 0, 0 },
+    { "jmp",     0xE9,    -1, INSN_D64, 1, { OPERAND_REL32 } },
+    { "jmp",     0xFF,     4, INSN_Q | INSN_D64, 1, { OPERAND_TARGET } },
+    { "lahf",    0x9F,    -1, 0, 0 },
+    { "lea",     0x8D,    -1, INSN_WLQ, 2, { OPERAND_M, OPERAND_R } },
+    { "leave",   0xC9,    -1, INSN_D64, 0 },
+    { "lfence",  0x0FAEE8, -1, 0, 0 },
+    { "lock",    0xF0,    -1, 0, 0 },
+    { "lods",    0xAD,    -1, INSN_WLQ, 0 },
+    { "lods",    0xAC,    -1, INSN_B, 0 },
+    { "mfence",  0x0FAEF0, -1, 0, 0 },
+    { "mov",     0x89,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "mov",     0x88,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "mov",     0x8B,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "mov",     0x8A,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "mov",     0xB8,    -1, INSN_WL | INSN_PLUSR, 2, { OPERAND_IMM, OPERAND_R } },
+    { "mov",     0xB0,    -1, INSN_B | INSN_PLUSR, 2, { OPERAND_IMM, OPERAND_R } },
+    { "mov",     0xC7,     0, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "mov",     0xC6,     0, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "mov",     0xB8,    -1, INSN_Q | INSN_PLUSR, 2, { OPERAND_IMM64, OPERAND_R } },
+    { "movabs",  0xB8,    -1, INSN_Q | INSN_PLUSR, 2, { OPERAND_IMM64, OPERAND_R } },
+    { "movnti",  0x0FC3,  -1, INSN_LQ, 2, { OPERAND_R, OPERAND_M } },
+    { "movs",    0xA5,    -1, INSN_WLQ, 0 },
+    { "movs",    0xA4,    -1, INSN_B, 0 },
+    { "movsd",   0xA5,    -1, INSN_L, 0 },
+    { "movsbw",  0x0FBE,  -1, INSN_W, 2, { OPERAND_RM8, OPERAND_R } },
+    { "movsbl",  0x0FBE,  -1, INSN_L, 2, { OPERAND_RM8, OPERAND_R } },
+    { "movsbq",  0x0FBE,  -1, INSN_Q, 2, { OPERAND_RM8, OPERAND_R } },
+    { "movswl",  0x0FBF,  -1, INSN_L, 2, { OPERAND_RM16, OPERAND_R } },
+    { "movswq",  0x0FBF,  -1, INSN_Q, 2, { OPERAND_RM16, OPERAND_R } },
+    { "movslq",  0x63,    -1, INSN_Q, 2, { OPERAND_RM32, OPERAND_R } },
+    { "movsx",   0x0FBE,  -1, INSN_WLQ, 2, { OPERAND_R8, OPERAND_R } },
+    { "movsx",   0x0FBF,  -1, INSN_LQ, 2, { OPERAND_R16, OPERAND_R } },
+    { "movsx",   0x63,    -1, INSN_Q, 2, { OPERAND_R32, OPERAND_R } },
+    { "movsxd",  0x63,    -1, INSN_Q, 2, { OPERAND_RM32, OPERAND_R } },
+    { "movzbw",  0x0FB6,  -1, INSN_W, 2, { OPERAND_RM8, OPERAND_R } },
+    { "movzbl",  0x0FB6,  -1, INSN_L, 2, { OPERAND_RM8, OPERAND_R } },
+    { "movzbq",  0x0FB6,  -1, INSN_Q, 2, { OPERAND_RM8, OPERAND_R } },
+    { "movzwl",  0x0FB7,  -1, INSN_L, 2, { OPERAND_RM16, OPERAND_R } },
+    { "movzwq",  0x0FB7,  -1, INSN_Q, 2, { OPERAND_RM16, OPERAND_R } },
+    { "movzx",   0x0FB6,  -1, INSN_WLQ, 2, { OPERAND_R8, OPERAND_R } },
+    { "movzx",   0x0FB7,  -1, INSN_LQ, 2, { OPERAND_R16, OPERAND_R } },
+    { "nop",     0x90,    -1, 0, 0 },
+    { "nop",     0x0F1F,   0, INSN_WL, 1, { OPERAND_RM } },
+    { "pause",   0xF390,  -1, 0, 0 },
+    { "pop",     0x58,    -1, INSN_WQ | INSN_D64 | INSN_PLUSR, 1, { OPERAND_R } },
+    { "pop",     0x8F,     0, INSN_WQ | INSN_D64, 1, { OPERAND_RM } },
+    { "popf",    0x9D,    -1, INSN_WQ | INSN_D64, 0 },
+    { "prefetcht0", 0x0F18, 1, 0, 1, { OPERAND_M } },
+    { "prefetcht1", 0x0F18, 2, 0, 1, { OPERAND_M } },
+    { "prefetcht2", 0x0F18, 3, 0, 1, { OPERAND_M } },
+    { "prefetchnta", 0x0F18, 0, 0, 1, { OPERAND_M } },
+    { "prefetchw", 0x0F0D, 1, 0, 1, { OPERAND_M } },
+    { "push",    0x50,    -1, INSN_WQ | INSN_D64 | INSN_PLUSR, 1, { OPERAND_R } },
+    { "push",    0xFF,     6, INSN_WQ | INSN_D64, 1, { OPERAND_RM } },
+    { "push",    0x6A,    -1, INSN_WQ | INSN_D64, 1, { OPERAND_IMM8 } },
+    { "push",    0x68,    -1, INSN_WQ | INSN_D64, 1, { OPERAND_IMM } },
+    { "pushf",   0x9C,    -1, INSN_WQ | INSN_D64, 0 },
+    { "rdpmc",   0x0F33,  -1, 0, 0 },
+    { "rdtsc",   0x0F31,  -1, 0, 0 },
+    { "rdtscp",  0x0F01F9, -1, 0, 0 },
+    { "ret",     0xC3,    -1, INSN_D64, 0 },
+    { "ret",     0xC2,    -1, INSN_D64, 1, { OPERAND_IMM16 } },
+    { "rep",     0xF3,    -1, 0, 0 },
+    { "repe",    0xF3,    -1, 0, 0 },
+    { "repz",    0xF3,    -1, 0, 0 },
+    { "repne",   0xF2,    -1, 0, 0 },
+    { "repnz",   0xF2,    -1, 0, 0 },
+    { "sahf",    0x9E,    -1, 0, 0 },
+    { "rol",     0xD1,     0, INSN_WLQ, 1, { OPERAND_RM } },
+    { "rol",     0xD0,     0, INSN_B, 1, { OPERAND_RM } },
+    { "rol",     0xD1,     0, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "rol",     0xD0,     0, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "rol",     0xD3,     0, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "rol",     0xD2,     0, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "rol",     0xC1,     0, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "rol",     0xC0,     0, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "ror",     0xD1,     1, INSN_WLQ, 1, { OPERAND_RM } },
+    { "ror",     0xD0,     1, INSN_B, 1, { OPERAND_RM } },
+    { "ror",     0xD1,     1, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "ror",     0xD0,     1, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "ror",     0xD3,     1, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "ror",     0xD2,     1, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "ror",     0xC1,     1, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "ror",     0xC0,     1, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "rcl",     0xD1,     2, INSN_WLQ, 1, { OPERAND_RM } },
+    { "rcl",     0xD0,     2, INSN_B, 1, { OPERAND_RM } },
+    { "rcl",     0xD1,     2, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "rcl",     0xD0,     2, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "rcl",     0xD3,     2, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "rcl",     0xD2,     2, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "rcl",     0xC1,     2, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "rcl",     0xC0,     2, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "rcr",     0xD1,     3, INSN_WLQ, 1, { OPERAND_RM } },
+    { "rcr",     0xD0,     3, INSN_B, 1, { OPERAND_RM } },
+    { "rcr",     0xD1,     3, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "rcr",     0xD0,     3, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "rcr",     0xD3,     3, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "rcr",     0xD2,     3, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "rcr",     0xC1,     3, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "rcr",     0xC0,     3, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "shl",     0xD1,     4, INSN_WLQ, 1, { OPERAND_RM } },
+    { "shl",     0xD0,     4, INSN_B, 1, { OPERAND_RM } },
+    { "shl",     0xD1,     4, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "shl",     0xD0,     4, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "shl",     0xD3,     4, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "shl",     0xD2,     4, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "shl",     0xC1,     4, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "shl",     0xC0,     4, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "sal",     0xD1,     4, INSN_WLQ, 1, { OPERAND_RM } },
+    { "sal",     0xD0,     4, INSN_B, 1, { OPERAND_RM } },
+    { "sal",     0xD1,     4, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "sal",     0xD0,     4, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "sal",     0xD3,     4, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "sal",     0xD2,     4, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "sal",     0xC1,     4, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "sal",     0xC0,     4, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "shr",     0xD1,     5, INSN_WLQ, 1, { OPERAND_RM } },
+    { "shr",     0xD0,     5, INSN_B, 1, { OPERAND_RM } },
+    { "shr",     0xD1,     5, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "shr",     0xD0,     5, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "shr",     0xD3,     5, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "shr",     0xD2,     5, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "shr",     0xC1,     5, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "shr",     0xC0,     5, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "sar",     0xD1,     7, INSN_WLQ, 1, { OPERAND_RM } },
+    { "sar",     0xD0,     7, INSN_B, 1, { OPERAND_RM } },
+    { "sar",     0xD1,     7, INSN_WLQ, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "sar",     0xD0,     7, INSN_B, 2, { OPERAND_ONE, OPERAND_RM } },
+    { "sar",     0xD3,     7, INSN_WLQ, 2, { OPERAND_CL, OPERAND_RM } },
+    { "sar",     0xD2,     7, INSN_B, 2, { OPERAND_CL, OPERAND_RM } },
+    { "sar",     0xC1,     7, INSN_WLQ, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "sar",     0xC0,     7, INSN_B, 2, { OPERAND_UIMM8, OPERAND_RM } },
+    { "shld",    0x0FA4,  -1, INSN_WLQ, 3, { OPERAND_UIMM8, OPERAND_R, OPERAND_RM } },
+    { "shld",    0x0FA5,  -1, INSN_WLQ, 3, { OPERAND_CL, OPERAND_R, OPERAND_RM } },
+    { "shrd",    0x0FAC,  -1, INSN_WLQ, 3, { OPERAND_UIMM8, OPERAND_R, OPERAND_RM } },
+    { "shrd",    0x0FAD,  -1, INSN_WLQ, 3, { OPERAND_CL, OPERAND_R, OPERAND_RM } },
+    { "stc",     0xF9,    -1, 0, 0 },
+    { "std",     0xFD,    -1, 0, 0 },
+    { "sti",     0xFB,    -1, 0, 0 },
+    { "serialize", 0x0F01E8, -1, 0, 0 },
+    { "sfence",  0x0FAEF8, -1, 0, 0 },
+    { "scas",    0xAF,    -1, INSN_WLQ, 0 },
+    { "scas",    0xAE,    -1, INSN_B, 0 },
+    { "stos",    0xAB,    -1, INSN_WLQ, 0 },
+    { "stos",    0xAA,    -1, INSN_B, 0 },
+    { "syscall", 0x0F05,  -1, 0, 0 },
+    { "test",    0xA9,    -1, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "test",    0xA8,    -1, INSN_B, 2, { OPERAND_IMM, OPERAND_ACC } },
+    { "test",    0xF7,     0, INSN_WLQ, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "test",    0xF6,     0, INSN_B, 2, { OPERAND_IMM, OPERAND_RM } },
+    { "test",    0x85,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "test",    0x84,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "test",    0x85,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "test",    0x84,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "tpause",  0x660FAE, 6, 0, 1, { OPERAND_R32 } },
+    { "ud2",     0x0F0B,  -1, 0, 0 },
+    { "umonitor", 0xF30FAE, 6, 0, 1, { OPERAND_R64 } },
+    { "umwait",  0xF20FAE, 6, 0, 1, { OPERAND_R32 } },
+    { "xchg",    0x90,    -1, INSN_WLQ | INSN_PLUSR, 2, { OPERAND_R, OPERAND_ACC } },
+    { "xchg",    0x90,    -1, INSN_WLQ | INSN_PLUSR, 2, { OPERAND_ACC, OPERAND_R } },
+    { "xchg",    0x87,    -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "xchg",    0x86,    -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "xchg",    0x87,    -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "xchg",    0x86,    -1, INSN_B, 2, { OPERAND_RM, OPERAND_R } },
+    { "xadd",    0x0FC1,  -1, INSN_WLQ, 2, { OPERAND_R, OPERAND_RM } },
+    { "xadd",    0x0FC0,  -1, INSN_B, 2, { OPERAND_R, OPERAND_RM } },
+    { "xabort",  0xC6F8,  -1, 0, 1, { OPERAND_UIMM8 } },
+    { "xbegin",  0xC7F8,  -1, 0, 1, { OPERAND_REL32 } },
+    { "xend",    0x0F01D5, -1, 0, 0 },
+    { "xtest",   0x0F01D6, -1, 0, 0 },
+    /* POPCNT, LZCNT, TZCNT, ADX, and BMI1 and BMI2 with a VEX prefix */
+    { "popcnt",     0xF30FB8,   -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "lzcnt",      0xF30FBD,   -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "tzcnt",      0xF30FBC,   -1, INSN_WLQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "adcx",       0x660F38F6, -1, INSN_LQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "adox",       0xF30F38F6, -1, INSN_LQ, 2, { OPERAND_RM, OPERAND_R } },
+    { "andn",       0x0F38F2,   -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RM, OPERAND_RV, OPERAND_R } },
+    { "bextr",      0x0F38F7,   -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RV, OPERAND_RM, OPERAND_R } },
+    { "blsr",       0x0F38F3,    1, INSN_VEX | INSN_LQ, 2, { OPERAND_RM, OPERAND_RV } },
+    { "blsmsk",     0x0F38F3,    2, INSN_VEX | INSN_LQ, 2, { OPERAND_RM, OPERAND_RV } },
+    { "blsi",       0x0F38F3,    3, INSN_VEX | INSN_LQ, 2, { OPERAND_RM, OPERAND_RV } },
+    { "bzhi",       0x0F38F5,   -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RV, OPERAND_RM, OPERAND_R } },
+    { "pdep",       0xF20F38F5, -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RM, OPERAND_RV, OPERAND_R } },
+    { "pext",       0xF30F38F5, -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RM, OPERAND_RV, OPERAND_R } },
+    { "mulx",       0xF20F38F6, -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RM, OPERAND_RV, OPERAND_R } },
+    { "rorx",       0xF20F3AF0, -1, INSN_VEX | INSN_LQ, 3, { OPERAND_UIMM8, OPERAND_RM, OPERAND_R } },
+    { "sarx",       0xF30F38F7, -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RV, OPERAND_RM, OPERAND_R } },
+    { "shlx",       0x660F38F7, -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RV, OPERAND_RM, OPERAND_R } },
+    { "shrx",       0xF20F38F7, -1, INSN_VEX | INSN_LQ, 3, { OPERAND_RV, OPERAND_RM, OPERAND_R } },
+    /* SSE to SSE4.2, the mandatory prefix and 0F, 0F38 or 0F3A map first */
+    { "movaps",     0x0F28,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movaps",     0x0F29,     -1, 0, 2, { OPERAND_X, OPERAND_XM } },
+    { "movapd",     0x660F28,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movapd",     0x660F29,   -1, 0, 2, { OPERAND_X, OPERAND_XM } },
+    { "movups",     0x0F10,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movups",     0x0F11,     -1, 0, 2, { OPERAND_X, OPERAND_XM } },
+    { "movupd",     0x660F10,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movupd",     0x660F11,   -1, 0, 2, { OPERAND_X, OPERAND_XM } },
+    { "movss",      0xF30F10,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movss",      0xF30F11,   -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movsd",      0xF20F10,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movsd",      0xF20F11,   -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movdqa",     0x660F6F,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movdqa",     0x660F7F,   -1, 0, 2, { OPERAND_X, OPERAND_XM } },
+    { "movdqu",     0xF30F6F,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movdqu",     0xF30F7F,   -1, 0, 2, { OPERAND_X, OPERAND_XM } },
+    { "movd",       0x660F6E,   -1, 0, 2, { OPERAND_RM32, OPERAND_X } },
+    { "movd",       0x660F6E,   -1, INSN_Q, 2, { OPERAND_RM, OPERAND_X } },
+    { "movd",       0x660F7E,   -1, 0, 2, { OPERAND_X, OPERAND_RM32 } },
+    { "movd",       0x660F7E,   -1, INSN_Q, 2, { OPERAND_X, OPERAND_RM } },
+    { "movq",       0xF30F7E,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movq",       0x660FD6,   -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movq",       0x660F6E,   -1, INSN_Q, 2, { OPERAND_RM, OPERAND_X } },
+    { "movq",       0x660F7E,   -1, INSN_Q, 2, { OPERAND_X, OPERAND_RM } },
+    { "movlps",     0x0F12,     -1, 0, 2, { OPERAND_M, OPERAND_X } },
+    { "movlps",     0x0F13,     -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movlpd",     0x660F12,   -1, 0, 2, { OPERAND_M, OPERAND_X } },
+    { "movlpd",     0x660F13,   -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movhps",     0x0F16,     -1, 0, 2, { OPERAND_M, OPERAND_X } },
+    { "movhps",     0x0F17,     -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movhpd",     0x660F16,   -1, 0, 2, { OPERAND_M, OPERAND_X } },
+    { "movhpd",     0x660F17,   -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movhlps",    0x0F12,     -1, 0, 2, { OPERAND_XR, OPERAND_X } },
+    { "movlhps",    0x0F16,     -1, 0, 2, { OPERAND_XR, OPERAND_X } },
+    { "movmskps",   0x0F50,     -1, 0, 2, { OPERAND_XR, OPERAND_RLQ } },
+    { "movmskpd",   0x660F50,   -1, 0, 2, { OPERAND_XR, OPERAND_RLQ } },
+    { "movntps",    0x0F2B,     -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movntpd",    0x660F2B,   -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movntdq",    0x660FE7,   -1, 0, 2, { OPERAND_X, OPERAND_M } },
+    { "movntdqa",   0x660F382A, -1, 0, 2, { OPERAND_M, OPERAND_X } },
+    { "maskmovdqu", 0x660FF7,   -1, 0, 2, { OPERAND_XR, OPERAND_X } },
+    { "lddqu",      0xF20FF0,   -1, 0, 2, { OPERAND_M, OPERAND_X } },
+    { "movddup",    0xF20F12,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movshdup",   0xF30F16,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "movsldup",   0xF30F12,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "addps",      0x0F58,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "addpd",      0x660F58,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "addss",      0xF30F58,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "addsd",      0xF20F58,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "subps",      0x0F5C,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "subpd",      0x660F5C,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "subss",      0xF30F5C,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "subsd",      0xF20F5C,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "mulps",      0x0F59,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "mulpd",      0x660F59,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "mulss",      0xF30F59,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "mulsd",      0xF20F59,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "divps",      0x0F5E,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "divpd",      0x660F5E,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "divss",      0xF30F5E,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "divsd",      0xF20F5E,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "minps",      0x0F5D,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "minpd",      0x660F5D,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "minss",      0xF30F5D,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "minsd",      0xF20F5D,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "maxps",      0x0F5F,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "maxpd",      0x660F5F,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "maxss",      0xF30F5F,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "maxsd",      0xF20F5F,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sqrtps",     0x0F51,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sqrtpd",     0x660F51,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sqrtss",     0xF30F51,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sqrtsd",     0xF20F51,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "rsqrtps",    0x0F52,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "rsqrtss",    0xF30F52,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "rcpps",      0x0F53,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "rcpss",      0xF30F53,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "andps",      0x0F54,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "andpd",      0x660F54,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "andnps",     0x0F55,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "andnpd",     0x660F55,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "orps",       0x0F56,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "orpd",       0x660F56,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "xorps",      0x0F57,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "xorpd",      0x660F57,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "addsubps",   0xF20FD0,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "addsubpd",   0x660FD0,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "haddps",     0xF20F7C,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "haddpd",     0x660F7C,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "hsubps",     0xF20F7D,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "hsubpd",     0x660F7D,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cmpps",      0x0FC2,     -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "cmppd",      0x660FC2,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "cmpss",      0xF30FC2,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "cmpsd",      0xF20FC2,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "comiss",     0x0F2F,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "comisd",     0x660F2F,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "ucomiss",    0x0F2E,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "ucomisd",    0x660F2E,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "shufps",     0x0FC6,     -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "shufpd",     0x660FC6,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "unpcklps",   0x0F14,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "unpcklpd",   0x660F14,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "unpckhps",   0x0F15,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "unpckhpd",   0x660F15,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtsi2ss",   0xF30F2A,   -1, INSN_L, 2, { OPERAND_RM32, OPERAND_X } },
+    { "cvtsi2ss",   0xF30F2A,   -1, INSN_Q, 2, { OPERAND_RM, OPERAND_X } },
+    { "cvtss2si",   0xF30F2D,   -1, INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "cvttss2si",  0xF30F2C,   -1, INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "cvtsi2sd",   0xF20F2A,   -1, INSN_L, 2, { OPERAND_RM32, OPERAND_X } },
+    { "cvtsi2sd",   0xF20F2A,   -1, INSN_Q, 2, { OPERAND_RM, OPERAND_X } },
+    { "cvtsd2si",   0xF20F2D,   -1, INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "cvttsd2si",  0xF20F2C,   -1, INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "cvtsd2ss",   0xF20F5A,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtss2sd",   0xF30F5A,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtps2pd",   0x0F5A,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtpd2ps",   0x660F5A,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtdq2ps",   0x0F5B,     -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtps2dq",   0x660F5B,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvttps2dq",  0xF30F5B,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtdq2pd",   0xF30FE6,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvtpd2dq",   0xF20FE6,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "cvttpd2dq",  0x660FE6,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddb",      0x660FFC,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddw",      0x660FFD,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddd",      0x660FFE,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddq",      0x660FD4,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubb",      0x660FF8,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubw",      0x660FF9,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubd",      0x660FFA,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubq",      0x660FFB,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddsb",     0x660FEC,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddsw",     0x660FED,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddusb",    0x660FDC,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "paddusw",    0x660FDD,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubsb",     0x660FE8,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubsw",     0x660FE9,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubusb",    0x660FD8,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psubusw",    0x660FD9,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmullw",     0x660FD5,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmulhw",     0x660FE5,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmulhuw",    0x660FE4,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmuludq",    0x660FF4,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaddwd",    0x660FF5,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pavgb",      0x660FE0,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pavgw",      0x660FE3,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaxub",     0x660FDE,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pminub",     0x660FDA,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaxsw",     0x660FEE,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pminsw",     0x660FEA,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psadbw",     0x660FF6,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pand",       0x660FDB,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pandn",      0x660FDF,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "por",        0x660FEB,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pxor",       0x660FEF,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpeqb",    0x660F74,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpeqw",    0x660F75,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpeqd",    0x660F76,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpgtb",    0x660F64,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpgtw",    0x660F65,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpgtd",    0x660F66,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "packsswb",   0x660F63,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "packuswb",   0x660F67,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "packssdw",   0x660F6B,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpcklbw",  0x660F60,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpcklwd",  0x660F61,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpckldq",  0x660F62,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpcklqdq", 0x660F6C,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpckhbw",  0x660F68,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpckhwd",  0x660F69,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpckhdq",  0x660F6A,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "punpckhqdq", 0x660F6D,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pshufd",     0x660F70,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pshufhw",    0xF30F70,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pshuflw",    0xF20F70,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "psllw",      0x660FF1,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psllw",      0x660F71,    6, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "pslld",      0x660FF2,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pslld",      0x660F72,    6, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "psllq",      0x660FF3,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psllq",      0x660F73,    6, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "psrlw",      0x660FD1,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psrlw",      0x660F71,    2, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "psrld",      0x660FD2,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psrld",      0x660F72,    2, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "psrlq",      0x660FD3,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psrlq",      0x660F73,    2, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "psraw",      0x660FE1,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psraw",      0x660F71,    4, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "psrad",      0x660FE2,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psrad",      0x660F72,    4, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "pslldq",     0x660F73,    7, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "psrldq",     0x660F73,    3, 0, 2, { OPERAND_UIMM8, OPERAND_XR } },
+    { "pmovmskb",   0x660FD7,   -1, 0, 2, { OPERAND_XR, OPERAND_RLQ } },
+    { "pextrw",     0x660FC5,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_RLQ } },
+    { "pextrw",     0x660F3A15, -1, 0, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_M } },
+    { "pinsrw",     0x660FC4,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_RMLQ, OPERAND_X } },
+    { "pshufb",     0x660F3800, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "phaddw",     0x660F3801, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "phaddd",     0x660F3802, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "phaddsw",    0x660F3803, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaddubsw",  0x660F3804, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "phsubw",     0x660F3805, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "phsubd",     0x660F3806, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "phsubsw",    0x660F3807, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psignb",     0x660F3808, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psignw",     0x660F3809, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "psignd",     0x660F380A, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmulhrsw",   0x660F380B, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pabsb",      0x660F381C, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pabsw",      0x660F381D, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pabsd",      0x660F381E, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "palignr",    0x660F3A0F, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pmuldq",     0x660F3828, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpeqq",    0x660F3829, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "packusdw",   0x660F382B, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmulld",     0x660F3840, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "phminposuw", 0x660F3841, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pminsb",     0x660F3838, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pminsd",     0x660F3839, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pminuw",     0x660F383A, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pminud",     0x660F383B, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaxsb",     0x660F383C, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaxsd",     0x660F383D, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaxuw",     0x660F383E, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmaxud",     0x660F383F, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "ptest",      0x660F3817, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pcmpgtq",    0x660F3837, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovsxbw",   0x660F3820, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovsxbd",   0x660F3821, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovsxbq",   0x660F3822, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovsxwd",   0x660F3823, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovsxwq",   0x660F3824, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovsxdq",   0x660F3825, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovzxbw",   0x660F3830, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovzxbd",   0x660F3831, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovzxbq",   0x660F3832, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovzxwd",   0x660F3833, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovzxwq",   0x660F3834, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pmovzxdq",   0x660F3835, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "pblendvb",   0x660F3810, -1, 0, 3, { OPERAND_XMM0, OPERAND_XM, OPERAND_X } },
+    { "pblendvb",   0x660F3810, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "blendvps",   0x660F3814, -1, 0, 3, { OPERAND_XMM0, OPERAND_XM, OPERAND_X } },
+    { "blendvps",   0x660F3814, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "blendvpd",   0x660F3815, -1, 0, 3, { OPERAND_XMM0, OPERAND_XM, OPERAND_X } },
+    { "blendvpd",   0x660F3815, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "roundps",    0x660F3A08, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "roundpd",    0x660F3A09, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "roundss",    0x660F3A0A, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "roundsd",    0x660F3A0B, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "blendps",    0x660F3A0C, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "blendpd",    0x660F3A0D, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pblendw",    0x660F3A0E, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "insertps",   0x660F3A21, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "dpps",       0x660F3A40, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "dppd",       0x660F3A41, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "mpsadbw",    0x660F3A42, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pcmpestrm",  0x660F3A60, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pcmpestri",  0x660F3A61, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pcmpistrm",  0x660F3A62, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pcmpistri",  0x660F3A63, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pextrb",     0x660F3A14, -1, 0, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RMLQ } },
+    { "pextrd",     0x660F3A16, -1, 0, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RM32 } },
+    { "pextrq",     0x660F3A16, -1, INSN_Q, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RM } },
+    { "extractps",  0x660F3A17, -1, 0, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RMLQ } },
+    { "pinsrb",     0x660F3A20, -1, 0, 3, { OPERAND_UIMM8, OPERAND_RMLQ, OPERAND_X } },
+    { "pinsrd",     0x660F3A22, -1, 0, 3, { OPERAND_UIMM8, OPERAND_RM32, OPERAND_X } },
+    { "pinsrq",     0x660F3A22, -1, INSN_Q, 3, { OPERAND_UIMM8, OPERAND_RM, OPERAND_X } },
+    { "crc32",      0xF20F38F0, -1, INSN_B, 2, { OPERAND_RM, OPERAND_RL } },
+    { "crc32",      0xF20F38F0, -1, INSN_B | INSN_REX_W, 2, { OPERAND_RM, OPERAND_RLQ } },
+    { "crc32",      0xF20F38F1, -1, INSN_WL, 2, { OPERAND_RM, OPERAND_RL } },
+    { "crc32",      0xF20F38F1, -1, INSN_Q, 2, { OPERAND_RM, OPERAND_R } },
+    { "ldmxcsr",    0x0FAE,      2, 0, 1, { OPERAND_M } },
+    { "stmxcsr",    0x0FAE,      3, 0, 1, { OPERAND_M } },
+    /* AES-NI, PCLMULQDQ and SHA */
+    { "aesenc",     0x660F38DC, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "aesenclast", 0x660F38DD, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "aesdec",     0x660F38DE, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "aesdeclast", 0x660F38DF, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "aesimc",     0x660F38DB, -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "aeskeygenassist", 0x660F3ADF, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "pclmulqdq",  0x660F3A44, -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "sha1rnds4",  0x0F3ACC,   -1, 0, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "sha1nexte",  0x0F38C8,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sha1msg1",   0x0F38C9,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sha1msg2",   0x0F38CA,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sha256rnds2", 0x0F38CB,   -1, 0, 3, { OPERAND_XMM0, OPERAND_XM, OPERAND_X } },
+    { "sha256rnds2", 0x0F38CB,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sha256msg1", 0x0F38CC,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    { "sha256msg2", 0x0F38CD,   -1, 0, 2, { OPERAND_XM, OPERAND_X } },
+    /* AVX, AVX2 and FMA, the 256-bit forms with VEX.L */
+    { "vmovaps",       0x0F28,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovaps",       0x0F28,     -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovaps",       0x0F29,     -1, INSN_VEX, 2, { OPERAND_X, OPERAND_XM } },
+    { "vmovaps",       0x0F29,     -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_YM } },
+    { "vmovapd",       0x660F28,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovapd",       0x660F28,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovapd",       0x660F29,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_XM } },
+    { "vmovapd",       0x660F29,   -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_YM } },
+    { "vmovups",       0x0F10,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovups",       0x0F10,     -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovups",       0x0F11,     -1, INSN_VEX, 2, { OPERAND_X, OPERAND_XM } },
+    { "vmovups",       0x0F11,     -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_YM } },
+    { "vmovupd",       0x660F10,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovupd",       0x660F10,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovupd",       0x660F11,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_XM } },
+    { "vmovupd",       0x660F11,   -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_YM } },
+    { "vmovdqa",       0x660F6F,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovdqa",       0x660F6F,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovdqa",       0x660F7F,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_XM } },
+    { "vmovdqa",       0x660F7F,   -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_YM } },
+    { "vmovdqu",       0xF30F6F,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovdqu",       0xF30F6F,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovdqu",       0xF30F7F,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_XM } },
+    { "vmovdqu",       0xF30F7F,   -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_YM } },
+    { "vmovss",        0xF30F10,   -1, INSN_VEX, 2, { OPERAND_M, OPERAND_X } },
+    { "vmovss",        0xF30F11,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovss",        0xF30F10,   -1, INSN_VEX, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X } },
+    { "vmovss",        0xF30F11,   -1, INSN_VEX, 3, { OPERAND_X, OPERAND_XV, OPERAND_XR } },
+    { "vmovsd",        0xF20F10,   -1, INSN_VEX, 2, { OPERAND_M, OPERAND_X } },
+    { "vmovsd",        0xF20F11,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovsd",        0xF20F10,   -1, INSN_VEX, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X } },
+    { "vmovsd",        0xF20F11,   -1, INSN_VEX, 3, { OPERAND_X, OPERAND_XV, OPERAND_XR } },
+    { "vmovd",         0x660F6E,   -1, INSN_VEX, 2, { OPERAND_RM32, OPERAND_X } },
+    { "vmovd",         0x660F6E,   -1, INSN_VEX | INSN_Q, 2, { OPERAND_RM, OPERAND_X } },
+    { "vmovd",         0x660F7E,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_RM32 } },
+    { "vmovd",         0x660F7E,   -1, INSN_VEX | INSN_Q, 2, { OPERAND_X, OPERAND_RM } },
+    { "vmovq",         0xF30F7E,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovq",         0x660FD6,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_XM } },
+    { "vmovq",         0x660F6E,   -1, INSN_VEX | INSN_Q, 2, { OPERAND_RM, OPERAND_X } },
+    { "vmovq",         0x660F7E,   -1, INSN_VEX | INSN_Q, 2, { OPERAND_X, OPERAND_RM } },
+    { "vmovlps",       0x0F12,     -1, INSN_VEX, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vmovlps",       0x0F13,     -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovlpd",       0x660F12,   -1, INSN_VEX, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vmovlpd",       0x660F13,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovhps",       0x0F16,     -1, INSN_VEX, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vmovhps",       0x0F17,     -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovhpd",       0x660F16,   -1, INSN_VEX, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vmovhpd",       0x660F17,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovhlps",      0x0F12,     -1, INSN_VEX, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X } },
+    { "vmovlhps",      0x0F16,     -1, INSN_VEX, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X } },
+    { "vmovmskps",     0x0F50,     -1, INSN_VEX, 2, { OPERAND_XR, OPERAND_RLQ } },
+    { "vmovmskps",     0x0F50,     -1, INSN_VEX256, 2, { OPERAND_YR, OPERAND_RLQ } },
+    { "vmovmskpd",     0x660F50,   -1, INSN_VEX, 2, { OPERAND_XR, OPERAND_RLQ } },
+    { "vmovmskpd",     0x660F50,   -1, INSN_VEX256, 2, { OPERAND_YR, OPERAND_RLQ } },
+    { "vpmovmskb",     0x660FD7,   -1, INSN_VEX, 2, { OPERAND_XR, OPERAND_RLQ } },
+    { "vpmovmskb",     0x660FD7,   -1, INSN_VEX256, 2, { OPERAND_YR, OPERAND_RLQ } },
+    { "vmovntps",      0x0F2B,     -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovntps",      0x0F2B,     -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_M } },
+    { "vmovntpd",      0x660F2B,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovntpd",      0x660F2B,   -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_M } },
+    { "vmovntdq",      0x660FE7,   -1, INSN_VEX, 2, { OPERAND_X, OPERAND_M } },
+    { "vmovntdq",      0x660FE7,   -1, INSN_VEX256, 2, { OPERAND_Y, OPERAND_M } },
+    { "vmovntdqa",     0x660F382A, -1, INSN_VEX, 2, { OPERAND_M, OPERAND_X } },
+    { "vmovntdqa",     0x660F382A, -1, INSN_VEX256, 2, { OPERAND_M, OPERAND_Y } },
+    { "vlddqu",        0xF20FF0,   -1, INSN_VEX, 2, { OPERAND_M, OPERAND_X } },
+    { "vlddqu",        0xF20FF0,   -1, INSN_VEX256, 2, { OPERAND_M, OPERAND_Y } },
+    { "vmaskmovdqu",   0x660FF7,   -1, INSN_VEX, 2, { OPERAND_XR, OPERAND_X } },
+    { "vmovddup",      0xF20F12,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovddup",      0xF20F12,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovshdup",     0xF30F16,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovshdup",     0xF30F16,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmovsldup",     0xF30F12,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vmovsldup",     0xF30F12,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vmaskmovps",    0x660F382C, -1, INSN_VEX, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vmaskmovps",    0x660F382C, -1, INSN_VEX256, 3, { OPERAND_M, OPERAND_YV, OPERAND_Y } },
+    { "vmaskmovps",    0x660F382E, -1, INSN_VEX, 3, { OPERAND_X, OPERAND_XV, OPERAND_M } },
+    { "vmaskmovps",    0x660F382E, -1, INSN_VEX256, 3, { OPERAND_Y, OPERAND_YV, OPERAND_M } },
+    { "vmaskmovpd",    0x660F382D, -1, INSN_VEX, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vmaskmovpd",    0x660F382D, -1, INSN_VEX256, 3, { OPERAND_M, OPERAND_YV, OPERAND_Y } },
+    { "vmaskmovpd",    0x660F382F, -1, INSN_VEX, 3, { OPERAND_X, OPERAND_XV, OPERAND_M } },
+    { "vmaskmovpd",    0x660F382F, -1, INSN_VEX256, 3, { OPERAND_Y, OPERAND_YV, OPERAND_M } },
+    { "vpmaskmovd",    0x660F388C, -1, INSN_VEX, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vpmaskmovd",    0x660F388C, -1, INSN_VEX256, 3, { OPERAND_M, OPERAND_YV, OPERAND_Y } },
+    { "vpmaskmovd",    0x660F388E, -1, INSN_VEX, 3, { OPERAND_X, OPERAND_XV, OPERAND_M } },
+    { "vpmaskmovd",    0x660F388E, -1, INSN_VEX256, 3, { OPERAND_Y, OPERAND_YV, OPERAND_M } },
+    { "vpmaskmovq",    0x660F388C, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_M, OPERAND_XV, OPERAND_X } },
+    { "vpmaskmovq",    0x660F388C, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_M, OPERAND_YV, OPERAND_Y } },
+    { "vpmaskmovq",    0x660F388E, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_X, OPERAND_XV, OPERAND_M } },
+    { "vpmaskmovq",    0x660F388E, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_Y, OPERAND_YV, OPERAND_M } },
+    { "vpgatherdd",    0x660F3890, -1, INSN_VEX, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vpgatherdd",    0x660F3890, -1, INSN_VEX256, 3, { OPERAND_YV, OPERAND_YS, OPERAND_Y } },
+    { "vpgatherdq",    0x660F3890, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vpgatherdq",    0x660F3890, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YV, OPERAND_XS, OPERAND_Y } },
+    { "vpgatherqd",    0x660F3891, -1, INSN_VEX, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vpgatherqd",    0x660F3891, -1, INSN_VEX256, 3, { OPERAND_XV, OPERAND_YS, OPERAND_X } },
+    { "vpgatherqq",    0x660F3891, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vpgatherqq",    0x660F3891, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YV, OPERAND_YS, OPERAND_Y } },
+    { "vgatherdps",    0x660F3892, -1, INSN_VEX, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vgatherdps",    0x660F3892, -1, INSN_VEX256, 3, { OPERAND_YV, OPERAND_YS, OPERAND_Y } },
+    { "vgatherdpd",    0x660F3892, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vgatherdpd",    0x660F3892, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YV, OPERAND_XS, OPERAND_Y } },
+    { "vgatherqps",    0x660F3893, -1, INSN_VEX, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vgatherqps",    0x660F3893, -1, INSN_VEX256, 3, { OPERAND_XV, OPERAND_YS, OPERAND_X } },
+    { "vgatherqpd",    0x660F3893, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XV, OPERAND_XS, OPERAND_X } },
+    { "vgatherqpd",    0x660F3893, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YV, OPERAND_YS, OPERAND_Y } },
+    { "vaddps",        0x0F58,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaddps",        0x0F58,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaddpd",        0x660F58,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaddpd",        0x660F58,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaddss",        0xF30F58,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaddsd",        0xF20F58,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vsubps",        0x0F5C,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vsubps",        0x0F5C,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vsubpd",        0x660F5C,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vsubpd",        0x660F5C,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vsubss",        0xF30F5C,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vsubsd",        0xF20F5C,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmulps",        0x0F59,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmulps",        0x0F59,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vmulpd",        0x660F59,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmulpd",        0x660F59,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vmulss",        0xF30F59,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmulsd",        0xF20F59,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vdivps",        0x0F5E,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vdivps",        0x0F5E,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vdivpd",        0x660F5E,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vdivpd",        0x660F5E,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vdivss",        0xF30F5E,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vdivsd",        0xF20F5E,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vminps",        0x0F5D,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vminps",        0x0F5D,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vminpd",        0x660F5D,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vminpd",        0x660F5D,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vminss",        0xF30F5D,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vminsd",        0xF20F5D,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmaxps",        0x0F5F,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmaxps",        0x0F5F,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vmaxpd",        0x660F5F,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmaxpd",        0x660F5F,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vmaxss",        0xF30F5F,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmaxsd",        0xF20F5F,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vsqrtps",       0x0F51,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vsqrtps",       0x0F51,     -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vsqrtpd",       0x660F51,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vsqrtpd",       0x660F51,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vsqrtss",       0xF30F51,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vsqrtsd",       0xF20F51,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vrsqrtps",      0x0F52,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vrsqrtps",      0x0F52,     -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vrsqrtss",      0xF30F52,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vrcpps",        0x0F53,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vrcpps",        0x0F53,     -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vrcpss",        0xF30F53,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vandps",        0x0F54,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vandps",        0x0F54,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vandpd",        0x660F54,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vandpd",        0x660F54,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vandnps",       0x0F55,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vandnps",       0x0F55,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vandnpd",       0x660F55,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vandnpd",       0x660F55,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vorps",         0x0F56,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vorps",         0x0F56,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vorpd",         0x660F56,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vorpd",         0x660F56,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vxorps",        0x0F57,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vxorps",        0x0F57,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vxorpd",        0x660F57,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vxorpd",        0x660F57,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaddsubps",     0xF20FD0,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaddsubps",     0xF20FD0,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaddsubpd",     0x660FD0,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaddsubpd",     0x660FD0,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vhaddps",       0xF20F7C,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vhaddps",       0xF20F7C,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vhaddpd",       0x660F7C,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vhaddpd",       0x660F7C,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vhsubps",       0xF20F7D,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vhsubps",       0xF20F7D,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vhsubpd",       0x660F7D,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vhsubpd",       0x660F7D,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vcmpps",        0x0FC2,     -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vcmpps",        0x0FC2,     -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vcmppd",        0x660FC2,   -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vcmppd",        0x660FC2,   -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vcmpss",        0xF30FC2,   -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vcmpsd",        0xF20FC2,   -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vcomiss",       0x0F2F,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcomisd",       0x660F2F,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vucomiss",      0x0F2E,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vucomisd",      0x660F2E,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vshufps",       0x0FC6,     -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vshufps",       0x0FC6,     -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vshufpd",       0x660FC6,   -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vshufpd",       0x660FC6,   -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vunpcklps",     0x0F14,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vunpcklps",     0x0F14,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vunpcklpd",     0x660F14,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vunpcklpd",     0x660F14,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vunpckhps",     0x0F15,     -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vunpckhps",     0x0F15,     -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vunpckhpd",     0x660F15,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vunpckhpd",     0x660F15,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vroundps",      0x660F3A08, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vroundps",      0x660F3A08, -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vroundpd",      0x660F3A09, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vroundpd",      0x660F3A09, -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vroundss",      0x660F3A0A, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vroundsd",      0x660F3A0B, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vblendps",      0x660F3A0C, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vblendps",      0x660F3A0C, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vblendpd",      0x660F3A0D, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vblendpd",      0x660F3A0D, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vdpps",         0x660F3A40, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vdpps",         0x660F3A40, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vdppd",         0x660F3A41, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vblendvps",     0x660F3A4A, -1, INSN_VEX, 4, { OPERAND_XI, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vblendvps",     0x660F3A4A, -1, INSN_VEX256, 4, { OPERAND_YI, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vblendvpd",     0x660F3A4B, -1, INSN_VEX, 4, { OPERAND_XI, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vblendvpd",     0x660F3A4B, -1, INSN_VEX256, 4, { OPERAND_YI, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpblendvb",     0x660F3A4C, -1, INSN_VEX, 4, { OPERAND_XI, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpblendvb",     0x660F3A4C, -1, INSN_VEX256, 4, { OPERAND_YI, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vptest",        0x660F3817, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vptest",        0x660F3817, -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vtestps",       0x660F380E, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vtestps",       0x660F380E, -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vtestpd",       0x660F380F, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vtestpd",       0x660F380F, -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vcvtsi2ss",     0xF30F2A,   -1, INSN_VEX | INSN_L, 3, { OPERAND_RM32, OPERAND_XV, OPERAND_X } },
+    { "vcvtsi2ss",     0xF30F2A,   -1, INSN_VEX | INSN_Q, 3, { OPERAND_RM, OPERAND_XV, OPERAND_X } },
+    { "vcvtss2si",     0xF30F2D,   -1, INSN_VEX | INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "vcvttss2si",    0xF30F2C,   -1, INSN_VEX | INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "vcvtsi2sd",     0xF20F2A,   -1, INSN_VEX | INSN_L, 3, { OPERAND_RM32, OPERAND_XV, OPERAND_X } },
+    { "vcvtsi2sd",     0xF20F2A,   -1, INSN_VEX | INSN_Q, 3, { OPERAND_RM, OPERAND_XV, OPERAND_X } },
+    { "vcvtsd2si",     0xF20F2D,   -1, INSN_VEX | INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "vcvttsd2si",    0xF20F2C,   -1, INSN_VEX | INSN_LQ, 2, { OPERAND_XM, OPERAND_R } },
+    { "vcvtsd2ss",     0xF20F5A,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vcvtss2sd",     0xF30F5A,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vcvtdq2ps",     0x0F5B,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvtdq2ps",     0x0F5B,     -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vcvtps2dq",     0x660F5B,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvtps2dq",     0x660F5B,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vcvttps2dq",    0xF30F5B,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvttps2dq",    0xF30F5B,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vcvtps2pd",     0x0F5A,     -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvtps2pd",     0x0F5A,     -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vcvtdq2pd",     0xF30FE6,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvtdq2pd",     0xF30FE6,   -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vcvtpd2ps",     0x660F5A,   -1, INSN_VEX, 2, { OPERAND_XR, OPERAND_X } },
+    { "vcvtpd2ps",     0x660F5A,   -1, INSN_VEX256, 2, { OPERAND_YR, OPERAND_X } },
+    { "vcvtpd2psx",    0x660F5A,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvtpd2psy",    0x660F5A,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_X } },
+    { "vcvtpd2dq",     0xF20FE6,   -1, INSN_VEX, 2, { OPERAND_XR, OPERAND_X } },
+    { "vcvtpd2dq",     0xF20FE6,   -1, INSN_VEX256, 2, { OPERAND_YR, OPERAND_X } },
+    { "vcvtpd2dqx",    0xF20FE6,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvtpd2dqy",    0xF20FE6,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_X } },
+    { "vcvttpd2dq",    0x660FE6,   -1, INSN_VEX, 2, { OPERAND_XR, OPERAND_X } },
+    { "vcvttpd2dq",    0x660FE6,   -1, INSN_VEX256, 2, { OPERAND_YR, OPERAND_X } },
+    { "vcvttpd2dqx",   0x660FE6,   -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vcvttpd2dqy",   0x660FE6,   -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_X } },
+    { "vpaddb",        0x660FFC,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddb",        0x660FFC,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpaddw",        0x660FFD,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddw",        0x660FFD,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpaddd",        0x660FFE,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddd",        0x660FFE,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpaddq",        0x660FD4,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddq",        0x660FD4,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubb",        0x660FF8,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubb",        0x660FF8,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubw",        0x660FF9,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubw",        0x660FF9,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubd",        0x660FFA,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubd",        0x660FFA,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubq",        0x660FFB,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubq",        0x660FFB,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpaddsb",       0x660FEC,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddsb",       0x660FEC,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpaddsw",       0x660FED,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddsw",       0x660FED,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpaddusb",      0x660FDC,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddusb",      0x660FDC,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpaddusw",      0x660FDD,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpaddusw",      0x660FDD,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubsb",       0x660FE8,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubsb",       0x660FE8,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubsw",       0x660FE9,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubsw",       0x660FE9,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubusb",      0x660FD8,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubusb",      0x660FD8,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsubusw",      0x660FD9,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsubusw",      0x660FD9,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmullw",       0x660FD5,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmullw",       0x660FD5,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmulhw",       0x660FE5,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmulhw",       0x660FE5,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmulhuw",      0x660FE4,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmulhuw",      0x660FE4,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmuludq",      0x660FF4,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmuludq",      0x660FF4,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaddwd",      0x660FF5,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaddwd",      0x660FF5,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpavgb",        0x660FE0,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpavgb",        0x660FE0,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpavgw",        0x660FE3,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpavgw",        0x660FE3,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaxub",       0x660FDE,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaxub",       0x660FDE,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpminub",       0x660FDA,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpminub",       0x660FDA,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaxsw",       0x660FEE,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaxsw",       0x660FEE,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpminsw",       0x660FEA,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpminsw",       0x660FEA,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsadbw",       0x660FF6,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsadbw",       0x660FF6,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpand",         0x660FDB,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpand",         0x660FDB,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpandn",        0x660FDF,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpandn",        0x660FDF,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpor",          0x660FEB,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpor",          0x660FEB,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpxor",         0x660FEF,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpxor",         0x660FEF,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpeqb",      0x660F74,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpeqb",      0x660F74,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpeqw",      0x660F75,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpeqw",      0x660F75,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpeqd",      0x660F76,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpeqd",      0x660F76,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpgtb",      0x660F64,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpgtb",      0x660F64,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpgtw",      0x660F65,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpgtw",      0x660F65,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpgtd",      0x660F66,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpgtd",      0x660F66,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpacksswb",     0x660F63,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpacksswb",     0x660F63,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpackuswb",     0x660F67,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpackuswb",     0x660F67,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpackssdw",     0x660F6B,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpackssdw",     0x660F6B,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpcklbw",    0x660F60,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpcklbw",    0x660F60,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpcklwd",    0x660F61,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpcklwd",    0x660F61,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpckldq",    0x660F62,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpckldq",    0x660F62,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpcklqdq",   0x660F6C,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpcklqdq",   0x660F6C,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpckhbw",    0x660F68,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpckhbw",    0x660F68,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpckhwd",    0x660F69,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpckhwd",    0x660F69,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpckhdq",    0x660F6A,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpckhdq",    0x660F6A,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpunpckhqdq",   0x660F6D,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpunpckhqdq",   0x660F6D,   -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpshufd",       0x660F70,   -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpshufd",       0x660F70,   -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vpshufhw",      0xF30F70,   -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpshufhw",      0xF30F70,   -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vpshuflw",      0xF20F70,   -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpshuflw",      0xF20F70,   -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vpsllw",        0x660FF1,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsllw",        0x660FF1,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpsllw",        0x660F71,    6, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsllw",        0x660F71,    6, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpslld",        0x660FF2,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpslld",        0x660FF2,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpslld",        0x660F72,    6, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpslld",        0x660F72,    6, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsllq",        0x660FF3,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsllq",        0x660FF3,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpsllq",        0x660F73,    6, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsllq",        0x660F73,    6, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsrlw",        0x660FD1,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsrlw",        0x660FD1,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpsrlw",        0x660F71,    2, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsrlw",        0x660F71,    2, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsrld",        0x660FD2,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsrld",        0x660FD2,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpsrld",        0x660F72,    2, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsrld",        0x660F72,    2, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsrlq",        0x660FD3,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsrlq",        0x660FD3,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpsrlq",        0x660F73,    2, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsrlq",        0x660F73,    2, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsraw",        0x660FE1,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsraw",        0x660FE1,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpsraw",        0x660F71,    4, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsraw",        0x660F71,    4, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsrad",        0x660FE2,   -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsrad",        0x660FE2,   -1, INSN_VEX256, 3, { OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vpsrad",        0x660F72,    4, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsrad",        0x660F72,    4, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpslldq",       0x660F73,    7, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpslldq",       0x660F73,    7, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsrldq",       0x660F73,    3, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_XV } },
+    { "vpsrldq",       0x660F73,    3, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YR, OPERAND_YV } },
+    { "vpsllvd",       0x660F3847, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsllvd",       0x660F3847, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsllvq",       0x660F3847, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsllvq",       0x660F3847, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsrlvd",       0x660F3845, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsrlvd",       0x660F3845, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsrlvq",       0x660F3845, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsrlvq",       0x660F3845, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsravd",       0x660F3846, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsravd",       0x660F3846, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpshufb",       0x660F3800, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpshufb",       0x660F3800, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vphaddw",       0x660F3801, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vphaddw",       0x660F3801, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vphaddd",       0x660F3802, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vphaddd",       0x660F3802, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vphaddsw",      0x660F3803, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vphaddsw",      0x660F3803, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaddubsw",    0x660F3804, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaddubsw",    0x660F3804, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vphsubw",       0x660F3805, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vphsubw",       0x660F3805, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vphsubd",       0x660F3806, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vphsubd",       0x660F3806, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vphsubsw",      0x660F3807, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vphsubsw",      0x660F3807, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsignb",       0x660F3808, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsignb",       0x660F3808, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsignw",       0x660F3809, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsignw",       0x660F3809, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpsignd",       0x660F380A, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpsignd",       0x660F380A, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmulhrsw",     0x660F380B, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmulhrsw",     0x660F380B, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmuldq",       0x660F3828, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmuldq",       0x660F3828, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpeqq",      0x660F3829, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpeqq",      0x660F3829, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpackusdw",     0x660F382B, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpackusdw",     0x660F382B, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmulld",       0x660F3840, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmulld",       0x660F3840, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpminsb",       0x660F3838, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpminsb",       0x660F3838, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpminsd",       0x660F3839, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpminsd",       0x660F3839, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpminuw",       0x660F383A, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpminuw",       0x660F383A, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpminud",       0x660F383B, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpminud",       0x660F383B, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaxsb",       0x660F383C, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaxsb",       0x660F383C, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaxsd",       0x660F383D, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaxsd",       0x660F383D, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaxuw",       0x660F383E, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaxuw",       0x660F383E, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpmaxud",       0x660F383F, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpmaxud",       0x660F383F, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpgtq",      0x660F3837, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpcmpgtq",      0x660F3837, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpabsb",        0x660F381C, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpabsb",        0x660F381C, -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vpabsw",        0x660F381D, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpabsw",        0x660F381D, -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vpabsd",        0x660F381E, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpabsd",        0x660F381E, -1, INSN_VEX256, 2, { OPERAND_YM, OPERAND_Y } },
+    { "vphminposuw",   0x660F3841, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovsxbw",     0x660F3820, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovsxbw",     0x660F3820, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovsxbd",     0x660F3821, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovsxbd",     0x660F3821, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovsxbq",     0x660F3822, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovsxbq",     0x660F3822, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovsxwd",     0x660F3823, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovsxwd",     0x660F3823, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovsxwq",     0x660F3824, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovsxwq",     0x660F3824, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovsxdq",     0x660F3825, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovsxdq",     0x660F3825, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovzxbw",     0x660F3830, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovzxbw",     0x660F3830, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovzxbd",     0x660F3831, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovzxbd",     0x660F3831, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovzxbq",     0x660F3832, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovzxbq",     0x660F3832, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovzxwd",     0x660F3833, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovzxwd",     0x660F3833, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovzxwq",     0x660F3834, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovzxwq",     0x660F3834, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpmovzxdq",     0x660F3835, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpmovzxdq",     0x660F3835, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpalignr",      0x660F3A0F, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpalignr",      0x660F3A0F, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpblendw",      0x660F3A0E, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpblendw",      0x660F3A0E, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vmpsadbw",      0x660F3A42, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vmpsadbw",      0x660F3A42, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpblendd",      0x660F3A02, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpblendd",      0x660F3A02, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpcmpestrm",    0x660F3A60, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpcmpestri",    0x660F3A61, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpcmpistrm",    0x660F3A62, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpcmpistri",    0x660F3A63, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vinsertps",     0x660F3A21, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpextrb",       0x660F3A14, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RMLQ } },
+    { "vpextrd",       0x660F3A16, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RM32 } },
+    { "vpextrq",       0x660F3A16, -1, INSN_VEX | INSN_Q, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RM } },
+    { "vextractps",    0x660F3A17, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RMLQ } },
+    { "vpextrw",       0x660FC5,   -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_RLQ } },
+    { "vpextrw",       0x660F3A15, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_M } },
+    { "vpinsrb",       0x660F3A20, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_RMLQ, OPERAND_XV, OPERAND_X } },
+    { "vpinsrw",       0x660FC4,   -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_RMLQ, OPERAND_XV, OPERAND_X } },
+    { "vpinsrd",       0x660F3A22, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_RM32, OPERAND_XV, OPERAND_X } },
+    { "vpinsrq",       0x660F3A22, -1, INSN_VEX | INSN_Q, 4, { OPERAND_UIMM8, OPERAND_RM, OPERAND_XV, OPERAND_X } },
+    { "vbroadcastss",  0x660F3818, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vbroadcastss",  0x660F3818, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vbroadcastsd",  0x660F3819, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vbroadcastf128",0x660F381A, -1, INSN_VEX256, 2, { OPERAND_M, OPERAND_Y } },
+    { "vbroadcasti128",0x660F385A, -1, INSN_VEX256, 2, { OPERAND_M, OPERAND_Y } },
+    { "vpbroadcastb",  0x660F3878, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpbroadcastb",  0x660F3878, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpbroadcastw",  0x660F3879, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpbroadcastw",  0x660F3879, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpbroadcastd",  0x660F3858, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpbroadcastd",  0x660F3858, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vpbroadcastq",  0x660F3859, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vpbroadcastq",  0x660F3859, -1, INSN_VEX256, 2, { OPERAND_XM, OPERAND_Y } },
+    { "vinsertf128",   0x660F3A18, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vinserti128",   0x660F3A38, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_YV, OPERAND_Y } },
+    { "vextractf128",  0x660F3A19, -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_Y, OPERAND_XM } },
+    { "vextracti128",  0x660F3A39, -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_Y, OPERAND_XM } },
+    { "vperm2f128",    0x660F3A06, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vperm2i128",    0x660F3A46, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpermd",        0x660F3836, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpermps",       0x660F3816, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpermq",        0x660F3A00, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vpermpd",       0x660F3A01, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vpermilps",     0x660F380C, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpermilps",     0x660F380C, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpermilpd",     0x660F380D, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpermilpd",     0x660F380D, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vpermilps",     0x660F3A04, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpermilps",     0x660F3A04, -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vpermilpd",     0x660F3A05, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpermilpd",     0x660F3A05, -1, INSN_VEX256, 3, { OPERAND_UIMM8, OPERAND_YM, OPERAND_Y } },
+    { "vfmaddsub132ps",0x660F3896, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmaddsub132ps",0x660F3896, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmaddsub132pd",0x660F3896, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmaddsub132pd",0x660F3896, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmaddsub213ps",0x660F38A6, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmaddsub213ps",0x660F38A6, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmaddsub213pd",0x660F38A6, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmaddsub213pd",0x660F38A6, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmaddsub231ps",0x660F38B6, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmaddsub231ps",0x660F38B6, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmaddsub231pd",0x660F38B6, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmaddsub231pd",0x660F38B6, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsubadd132ps",0x660F3897, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsubadd132ps",0x660F3897, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsubadd132pd",0x660F3897, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsubadd132pd",0x660F3897, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsubadd213ps",0x660F38A7, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsubadd213ps",0x660F38A7, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsubadd213pd",0x660F38A7, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsubadd213pd",0x660F38A7, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsubadd231ps",0x660F38B7, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsubadd231ps",0x660F38B7, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsubadd231pd",0x660F38B7, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsubadd231pd",0x660F38B7, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmadd132ps",   0x660F3898, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd132ps",   0x660F3898, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmadd132pd",   0x660F3898, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd132pd",   0x660F3898, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmadd132ss",   0x660F3899, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd132sd",   0x660F3899, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd213ps",   0x660F38A8, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd213ps",   0x660F38A8, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmadd213pd",   0x660F38A8, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd213pd",   0x660F38A8, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmadd213ss",   0x660F38A9, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd213sd",   0x660F38A9, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd231ps",   0x660F38B8, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd231ps",   0x660F38B8, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmadd231pd",   0x660F38B8, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd231pd",   0x660F38B8, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmadd231ss",   0x660F38B9, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmadd231sd",   0x660F38B9, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub132ps",   0x660F389A, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub132ps",   0x660F389A, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsub132pd",   0x660F389A, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub132pd",   0x660F389A, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsub132ss",   0x660F389B, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub132sd",   0x660F389B, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub213ps",   0x660F38AA, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub213ps",   0x660F38AA, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsub213pd",   0x660F38AA, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub213pd",   0x660F38AA, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsub213ss",   0x660F38AB, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub213sd",   0x660F38AB, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub231ps",   0x660F38BA, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub231ps",   0x660F38BA, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsub231pd",   0x660F38BA, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub231pd",   0x660F38BA, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfmsub231ss",   0x660F38BB, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfmsub231sd",   0x660F38BB, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd132ps",  0x660F389C, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd132ps",  0x660F389C, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmadd132pd",  0x660F389C, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd132pd",  0x660F389C, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmadd132ss",  0x660F389D, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd132sd",  0x660F389D, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd213ps",  0x660F38AC, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd213ps",  0x660F38AC, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmadd213pd",  0x660F38AC, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd213pd",  0x660F38AC, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmadd213ss",  0x660F38AD, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd213sd",  0x660F38AD, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd231ps",  0x660F38BC, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd231ps",  0x660F38BC, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmadd231pd",  0x660F38BC, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd231pd",  0x660F38BC, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmadd231ss",  0x660F38BD, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmadd231sd",  0x660F38BD, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub132ps",  0x660F389E, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub132ps",  0x660F389E, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmsub132pd",  0x660F389E, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub132pd",  0x660F389E, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmsub132ss",  0x660F389F, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub132sd",  0x660F389F, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub213ps",  0x660F38AE, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub213ps",  0x660F38AE, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmsub213pd",  0x660F38AE, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub213pd",  0x660F38AE, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmsub213ss",  0x660F38AF, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub213sd",  0x660F38AF, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub231ps",  0x660F38BE, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub231ps",  0x660F38BE, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmsub231pd",  0x660F38BE, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub231pd",  0x660F38BE, -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vfnmsub231ss",  0x660F38BF, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vfnmsub231sd",  0x660F38BF, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vzeroupper",    0x0F77,     -1, INSN_VEX, 0 },
+    { "vzeroall",      0x0F77,     -1, INSN_VEX256, 0 },
+    { "vldmxcsr",      0x0FAE,      2, INSN_VEX, 1, { OPERAND_M } },
+    { "vstmxcsr",      0x0FAE,      3, INSN_VEX, 1, { OPERAND_M } },
+    /* VAES and VPCLMULQDQ, the 256-bit forms with VEX.L */
+    { "vaesenc",       0x660F38DC, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaesenc",       0x660F38DC, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaesenclast",   0x660F38DD, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaesenclast",   0x660F38DD, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaesdec",       0x660F38DE, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaesdec",       0x660F38DE, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaesdeclast",   0x660F38DF, -1, INSN_VEX, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vaesdeclast",   0x660F38DF, -1, INSN_VEX256, 3, { OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    { "vaesimc",       0x660F38DB, -1, INSN_VEX, 2, { OPERAND_XM, OPERAND_X } },
+    { "vaeskeygenassist", 0x660F3ADF, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_X } },
+    { "vpclmulqdq",    0x660F3A44, -1, INSN_VEX, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X } },
+    { "vpclmulqdq",    0x660F3A44, -1, INSN_VEX256, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_YV, OPERAND_Y } },
+    /* the AVX-512 opmask instructions, VEX encoded */
+    { "kandw",         0x0F41,     -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kandnw",        0x0F42,     -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "korw",          0x0F45,     -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxnorw",        0x0F46,     -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxorw",         0x0F47,     -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kaddw",         0x0F4A,     -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "knotw",         0x0F44,     -1, INSN_VEX, 2, { OPERAND_KR, OPERAND_K } },
+    { "kortestw",      0x0F98,     -1, INSN_VEX, 2, { OPERAND_KR, OPERAND_K } },
+    { "ktestw",        0x0F99,     -1, INSN_VEX, 2, { OPERAND_KR, OPERAND_K } },
+    { "kandb",         0x660F41,   -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kandnb",        0x660F42,   -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "korb",          0x660F45,   -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxnorb",        0x660F46,   -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxorb",         0x660F47,   -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kaddb",         0x660F4A,   -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "knotb",         0x660F44,   -1, INSN_VEX, 2, { OPERAND_KR, OPERAND_K } },
+    { "kortestb",      0x660F98,   -1, INSN_VEX, 2, { OPERAND_KR, OPERAND_K } },
+    { "ktestb",        0x660F99,   -1, INSN_VEX, 2, { OPERAND_KR, OPERAND_K } },
+    { "kandd",         0x660F41,   -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kandnd",        0x660F42,   -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kord",          0x660F45,   -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxnord",        0x660F46,   -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxord",         0x660F47,   -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kaddd",         0x660F4A,   -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "knotd",         0x660F44,   -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KR, OPERAND_K } },
+    { "kortestd",      0x660F98,   -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KR, OPERAND_K } },
+    { "ktestd",        0x660F99,   -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KR, OPERAND_K } },
+    { "kandq",         0x0F41,     -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kandnq",        0x0F42,     -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "korq",          0x0F45,     -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxnorq",        0x0F46,     -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kxorq",         0x0F47,     -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kaddq",         0x0F4A,     -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "knotq",         0x0F44,     -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KR, OPERAND_K } },
+    { "kortestq",      0x0F98,     -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KR, OPERAND_K } },
+    { "ktestq",        0x0F99,     -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KR, OPERAND_K } },
+    { "kmovb",         0x660F90,   -1, INSN_VEX, 2, { OPERAND_KM, OPERAND_K } },
+    { "kmovb",         0x660F91,   -1, INSN_VEX, 2, { OPERAND_K, OPERAND_M } },
+    { "kmovb",         0x660F92,   -1, INSN_VEX, 2, { OPERAND_R32, OPERAND_K } },
+    { "kmovb",         0x660F93,   -1, INSN_VEX | INSN_L, 2, { OPERAND_KR, OPERAND_R } },
+    { "kmovw",         0x0F90,     -1, INSN_VEX, 2, { OPERAND_KM, OPERAND_K } },
+    { "kmovw",         0x0F91,     -1, INSN_VEX, 2, { OPERAND_K, OPERAND_M } },
+    { "kmovw",         0x0F92,     -1, INSN_VEX, 2, { OPERAND_R32, OPERAND_K } },
+    { "kmovw",         0x0F93,     -1, INSN_VEX | INSN_L, 2, { OPERAND_KR, OPERAND_R } },
+    { "kmovd",         0x660F90,   -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KM, OPERAND_K } },
+    { "kmovd",         0x660F91,   -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_K, OPERAND_M } },
+    { "kmovd",         0xF20F92,   -1, INSN_VEX, 2, { OPERAND_R32, OPERAND_K } },
+    { "kmovd",         0xF20F93,   -1, INSN_VEX | INSN_L, 2, { OPERAND_KR, OPERAND_R } },
+    { "kmovq",         0x0F90,     -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_KM, OPERAND_K } },
+    { "kmovq",         0x0F91,     -1, INSN_VEX | INSN_VEX_W, 2, { OPERAND_K, OPERAND_M } },
+    { "kmovq",         0xF20F92,   -1, INSN_VEX | INSN_VEX_W | INSN_Q, 2, { OPERAND_RM, OPERAND_K } },
+    { "kmovq",         0xF20F93,   -1, INSN_VEX | INSN_VEX_W | INSN_Q, 2, { OPERAND_KR, OPERAND_R } },
+    { "kshiftlb",      0x660F3A32, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kshiftlw",      0x660F3A32, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kshiftld",      0x660F3A33, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kshiftlq",      0x660F3A33, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kshiftrb",      0x660F3A30, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kshiftrw",      0x660F3A30, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kshiftrd",      0x660F3A31, -1, INSN_VEX, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kshiftrq",      0x660F3A31, -1, INSN_VEX | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_KR, OPERAND_K } },
+    { "kunpckbw",      0x660F4B,   -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kunpckwd",      0x0F4B,     -1, INSN_VEX256, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } },
+    { "kunpckdq",      0x0F4B,     -1, INSN_VEX256 | INSN_VEX_W, 3, { OPERAND_KR, OPERAND_KV, OPERAND_K } }
+};
+
+/*
+ * AVX-512F, BW, DQ and VL, EVEX encoded. find_insns makes a form of each row
+ * for each of its vector lengths, after the SSE and VEX ones.
+ */
+static const insn_t avx512_insns[] = {
+    { "vmovaps",       0x0F28,     -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovaps",       0x0F29,     -1, INSN_VL, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovapd",       0x660F28,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovapd",       0x660F29,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovups",       0x0F10,     -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovups",       0x0F11,     -1, INSN_VL, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovupd",       0x660F10,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovupd",       0x660F11,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovdqa32",     0x660F6F,   -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovdqa32",     0x660F7F,   -1, INSN_VL, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovdqa64",     0x660F6F,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovdqa64",     0x660F7F,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovdqu32",     0xF30F6F,   -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovdqu32",     0xF30F7F,   -1, INSN_VL, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovdqu64",     0xF30F6F,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovdqu64",     0xF30F7F,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovdqu8",      0xF20F6F,   -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovdqu8",      0xF20F7F,   -1, INSN_VL, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovdqu16",     0xF20F6F,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovdqu16",     0xF20F7F,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VM }, TUPLE_FVM },
+    { "vmovss",        0xF30F10,   -1, INSN_128, 2, { OPERAND_M, OPERAND_X }, TUPLE_N4 },
+    { "vmovss",        0xF30F11,   -1, INSN_128, 2, { OPERAND_X, OPERAND_M }, TUPLE_N4 },
+    { "vmovss",        0xF30F10,   -1, INSN_128, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vmovss",        0xF30F11,   -1, INSN_128, 3, { OPERAND_X, OPERAND_XV, OPERAND_XR }, TUPLE_N4 },
+    { "vmovsd",        0xF20F10,   -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_M, OPERAND_X }, TUPLE_N8 },
+    { "vmovsd",        0xF20F11,   -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_X, OPERAND_M }, TUPLE_N8 },
+    { "vmovsd",        0xF20F10,   -1, INSN_128 | INSN_VEX_W, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmovsd",        0xF20F11,   -1, INSN_128 | INSN_VEX_W, 3, { OPERAND_X, OPERAND_XV, OPERAND_XR }, TUPLE_N8 },
+    { "vmovd",         0x660F6E,   -1, INSN_128 | INSN_NOMASK, 2, { OPERAND_RM32, OPERAND_X }, TUPLE_N4 },
+    { "vmovd",         0x660F7E,   -1, INSN_128 | INSN_NOMASK, 2, { OPERAND_X, OPERAND_RM32 }, TUPLE_N4 },
+    { "vmovq",         0x660F6E,   -1, INSN_128 | INSN_VEX_W | INSN_Q | INSN_NOMASK, 2, { OPERAND_RM, OPERAND_X }, TUPLE_N8 },
+    { "vmovq",         0x660F7E,   -1, INSN_128 | INSN_VEX_W | INSN_Q | INSN_NOMASK, 2, { OPERAND_X, OPERAND_RM }, TUPLE_N8 },
+    { "vmovq",         0xF30F7E,   -1, INSN_128 | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_XM, OPERAND_X }, TUPLE_N8 },
+    { "vmovq",         0x660FD6,   -1, INSN_128 | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_X, OPERAND_XM }, TUPLE_N8 },
+    { "vmovlps",       0x0F12,     -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_M, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmovlps",       0x0F13,     -1, INSN_128 | INSN_NOMASK, 2, { OPERAND_X, OPERAND_M }, TUPLE_N8 },
+    { "vmovlpd",       0x660F12,   -1, INSN_128 | INSN_VEX_W | INSN_NOMASK, 3, { OPERAND_M, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmovlpd",       0x660F13,   -1, INSN_128 | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_X, OPERAND_M }, TUPLE_N8 },
+    { "vmovhps",       0x0F16,     -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_M, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmovhps",       0x0F17,     -1, INSN_128 | INSN_NOMASK, 2, { OPERAND_X, OPERAND_M }, TUPLE_N8 },
+    { "vmovhpd",       0x660F16,   -1, INSN_128 | INSN_VEX_W | INSN_NOMASK, 3, { OPERAND_M, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmovhpd",       0x660F17,   -1, INSN_128 | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_X, OPERAND_M }, TUPLE_N8 },
+    { "vmovhlps",      0x0F12,     -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmovlhps",      0x0F16,     -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_XR, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmovntps",      0x0F2B,     -1, INSN_VL | INSN_NOMASK, 2, { OPERAND_V, OPERAND_M }, TUPLE_FVM },
+    { "vmovntpd",      0x660F2B,   -1, INSN_VL | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_V, OPERAND_M }, TUPLE_FVM },
+    { "vmovntdq",      0x660FE7,   -1, INSN_VL | INSN_NOMASK, 2, { OPERAND_V, OPERAND_M }, TUPLE_FVM },
+    { "vmovntdqa",     0x660F382A, -1, INSN_VL | INSN_NOMASK, 2, { OPERAND_M, OPERAND_V }, TUPLE_FVM },
+    { "vmovddup",      0xF20F12,   -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_DUP },
+    { "vmovshdup",     0xF30F16,   -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vmovsldup",     0xF30F12,   -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vaddps",        0x0F58,     -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vaddpd",        0x660F58,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vaddss",        0xF30F58,   -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vaddsd",        0xF20F58,   -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vsubps",        0x0F5C,     -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vsubpd",        0x660F5C,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vsubss",        0xF30F5C,   -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vsubsd",        0xF20F5C,   -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmulps",        0x0F59,     -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vmulpd",        0x660F59,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vmulss",        0xF30F59,   -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vmulsd",        0xF20F59,   -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vdivps",        0x0F5E,     -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vdivpd",        0x660F5E,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vdivss",        0xF30F5E,   -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vdivsd",        0xF20F5E,   -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vminps",        0x0F5D,     -1, INSN_VL | INSN_SAE, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vminpd",        0x660F5D,   -1, INSN_VL | INSN_VEX_W | INSN_SAE, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vminss",        0xF30F5D,   -1, INSN_128 | INSN_SAE, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vminsd",        0xF20F5D,   -1, INSN_128 | INSN_VEX_W | INSN_SAE, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vmaxps",        0x0F5F,     -1, INSN_VL | INSN_SAE, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vmaxpd",        0x660F5F,   -1, INSN_VL | INSN_VEX_W | INSN_SAE, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vmaxss",        0xF30F5F,   -1, INSN_128 | INSN_SAE, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vmaxsd",        0xF20F5F,   -1, INSN_128 | INSN_VEX_W | INSN_SAE, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vsqrtps",       0x0F51,     -1, INSN_VL | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vsqrtpd",       0x660F51,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vsqrtss",       0xF30F51,   -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vsqrtsd",       0xF20F51,   -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vandps",        0x0F54,     -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vandpd",        0x660F54,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vandnps",       0x0F55,     -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vandnpd",       0x660F55,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vorps",         0x0F56,     -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vorpd",         0x660F56,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vxorps",        0x0F57,     -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vxorpd",        0x660F57,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vunpcklps",     0x0F14,     -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vunpcklpd",     0x660F14,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vunpckhps",     0x0F15,     -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vunpckhpd",     0x660F15,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vshufps",       0x0FC6,     -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vshufpd",       0x660FC6,   -1, INSN_VL | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vcmpps",        0x0FC2,     -1, INSN_VL | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vcmppd",        0x660FC2,   -1, INSN_VL | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vcmpss",        0xF30FC2,   -1, INSN_128 | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_K }, TUPLE_N4 },
+    { "vcmpsd",        0xF20FC2,   -1, INSN_128 | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_K }, TUPLE_N8 },
+    { "vcomiss",       0x0F2F,     -1, INSN_128 | INSN_SAE | INSN_NOMASK, 2, { OPERAND_XM, OPERAND_X }, TUPLE_N4 },
+    { "vcomisd",       0x660F2F,   -1, INSN_128 | INSN_VEX_W | INSN_SAE | INSN_NOMASK, 2, { OPERAND_XM, OPERAND_X }, TUPLE_N8 },
+    { "vucomiss",      0x0F2E,     -1, INSN_128 | INSN_SAE | INSN_NOMASK, 2, { OPERAND_XM, OPERAND_X }, TUPLE_N4 },
+    { "vucomisd",      0x660F2E,   -1, INSN_128 | INSN_VEX_W | INSN_SAE | INSN_NOMASK, 2, { OPERAND_XM, OPERAND_X }, TUPLE_N8 },
+    { "vrcp14ps",      0x660F384C, -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vrcp14pd",      0x660F384C, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vrcp14ss",      0x660F384D, -1, INSN_128, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vrcp14sd",      0x660F384D, -1, INSN_128 | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vrsqrt14ps",    0x660F384E, -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vrsqrt14pd",    0x660F384E, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vrsqrt14ss",    0x660F384F, -1, INSN_128, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vrsqrt14sd",    0x660F384F, -1, INSN_128 | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vscalefps",     0x660F382C, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vscalefpd",     0x660F382C, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vscalefss",     0x660F382D, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vscalefsd",     0x660F382D, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vgetexpps",     0x660F3842, -1, INSN_VL | INSN_SAE, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vgetexppd",     0x660F3842, -1, INSN_VL | INSN_VEX_W | INSN_SAE, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vgetexpss",     0x660F3843, -1, INSN_128 | INSN_SAE, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vgetexpsd",     0x660F3843, -1, INSN_128 | INSN_VEX_W | INSN_SAE, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vgetmantps",    0x660F3A26, -1, INSN_VL | INSN_SAE, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vgetmantpd",    0x660F3A26, -1, INSN_VL | INSN_VEX_W | INSN_SAE, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vgetmantss",    0x660F3A27, -1, INSN_128 | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vgetmantsd",    0x660F3A27, -1, INSN_128 | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vrndscaleps",   0x660F3A08, -1, INSN_VL | INSN_SAE, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vrndscalepd",   0x660F3A09, -1, INSN_VL | INSN_VEX_W | INSN_SAE, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vrndscaless",   0x660F3A0A, -1, INSN_128 | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vrndscalesd",   0x660F3A0B, -1, INSN_128 | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfixupimmps",   0x660F3A54, -1, INSN_VL | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfixupimmpd",   0x660F3A54, -1, INSN_VL | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfixupimmss",   0x660F3A55, -1, INSN_128 | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfixupimmsd",   0x660F3A55, -1, INSN_128 | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vrangeps",      0x660F3A50, -1, INSN_VL | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vrangepd",      0x660F3A50, -1, INSN_VL | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vrangess",      0x660F3A51, -1, INSN_128 | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vrangesd",      0x660F3A51, -1, INSN_128 | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vreduceps",     0x660F3A56, -1, INSN_VL | INSN_SAE, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vreducepd",     0x660F3A56, -1, INSN_VL | INSN_VEX_W | INSN_SAE, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vreducess",     0x660F3A57, -1, INSN_128 | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vreducesd",     0x660F3A57, -1, INSN_128 | INSN_VEX_W | INSN_SAE, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfpclassps",    0x660F3A66, -1, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VR, OPERAND_K }, TUPLE_FV },
+    { "vfpclasspsx",   0x660F3A66, -1, INSN_128, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_K }, TUPLE_FV },
+    { "vfpclasspsy",   0x660F3A66, -1, INSN_256, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_K }, TUPLE_FV },
+    { "vfpclasspsz",   0x660F3A66, -1, INSN_512, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_K }, TUPLE_FV },
+    { "vfpclasspd",    0x660F3A66, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VR, OPERAND_K }, TUPLE_FV },
+    { "vfpclasspdx",   0x660F3A66, -1, INSN_128 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_K }, TUPLE_FV },
+    { "vfpclasspdy",   0x660F3A66, -1, INSN_256 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_K }, TUPLE_FV },
+    { "vfpclasspdz",   0x660F3A66, -1, INSN_512 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_K }, TUPLE_FV },
+    { "vfpclassss",    0x660F3A67, -1, INSN_128, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_K }, TUPLE_N4 },
+    { "vfpclasssd",    0x660F3A67, -1, INSN_128 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_XM, OPERAND_K }, TUPLE_N8 },
+    { "vfmaddsub132ps",0x660F3896, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmaddsub132pd",0x660F3896, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmaddsub213ps",0x660F38A6, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmaddsub213pd",0x660F38A6, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmaddsub231ps",0x660F38B6, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmaddsub231pd",0x660F38B6, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsubadd132ps",0x660F3897, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsubadd132pd",0x660F3897, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsubadd213ps",0x660F38A7, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsubadd213pd",0x660F38A7, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsubadd231ps",0x660F38B7, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsubadd231pd",0x660F38B7, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmadd132ps",   0x660F3898, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmadd132pd",   0x660F3898, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmadd132ss",   0x660F3899, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfmadd132sd",   0x660F3899, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfmadd213ps",   0x660F38A8, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmadd213pd",   0x660F38A8, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmadd213ss",   0x660F38A9, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfmadd213sd",   0x660F38A9, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfmadd231ps",   0x660F38B8, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmadd231pd",   0x660F38B8, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmadd231ss",   0x660F38B9, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfmadd231sd",   0x660F38B9, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfmsub132ps",   0x660F389A, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsub132pd",   0x660F389A, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsub132ss",   0x660F389B, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfmsub132sd",   0x660F389B, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfmsub213ps",   0x660F38AA, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsub213pd",   0x660F38AA, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsub213ss",   0x660F38AB, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfmsub213sd",   0x660F38AB, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfmsub231ps",   0x660F38BA, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsub231pd",   0x660F38BA, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfmsub231ss",   0x660F38BB, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfmsub231sd",   0x660F38BB, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfnmadd132ps",  0x660F389C, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmadd132pd",  0x660F389C, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmadd132ss",  0x660F389D, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfnmadd132sd",  0x660F389D, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfnmadd213ps",  0x660F38AC, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmadd213pd",  0x660F38AC, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmadd213ss",  0x660F38AD, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfnmadd213sd",  0x660F38AD, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfnmadd231ps",  0x660F38BC, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmadd231pd",  0x660F38BC, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmadd231ss",  0x660F38BD, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfnmadd231sd",  0x660F38BD, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfnmsub132ps",  0x660F389E, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmsub132pd",  0x660F389E, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmsub132ss",  0x660F389F, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfnmsub132sd",  0x660F389F, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfnmsub213ps",  0x660F38AE, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmsub213pd",  0x660F38AE, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmsub213ss",  0x660F38AF, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfnmsub213sd",  0x660F38AF, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vfnmsub231ps",  0x660F38BE, -1, INSN_VL | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmsub231pd",  0x660F38BE, -1, INSN_VL | INSN_VEX_W | INSN_ER, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vfnmsub231ss",  0x660F38BF, -1, INSN_128 | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vfnmsub231sd",  0x660F38BF, -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vcvtdq2ps",     0x0F5B,     -1, INSN_VL | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtps2dq",     0x660F5B,   -1, INSN_VL | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvttps2dq",    0xF30F5B,   -1, INSN_VL | INSN_SAE, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtps2udq",    0x0F79,     -1, INSN_VL | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvttps2udq",   0x0F78,     -1, INSN_VL | INSN_SAE, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtudq2ps",    0xF20F7A,   -1, INSN_VL | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtqq2pd",     0xF30FE6,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtuqq2pd",    0xF30F7A,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtpd2qq",     0x660F7B,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvttpd2qq",    0x660F7A,   -1, INSN_VL | INSN_VEX_W | INSN_SAE, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtpd2uqq",    0x660F79,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvttpd2uqq",   0x660F78,   -1, INSN_VL | INSN_VEX_W | INSN_SAE, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vcvtps2pd",     0x0F5A,     -1, INSN_VL | INSN_SAE, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HV },
+    { "vcvtdq2pd",     0xF30FE6,   -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HV },
+    { "vcvtudq2pd",    0xF30F7A,   -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HV },
+    { "vcvtps2qq",     0x660F7B,   -1, INSN_VL | INSN_ER, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HV },
+    { "vcvttps2qq",    0x660F7A,   -1, INSN_VL | INSN_SAE, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HV },
+    { "vcvtps2uqq",    0x660F79,   -1, INSN_VL | INSN_ER, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HV },
+    { "vcvttps2uqq",   0x660F78,   -1, INSN_VL | INSN_SAE, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HV },
+    { "vcvtpd2ps",     0x660F5A,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VR, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2ps",     0x660F5A,   -1, INSN_512 | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2psx",    0x660F5A,   -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2psy",    0x660F5A,   -1, INSN_256 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2dq",     0xF20FE6,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VR, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2dq",     0xF20FE6,   -1, INSN_512 | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2dqx",    0xF20FE6,   -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2dqy",    0xF20FE6,   -1, INSN_256 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2dq",    0x660FE6,   -1, INSN_VL | INSN_VEX_W | INSN_SAE, 2, { OPERAND_VR, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2dq",    0x660FE6,   -1, INSN_512 | INSN_VEX_W | INSN_SAE, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2dqx",   0x660FE6,   -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2dqy",   0x660FE6,   -1, INSN_256 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2udq",    0x0F79,     -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VR, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2udq",    0x0F79,     -1, INSN_512 | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2udqx",   0x0F79,     -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtpd2udqy",   0x0F79,     -1, INSN_256 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2udq",   0x0F78,     -1, INSN_VL | INSN_VEX_W | INSN_SAE, 2, { OPERAND_VR, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2udq",   0x0F78,     -1, INSN_512 | INSN_VEX_W | INSN_SAE, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2udqx",  0x0F78,     -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvttpd2udqy",  0x0F78,     -1, INSN_256 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtqq2ps",     0x0F5B,     -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VR, OPERAND_H }, TUPLE_FV },
+    { "vcvtqq2ps",     0x0F5B,     -1, INSN_512 | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtqq2psx",    0x0F5B,     -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtqq2psy",    0x0F5B,     -1, INSN_256 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtuqq2ps",    0xF20F7A,   -1, INSN_VL | INSN_VEX_W | INSN_ER, 2, { OPERAND_VR, OPERAND_H }, TUPLE_FV },
+    { "vcvtuqq2ps",    0xF20F7A,   -1, INSN_512 | INSN_VEX_W | INSN_ER, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtuqq2psx",   0xF20F7A,   -1, INSN_128 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtuqq2psy",   0xF20F7A,   -1, INSN_256 | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_H }, TUPLE_FV },
+    { "vcvtsd2ss",     0xF20F5A,   -1, INSN_128 | INSN_VEX_W | INSN_ER, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vcvtss2sd",     0xF30F5A,   -1, INSN_128 | INSN_SAE, 3, { OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vcvtsi2ss",     0xF30F2A,   -1, INSN_128 | INSN_ER | INSN_L | INSN_NOMASK, 3, { OPERAND_RM32, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vcvtsi2ss",     0xF30F2A,   -1, INSN_128 | INSN_VEX_W | INSN_ER | INSN_Q | INSN_NOMASK, 3, { OPERAND_RM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vcvtsi2sd",     0xF20F2A,   -1, INSN_128 | INSN_L | INSN_NOMASK, 3, { OPERAND_RM32, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vcvtsi2sd",     0xF20F2A,   -1, INSN_128 | INSN_VEX_W | INSN_ER | INSN_Q | INSN_NOMASK, 3, { OPERAND_RM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vcvtusi2ss",    0xF30F7B,   -1, INSN_128 | INSN_ER | INSN_L | INSN_NOMASK, 3, { OPERAND_RM32, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vcvtusi2ss",    0xF30F7B,   -1, INSN_128 | INSN_VEX_W | INSN_ER | INSN_Q | INSN_NOMASK, 3, { OPERAND_RM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vcvtusi2sd",    0xF20F7B,   -1, INSN_128 | INSN_L | INSN_NOMASK, 3, { OPERAND_RM32, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vcvtusi2sd",    0xF20F7B,   -1, INSN_128 | INSN_VEX_W | INSN_ER | INSN_Q | INSN_NOMASK, 3, { OPERAND_RM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vcvtss2si",     0xF30F2D,   -1, INSN_128 | INSN_ER | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N4 },
+    { "vcvttss2si",    0xF30F2C,   -1, INSN_128 | INSN_SAE | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N4 },
+    { "vcvtss2usi",    0xF30F79,   -1, INSN_128 | INSN_ER | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N4 },
+    { "vcvttss2usi",   0xF30F78,   -1, INSN_128 | INSN_SAE | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N4 },
+    { "vcvtsd2si",     0xF20F2D,   -1, INSN_128 | INSN_ER | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N8 },
+    { "vcvttsd2si",    0xF20F2C,   -1, INSN_128 | INSN_SAE | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N8 },
+    { "vcvtsd2usi",    0xF20F79,   -1, INSN_128 | INSN_ER | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N8 },
+    { "vcvttsd2usi",   0xF20F78,   -1, INSN_128 | INSN_SAE | INSN_LQ, 2, { OPERAND_XM, OPERAND_R }, TUPLE_N8 },
+    { "vbroadcastss",  0x660F3818, -1, INSN_VL, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N4 },
+    { "vbroadcastsd",  0x660F3819, -1, INSN_256 | INSN_512 | INSN_VEX_W, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N8 },
+    { "vbroadcastf32x2",0x660F3819, -1, INSN_256 | INSN_512, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N8 },
+    { "vbroadcastf32x4",0x660F381A, -1, INSN_256 | INSN_512, 2, { OPERAND_M, OPERAND_V }, TUPLE_N16 },
+    { "vbroadcastf64x2",0x660F381A, -1, INSN_256 | INSN_512 | INSN_VEX_W, 2, { OPERAND_M, OPERAND_V }, TUPLE_N16 },
+    { "vbroadcastf32x8",0x660F381B, -1, INSN_512, 2, { OPERAND_M, OPERAND_V }, TUPLE_N32 },
+    { "vbroadcastf64x4",0x660F381B, -1, INSN_512 | INSN_VEX_W, 2, { OPERAND_M, OPERAND_V }, TUPLE_N32 },
+    { "vbroadcasti32x2",0x660F3859, -1, INSN_VL, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N8 },
+    { "vbroadcasti32x4",0x660F385A, -1, INSN_256 | INSN_512, 2, { OPERAND_M, OPERAND_V }, TUPLE_N16 },
+    { "vbroadcasti64x2",0x660F385A, -1, INSN_256 | INSN_512 | INSN_VEX_W, 2, { OPERAND_M, OPERAND_V }, TUPLE_N16 },
+    { "vbroadcasti32x8",0x660F385B, -1, INSN_512, 2, { OPERAND_M, OPERAND_V }, TUPLE_N32 },
+    { "vbroadcasti64x4",0x660F385B, -1, INSN_512 | INSN_VEX_W, 2, { OPERAND_M, OPERAND_V }, TUPLE_N32 },
+    { "vpbroadcastb",  0x660F3878, -1, INSN_VL, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N1 },
+    { "vpbroadcastb",  0x660F387A, -1, INSN_VL, 2, { OPERAND_R32, OPERAND_V }, TUPLE_N1 },
+    { "vpbroadcastw",  0x660F3879, -1, INSN_VL, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N2 },
+    { "vpbroadcastw",  0x660F387B, -1, INSN_VL, 2, { OPERAND_R32, OPERAND_V }, TUPLE_N2 },
+    { "vpbroadcastd",  0x660F3858, -1, INSN_VL, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N4 },
+    { "vpbroadcastd",  0x660F387C, -1, INSN_VL, 2, { OPERAND_R32, OPERAND_V }, TUPLE_N4 },
+    { "vpbroadcastq",  0x660F3859, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_XM, OPERAND_V }, TUPLE_N8 },
+    { "vpbroadcastq",  0x660F387C, -1, INSN_VL | INSN_VEX_W | INSN_Q, 2, { OPERAND_RM, OPERAND_V }, TUPLE_N8 },
+    { "vinsertf32x4",  0x660F3A18, -1, INSN_256 | INSN_512, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vinsertf64x2",  0x660F3A18, -1, INSN_256 | INSN_512 | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vinsertf32x8",  0x660F3A1A, -1, INSN_512, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_VV, OPERAND_V }, TUPLE_N32 },
+    { "vinsertf64x4",  0x660F3A1A, -1, INSN_512 | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_VV, OPERAND_V }, TUPLE_N32 },
+    { "vextractf32x4", 0x660F3A19, -1, INSN_256 | INSN_512, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_XM }, TUPLE_N16 },
+    { "vextractf64x2", 0x660F3A19, -1, INSN_256 | INSN_512 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_XM }, TUPLE_N16 },
+    { "vextractf32x8", 0x660F3A1B, -1, INSN_512, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_YM }, TUPLE_N32 },
+    { "vextractf64x4", 0x660F3A1B, -1, INSN_512 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_YM }, TUPLE_N32 },
+    { "vshuff32x4",    0x660F3A23, -1, INSN_256 | INSN_512, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vshuff64x2",    0x660F3A23, -1, INSN_256 | INSN_512 | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vinserti32x4",  0x660F3A38, -1, INSN_256 | INSN_512, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vinserti64x2",  0x660F3A38, -1, INSN_256 | INSN_512 | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vinserti32x8",  0x660F3A3A, -1, INSN_512, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_VV, OPERAND_V }, TUPLE_N32 },
+    { "vinserti64x4",  0x660F3A3A, -1, INSN_512 | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_YM, OPERAND_VV, OPERAND_V }, TUPLE_N32 },
+    { "vextracti32x4", 0x660F3A39, -1, INSN_256 | INSN_512, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_XM }, TUPLE_N16 },
+    { "vextracti64x2", 0x660F3A39, -1, INSN_256 | INSN_512 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_XM }, TUPLE_N16 },
+    { "vextracti32x8", 0x660F3A3B, -1, INSN_512, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_YM }, TUPLE_N32 },
+    { "vextracti64x4", 0x660F3A3B, -1, INSN_512 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_V, OPERAND_YM }, TUPLE_N32 },
+    { "vshufi32x4",    0x660F3A43, -1, INSN_256 | INSN_512, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vshufi64x2",    0x660F3A43, -1, INSN_256 | INSN_512 | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermps",       0x660F3816, -1, INSN_256 | INSN_512, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermpd",       0x660F3816, -1, INSN_256 | INSN_512 | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermd",        0x660F3836, -1, INSN_256 | INSN_512, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermq",        0x660F3836, -1, INSN_256 | INSN_512 | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermq",        0x660F3A00, -1, INSN_256 | INSN_512 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vpermpd",       0x660F3A01, -1, INSN_256 | INSN_512 | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vpermilps",     0x660F380C, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermilpd",     0x660F380D, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermilps",     0x660F3A04, -1, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vpermilpd",     0x660F3A05, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vpermi2d",      0x660F3876, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermi2q",      0x660F3876, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermi2ps",     0x660F3877, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermi2pd",     0x660F3877, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermi2w",      0x660F3875, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpermt2d",      0x660F387E, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermt2q",      0x660F387E, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermt2ps",     0x660F387F, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermt2pd",     0x660F387F, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpermt2w",      0x660F387D, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpermw",        0x660F388D, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vblendmps",     0x660F3865, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vblendmpd",     0x660F3865, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpblendmd",     0x660F3864, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpblendmq",     0x660F3864, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpblendmb",     0x660F3866, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpblendmw",     0x660F3866, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "valignd",       0x660F3A03, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "valignq",       0x660F3A03, -1, INSN_VL | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpternlogd",    0x660F3A25, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpternlogq",    0x660F3A25, -1, INSN_VL | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vcompressps",   0x660F388A, -1, INSN_VL, 2, { OPERAND_V, OPERAND_VM }, TUPLE_N4 },
+    { "vcompresspd",   0x660F388A, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VM }, TUPLE_N8 },
+    { "vpcompressd",   0x660F388B, -1, INSN_VL, 2, { OPERAND_V, OPERAND_VM }, TUPLE_N4 },
+    { "vpcompressq",   0x660F388B, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VM }, TUPLE_N8 },
+    { "vexpandps",     0x660F3888, -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_N4 },
+    { "vexpandpd",     0x660F3888, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_N8 },
+    { "vpexpandd",     0x660F3889, -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_N4 },
+    { "vpexpandq",     0x660F3889, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_N8 },
+    { "vpgatherdd",    0x660F3890, -1, INSN_VL, 2, { OPERAND_VS, OPERAND_V }, TUPLE_N4 },
+    { "vpgatherdq",    0x660F3890, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_HS, OPERAND_V }, TUPLE_N8 },
+    { "vpgatherqd",    0x660F3891, -1, INSN_VL, 2, { OPERAND_VS, OPERAND_H }, TUPLE_N4 },
+    { "vpgatherqq",    0x660F3891, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VS, OPERAND_V }, TUPLE_N8 },
+    { "vgatherdps",    0x660F3892, -1, INSN_VL, 2, { OPERAND_VS, OPERAND_V }, TUPLE_N4 },
+    { "vgatherdpd",    0x660F3892, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_HS, OPERAND_V }, TUPLE_N8 },
+    { "vgatherqps",    0x660F3893, -1, INSN_VL, 2, { OPERAND_VS, OPERAND_H }, TUPLE_N4 },
+    { "vgatherqpd",    0x660F3893, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VS, OPERAND_V }, TUPLE_N8 },
+    { "vpscatterdd",   0x660F38A0, -1, INSN_VL, 2, { OPERAND_V, OPERAND_VS }, TUPLE_N4 },
+    { "vpscatterdq",   0x660F38A0, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_HS }, TUPLE_N8 },
+    { "vpscatterqd",   0x660F38A1, -1, INSN_VL, 2, { OPERAND_H, OPERAND_VS }, TUPLE_N4 },
+    { "vpscatterqq",   0x660F38A1, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VS }, TUPLE_N8 },
+    { "vscatterdps",   0x660F38A2, -1, INSN_VL, 2, { OPERAND_V, OPERAND_VS }, TUPLE_N4 },
+    { "vscatterdpd",   0x660F38A2, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_HS }, TUPLE_N8 },
+    { "vscatterqps",   0x660F38A3, -1, INSN_VL, 2, { OPERAND_H, OPERAND_VS }, TUPLE_N4 },
+    { "vscatterqpd",   0x660F38A3, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_V, OPERAND_VS }, TUPLE_N8 },
+    { "vpaddd",        0x660FFE,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpaddq",        0x660FD4,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsubd",        0x660FFA,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsubq",        0x660FFB,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmuludq",      0x660FF4,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpandd",        0x660FDB,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpandq",        0x660FDB,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpandnd",       0x660FDF,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpandnq",       0x660FDF,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpord",         0x660FEB,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vporq",         0x660FEB,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpxord",        0x660FEF,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpxorq",        0x660FEF,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpunpckldq",    0x660F62,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpunpcklqdq",   0x660F6C,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpunpckhdq",    0x660F6A,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpunpckhqdq",   0x660F6D,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpackssdw",     0x660F6B,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmulld",       0x660F3840, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmullq",       0x660F3840, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmuldq",       0x660F3828, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpminsd",       0x660F3839, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpminsq",       0x660F3839, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpminud",       0x660F383B, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpminuq",       0x660F383B, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmaxsd",       0x660F383D, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmaxsq",       0x660F383D, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmaxud",       0x660F383F, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpmaxuq",       0x660F383F, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsllvd",       0x660F3847, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsllvq",       0x660F3847, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsrlvd",       0x660F3845, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsrlvq",       0x660F3845, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsravd",       0x660F3846, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpsravq",       0x660F3846, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vprolvd",       0x660F3815, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vprolvq",       0x660F3815, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vprorvd",       0x660F3814, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vprorvq",       0x660F3814, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpackusdw",     0x660F382B, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FV },
+    { "vpabsd",        0x660F381E, -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vpabsq",        0x660F381F, -1, INSN_VL | INSN_VEX_W, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vpcmpeqd",      0x660F76,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vpcmpeqq",      0x660F3829, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vpcmpgtd",      0x660F66,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vpcmpgtq",      0x660F3837, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vpcmpd",        0x660F3A1F, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vpcmpud",       0x660F3A1E, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vpcmpq",        0x660F3A1F, -1, INSN_VL | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vpcmpuq",       0x660F3A1E, -1, INSN_VL | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vptestmd",      0x660F3827, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vptestmq",      0x660F3827, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vptestmb",      0x660F3826, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vptestmw",      0x660F3826, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vptestnmd",     0xF30F3827, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vptestnmq",     0xF30F3827, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FV },
+    { "vptestnmb",     0xF30F3826, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vptestnmw",     0xF30F3826, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpaddb",        0x660FFC,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpaddw",        0x660FFD,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsubb",        0x660FF8,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsubw",        0x660FF9,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpaddsb",       0x660FEC,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpaddsw",       0x660FED,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpaddusb",      0x660FDC,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpaddusw",      0x660FDD,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsubsb",       0x660FE8,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsubsw",       0x660FE9,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsubusb",      0x660FD8,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsubusw",      0x660FD9,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmullw",       0x660FD5,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmulhw",       0x660FE5,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmulhuw",      0x660FE4,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmaddwd",      0x660FF5,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpavgb",        0x660FE0,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpavgw",        0x660FE3,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmaxub",       0x660FDE,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpminub",       0x660FDA,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmaxsw",       0x660FEE,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpminsw",       0x660FEA,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsadbw",       0x660FF6,   -1, INSN_VL | INSN_NOMASK, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpacksswb",     0x660F63,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpackuswb",     0x660F67,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpunpcklbw",    0x660F60,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpunpcklwd",    0x660F61,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpunpckhbw",    0x660F68,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpunpckhwd",    0x660F69,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpcmpeqb",      0x660F74,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpcmpeqw",      0x660F75,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpcmpgtb",      0x660F64,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpcmpgtw",      0x660F65,   -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpshufb",       0x660F3800, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmaddubsw",    0x660F3804, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmulhrsw",     0x660F380B, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpminsb",       0x660F3838, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmaxsb",       0x660F383C, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpminuw",       0x660F383A, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpmaxuw",       0x660F383E, -1, INSN_VL, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsllvw",       0x660F3812, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsrlvw",       0x660F3810, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpsravw",       0x660F3811, -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpabsb",        0x660F381C, -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vpabsw",        0x660F381D, -1, INSN_VL, 2, { OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vpcmpb",        0x660F3A3F, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpcmpub",       0x660F3A3E, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpcmpw",        0x660F3A3F, -1, INSN_VL | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpcmpuw",       0x660F3A3E, -1, INSN_VL | INSN_VEX_W, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_K }, TUPLE_FVM },
+    { "vpalignr",      0x660F3A0F, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vdbpsadbw",     0x660F3A42, -1, INSN_VL, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpshufd",       0x660F70,   -1, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FV },
+    { "vpshufhw",      0xF30F70,   -1, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vpshuflw",      0xF20F70,   -1, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_V }, TUPLE_FVM },
+    { "vpsllw",        0x660FF1,   -1, INSN_VL, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsllw",        0x660F71,    6, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FVM },
+    { "vpslld",        0x660FF2,   -1, INSN_VL, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpslld",        0x660F72,    6, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vpsllq",        0x660FF3,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsllq",        0x660F73,    6, INSN_VL | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vpsrlw",        0x660FD1,   -1, INSN_VL, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsrlw",        0x660F71,    2, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FVM },
+    { "vpsrld",        0x660FD2,   -1, INSN_VL, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsrld",        0x660F72,    2, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vpsrlq",        0x660FD3,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsrlq",        0x660F73,    2, INSN_VL | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vpsraw",        0x660FE1,   -1, INSN_VL, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsraw",        0x660F71,    4, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FVM },
+    { "vpsrad",        0x660FE2,   -1, INSN_VL, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsrad",        0x660F72,    4, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vpsraq",        0x660FE2,   -1, INSN_VL | INSN_VEX_W, 3, { OPERAND_XM, OPERAND_VV, OPERAND_V }, TUPLE_N16 },
+    { "vpsraq",        0x660F72,    4, INSN_VL | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vprold",        0x660F72,    1, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vprolq",        0x660F72,    1, INSN_VL | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vprord",        0x660F72,    0, INSN_VL, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vprorq",        0x660F72,    0, INSN_VL | INSN_VEX_W, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FV },
+    { "vpslldq",       0x660F73,    7, INSN_VL | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FVM },
+    { "vpsrldq",       0x660F73,    3, INSN_VL | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV }, TUPLE_FVM },
+    { "vpmovsxbw",     0x660F3820, -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HVM },
+    { "vpmovsxbd",     0x660F3821, -1, INSN_VL, 2, { OPERAND_QM, OPERAND_V }, TUPLE_QVM },
+    { "vpmovsxbq",     0x660F3822, -1, INSN_VL, 2, { OPERAND_OM, OPERAND_V }, TUPLE_OVM },
+    { "vpmovsxwd",     0x660F3823, -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HVM },
+    { "vpmovsxwq",     0x660F3824, -1, INSN_VL, 2, { OPERAND_QM, OPERAND_V }, TUPLE_QVM },
+    { "vpmovsxdq",     0x660F3825, -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HVM },
+    { "vpmovzxbw",     0x660F3830, -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HVM },
+    { "vpmovzxbd",     0x660F3831, -1, INSN_VL, 2, { OPERAND_QM, OPERAND_V }, TUPLE_QVM },
+    { "vpmovzxbq",     0x660F3832, -1, INSN_VL, 2, { OPERAND_OM, OPERAND_V }, TUPLE_OVM },
+    { "vpmovzxwd",     0x660F3833, -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HVM },
+    { "vpmovzxwq",     0x660F3834, -1, INSN_VL, 2, { OPERAND_QM, OPERAND_V }, TUPLE_QVM },
+    { "vpmovzxdq",     0x660F3835, -1, INSN_VL, 2, { OPERAND_HM, OPERAND_V }, TUPLE_HVM },
+    { "vpmovwb",       0xF30F3830, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovswb",      0xF30F3820, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovuswb",     0xF30F3810, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovdb",       0xF30F3831, -1, INSN_VL, 2, { OPERAND_V, OPERAND_QM }, TUPLE_QVM },
+    { "vpmovsdb",      0xF30F3821, -1, INSN_VL, 2, { OPERAND_V, OPERAND_QM }, TUPLE_QVM },
+    { "vpmovusdb",     0xF30F3811, -1, INSN_VL, 2, { OPERAND_V, OPERAND_QM }, TUPLE_QVM },
+    { "vpmovqb",       0xF30F3832, -1, INSN_VL, 2, { OPERAND_V, OPERAND_OM }, TUPLE_OVM },
+    { "vpmovsqb",      0xF30F3822, -1, INSN_VL, 2, { OPERAND_V, OPERAND_OM }, TUPLE_OVM },
+    { "vpmovusqb",     0xF30F3812, -1, INSN_VL, 2, { OPERAND_V, OPERAND_OM }, TUPLE_OVM },
+    { "vpmovdw",       0xF30F3833, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovsdw",      0xF30F3823, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovusdw",     0xF30F3813, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovqw",       0xF30F3834, -1, INSN_VL, 2, { OPERAND_V, OPERAND_QM }, TUPLE_QVM },
+    { "vpmovsqw",      0xF30F3824, -1, INSN_VL, 2, { OPERAND_V, OPERAND_QM }, TUPLE_QVM },
+    { "vpmovusqw",     0xF30F3814, -1, INSN_VL, 2, { OPERAND_V, OPERAND_QM }, TUPLE_QVM },
+    { "vpmovqd",       0xF30F3835, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovsqd",      0xF30F3825, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovusqd",     0xF30F3815, -1, INSN_VL, 2, { OPERAND_V, OPERAND_HM }, TUPLE_HVM },
+    { "vpmovm2b",      0xF30F3828, -1, INSN_VL | INSN_NOMASK, 2, { OPERAND_KR, OPERAND_V }, TUPLE_FVM },
+    { "vpmovm2w",      0xF30F3828, -1, INSN_VL | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_KR, OPERAND_V }, TUPLE_FVM },
+    { "vpmovm2d",      0xF30F3838, -1, INSN_VL | INSN_NOMASK, 2, { OPERAND_KR, OPERAND_V }, TUPLE_FVM },
+    { "vpmovm2q",      0xF30F3838, -1, INSN_VL | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_KR, OPERAND_V }, TUPLE_FVM },
+    { "vpmovb2m",      0xF30F3829, -1, INSN_VL | INSN_NOMASK, 2, { OPERAND_VR, OPERAND_K }, TUPLE_FVM },
+    { "vpmovw2m",      0xF30F3829, -1, INSN_VL | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_VR, OPERAND_K }, TUPLE_FVM },
+    { "vpmovd2m",      0xF30F3839, -1, INSN_VL | INSN_NOMASK, 2, { OPERAND_VR, OPERAND_K }, TUPLE_FVM },
+    { "vpmovq2m",      0xF30F3839, -1, INSN_VL | INSN_VEX_W | INSN_NOMASK, 2, { OPERAND_VR, OPERAND_K }, TUPLE_FVM },
+    { "vpextrb",       0x660F3A14, -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RMLQ }, TUPLE_N1 },
+    { "vpextrw",       0x660FC5,   -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_XR, OPERAND_RLQ }, TUPLE_N2 },
+    { "vpextrw",       0x660F3A15, -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_M }, TUPLE_N2 },
+    { "vpextrd",       0x660F3A16, -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RM32 }, TUPLE_N4 },
+    { "vpextrq",       0x660F3A16, -1, INSN_128 | INSN_VEX_W | INSN_Q | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RM }, TUPLE_N8 },
+    { "vextractps",    0x660F3A17, -1, INSN_128 | INSN_NOMASK, 3, { OPERAND_UIMM8, OPERAND_X, OPERAND_RMLQ }, TUPLE_N4 },
+    { "vpinsrb",       0x660F3A20, -1, INSN_128 | INSN_NOMASK, 4, { OPERAND_UIMM8, OPERAND_RMLQ, OPERAND_XV, OPERAND_X }, TUPLE_N1 },
+    { "vpinsrw",       0x660FC4,   -1, INSN_128 | INSN_NOMASK, 4, { OPERAND_UIMM8, OPERAND_RMLQ, OPERAND_XV, OPERAND_X }, TUPLE_N2 },
+    { "vpinsrd",       0x660F3A22, -1, INSN_128 | INSN_NOMASK, 4, { OPERAND_UIMM8, OPERAND_RM32, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vpinsrq",       0x660F3A22, -1, INSN_128 | INSN_VEX_W | INSN_Q | INSN_NOMASK, 4, { OPERAND_UIMM8, OPERAND_RM, OPERAND_XV, OPERAND_X }, TUPLE_N8 },
+    { "vinsertps",     0x660F3A21, -1, INSN_128 | INSN_NOMASK, 4, { OPERAND_UIMM8, OPERAND_XM, OPERAND_XV, OPERAND_X }, TUPLE_N4 },
+    { "vaesenc",       0x660F38DC, -1, INSN_VL | INSN_NOMASK, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vaesenclast",   0x660F38DD, -1, INSN_VL | INSN_NOMASK, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vaesdec",       0x660F38DE, -1, INSN_VL | INSN_NOMASK, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vaesdeclast",   0x660F38DF, -1, INSN_VL | INSN_NOMASK, 3, { OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM },
+    { "vpclmulqdq",    0x660F3A44, -1, INSN_VL | INSN_NOMASK, 4, { OPERAND_UIMM8, OPERAND_VM, OPERAND_VV, OPERAND_V }, TUPLE_FVM }
+};
+
+/* libzstd is only loaded when zstd compression is asked for */
+static struct {
+    size_t   (*compress_bound)(size_t src_len);
+    size_t   (*compress)(void *dst, size_t dst_len, const void *src,
+                         size_t src_len, int level);
+    unsigned (*is_error)(size_t code);
+} zstd;
+
+/* the GNU assembler's padding, nops[n - 1] is n bytes long */
+static const uint8_t nops[11][11] = {
+    { 0x90 },
+    { 0x66, 0x90 },
+    { 0x0F, 0x1F, 0x00 },
+    { 0x0F, 0x1F, 0x40, 0x00 },
+    { 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+    { 0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00 },
+    { 0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00 },
+    { 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 },
+    { 0x66, 0x66, 0x2E, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00 }
 };
 
 /* function implementations */
-int assemble_file(char *filename, char *outfile)
+void add_cfi_row(fde_t *fde, uint64_t loc, const uint8_t *insn, size_t len,
+                 int initial)
+{
+    fde->insns = realloc(fde->insns, fde->insns_len + len);
+    memcpy(fde->insns + fde->insns_len, insn, len);
+
+    fde->rows = realloc(fde->rows, (fde->row_count + 1) * sizeof(cfi_row_t));
+    fde->rows[fde->row_count++] = (cfi_row_t){
+        .loc = loc, .offset = fde->insns_len, .len = len, .initial = initial
+    };
+    fde->insns_len += len;
+}
+
+/*
+ * Records that the last `size` bytes reserved in the current section hold
+ * the value of the expression at `src`, with `.` being `dot`.
+ */
+int add_fixup(elf64_obj_t *obj, size_t src, uint64_t dot, int size, int flags,
+              int64_t adjust)
+{
+    section_t *sec;
+    frag_t *frag;
+
+    sec = &(obj->sections[obj->section]);
+    frag = &(sec->frags[sec->frag_count - 1]);
+
+    obj->fixups = realloc(obj->fixups,
+                          (obj->fixup_count + 1) * sizeof(fixup_t));
+    obj->fixups[obj->fixup_count++] = (fixup_t){
+        .expr = (deferred_t){ .src = src, .section = obj->section, .dot = dot },
+        .frag = sec->frag_count - 1, .offset = frag->size - size,
+        .place = sec->size - size, .size = size, .flags = flags,
+        .adjust = adjust
+    };
+
+    return 0;
+}
+
+/*
+ * Adds the line number row of the instruction at `pos`: the last .loc, or
+ * with -g its line in the assembly source.
+ */
+void add_line(unit_t *unit, elf64_obj_t *obj, size_t pos)
+{
+    line_t row;
+    char *nl;
+
+    if (obj->loc_pending) {
+        row = obj->loc;
+        obj->loc.flags &= ~(LINE_BASIC_BLOCK | LINE_PROLOGUE_END
+                            | LINE_EPILOGUE_BEGIN);
+        obj->loc_pending = 0;
+    }
+    else if (obj->gen_debug) {
+        while ((nl = memchr(unit->src + unit->line_pos, '\n',
+                            pos - unit->line_pos))) {
+            unit->line++;
+            unit->line_pos = nl - unit->src + 1;
+        }
+        unit->line_pos = pos;
+
+        /* one row per line, not per instruction */
+        if (obj->line_count
+            && obj->lines[obj->line_count - 1].section == obj->section
+            && obj->lines[obj->line_count - 1].line == unit->line) {
+            return;
+        }
+        row = (line_t){ .file = 1, .line = unit->line, .flags = LINE_STMT };
+    }
+    else {
+        return;
+    }
+
+    row.section = obj->section;
+    row.loc = obj->sections[obj->section].size;
+    obj->lines = realloc(obj->lines, (obj->line_count + 1) * sizeof(line_t));
+    obj->lines[obj->line_count++] = row;
+}
+
+/* Relocates `offset` in the current section against a section symbol. */
+void add_reloc(elf64_obj_t *obj, uint64_t offset, uint32_t type,
+               size_t section, int64_t addend)
+{
+    section_t *sec;
+
+    sec = &(obj->sections[obj->section]);
+    sec->relocs = realloc(sec->relocs, (sec->reloc_count + 1) * sizeof(reloc_t));
+    sec->relocs[sec->reloc_count++] = (reloc_t){
+        .offset = offset, .type = type, .section = section, .addend = addend
+    };
+}
+
+size_t add_section(elf64_obj_t *obj, const char *name, uint32_t type,
+                   uint64_t flags)
+{
+    section_t *sec;
+
+    obj->sections = realloc(obj->sections,
+                            (obj->section_count + 1) * sizeof(section_t));
+    sec = &(obj->sections[obj->section_count]);
+    *sec = (section_t){
+        .name = malloc(strlen(name) + 1), .type = type, .flags = flags,
+        .addralign = 1
+    };
+    strcpy(sec->name, name);
+
+    return obj->section_count++;
+}
+
+/*
+ * -falign-loops: pads the targets of backward jumps to the loop alignment
+ * with NOPs, unless that takes more than the budget. Every label, fixup,
+ * CFI and line row from a loop head on moves along with it.
+ */
+int align_loops(elf64_obj_t *obj)
+{
+    expr_t *heads, head;
+    uint64_t *at, *added, align, pad, shift;
+    size_t *seqs, n, j, k, section, first, count;
+    splice_t *splices;
+    section_t *sec;
+
+    align = obj->options->align_loops;
+    heads = obj->loop_heads;
+    if (!align || !obj->loop_head_count) {
+        return 0;
+    }
+
+    /* by section, then by offset */
+    for (size_t i = 1; i < obj->loop_head_count; i++) {
+        head = heads[i];
+        for (j = i; j > 0 && (heads[j - 1].section > head.section
+                              || (heads[j - 1].section == head.section
+                                  && heads[j - 1].value > head.value)); j--) {
+            heads[j] = heads[j - 1];
+        }
+        heads[j] = head;
+    }
+
+    at = malloc(obj->loop_head_count * sizeof(uint64_t));
+    seqs = malloc(obj->loop_head_count * sizeof(size_t));
+    added = malloc(obj->loop_head_count * sizeof(uint64_t));
+    splices = NULL;
+    for (size_t i = 0; i < obj->loop_head_count; i = j) {
+        section = heads[i].section;
+        sec = &(obj->sections[section]);
+        if (align > sec->addralign) {
+            sec->addralign = align;
+        }
+
+        /*
+         * where the padding goes, and how much there is up to there; every
+         * head is kept, as relax_branches may pad one that moves
+         */
+        n = 0;
+        shift = 0;
+        first = obj->align_count;
+        for (j = i; j < obj->loop_head_count && heads[j].section == section;
+             j++) {
+            if (j > i && heads[j - 1].value == heads[j].value) {
+                continue;
+            }
+            pad = -(heads[j].value + shift) & (align - 1);
+            if (pad > obj->options->align_loops_max) {
+                pad = 0;
+            }
+            obj->aligns = realloc(obj->aligns,
+                                  (obj->align_count + 1) * sizeof(align_t));
+            obj->aligns[obj->align_count] = (align_t){
+                .section = section, .start = heads[j].value + shift,
+                .len = pad, .align = align,
+                .max = obj->options->align_loops_max, .fill = -1,
+                .seq = obj->align_count + 1
+            };
+            obj->align_count++;
+            if (pad) {
+                shift += pad;
+                at[n] = heads[j].value;
+                seqs[n] = 0;
+                added[n++] = shift;
+            }
+        }
+        if (!n) {
+            continue;
+        }
+
+        /* the new records are placed already */
+        count = obj->align_count;
+        obj->align_count = first;
+        splices = realloc(splices, n * sizeof(splice_t));
+        for (k = 0; k < n; k++) {
+            pad = added[k] - (k ? added[k - 1] : 0);
+            splices[k] = (splice_t){
+                .start = at[k], .frag = (frag_t){
+                    .type = FRAG_DATA, .data = malloc(pad), .size = pad,
+                    .capacity = pad
+                }
+            };
+            fill_nops(splices[k].frag.data, pad);
+        }
+        splice_section(sec, splices, n);
+        shift_section(obj, section, at, seqs, added, n);
+        obj->align_count = count;
+    }
+
+    free(splices);
+    free(added);
+    free(seqs);
+    free(at);
+    return 0;
+}
+
+int assemble_file(char *filename, char *outfile, options_t *options)
 {
     FILE *fd;
     struct stat filestat;
@@ -96,552 +2719,6168 @@ int assemble_file(char *filename, char *outfile)
         return 1;
     }
 
-    src = malloc(filestat.st_size + 1);
-    src[filestat.st_size] = '\0';
+    src = malloc(filestat.st_size + 1 + SRC_PADDING);
+    memset(src + filestat.st_size, 0, 1 + SRC_PADDING);
     fread(src, sizeof(char), filestat.st_size, fd);
     fclose(fd);
 
-    return_value = assemble_x86_64(src, outfile);
+    return_value = assemble_x86_64(src, filename, outfile, options);
 
     free(src);
     return return_value;
 }
 
-int assemble_x86_64(char *src, char *outfile)
+int assemble_x86_64(char *src, char *filename, char *outfile,
+                    options_t *options)
 {
     elf64_obj_t obj;
     Elf64_Ehdr ehdr;
     unit_t unit;
+    int return_value;
 
-    obj = (elf64_obj_t){
-        .strtab = malloc(sizeof(char *)), .shstrtab = malloc(sizeof(char *))
-    };
-    obj.strtab[0] = NULL;
-    obj.shstrtab[0] = NULL;
-    unit = (unit_t){ .src = src, .i = 0 };
+    obj = (elf64_obj_t){ .options = options, .loc.flags = LINE_STMT };
+    unit = (unit_t){ .src = src, .i = 0, .name = filename, .line = 1 };
 
-    default_symtabs_x86_64(&obj);
+    default_sections_x86_64(&obj);
 
-    if (parse_x86_64(&unit, &obj)) {
-        return 1;
+    /* -g: the source is file 1, and file 0 as the primary source file */
+    if (options->debug) {
+        obj.gen_debug = 1;
+        obj.file_count = 2;
+        obj.files = calloc(2, sizeof(file_t));
+        obj.files[1].name = strdup(filename);
     }
 
-    ehdr = (Elf64_Ehdr){
-        .e_ident[EI_MAG0] = ELFMAG0, .e_ident[EI_MAG1] = ELFMAG1,
-        .e_ident[EI_MAG2] = ELFMAG2, .e_ident[EI_MAG3] = ELFMAG3,
-        .e_ident[EI_CLASS] = ELFCLASS64, .e_ident[EI_DATA] = ELFDATA2LSB,
-        .e_ident[EI_VERSION] = EV_CURRENT, .e_ident[EI_OSABI] = ELFOSABI_SYSV,
-        .e_ident[EI_ABIVERSION] = 0,
-        .e_type = ET_REL, /* Object File | TODO: add executables support later */
-        .e_machine = EM_X86_64, .e_version = EV_CURRENT, .e_entry = 0,
-        .e_phoff = 0,
-        .e_shoff = 240 + ALIGNTO8(obj.assembly_size),
-        .e_flags = 0, .e_ehsize = sizeof(Elf64_Ehdr), .e_phentsize = 0,
-        .e_phnum = 0, .e_shentsize = 64, .e_shnum = 7, .e_shstrndx = 6
-    };
+    return_value = parse_x86_64(&unit, &obj)
+                || align_loops(&obj)
+                || relax_branches(&unit, &obj)
+                || order_functions(&obj)
+                || size_leb128(&unit, &obj)
+                || evaluate_deferred(&unit, &obj)
+                || emit_eh_frame(&obj)
+                || emit_debug_line(&unit, &obj)
+                || resolve_fixups(&unit, &obj);
+    if (!return_value) {
+        ehdr = (Elf64_Ehdr){
+            .e_ident[EI_MAG0] = ELFMAG0, .e_ident[EI_MAG1] = ELFMAG1,
+            .e_ident[EI_MAG2] = ELFMAG2, .e_ident[EI_MAG3] = ELFMAG3,
+            .e_ident[EI_CLASS] = ELFCLASS64, .e_ident[EI_DATA] = ELFDATA2LSB,
+            .e_ident[EI_VERSION] = EV_CURRENT, .e_ident[EI_OSABI] = ELFOSABI_SYSV,
+            .e_ident[EI_ABIVERSION] = 0,
+            .e_type = ET_REL, /* Object File | TODO: add executables support later */
+            .e_machine = EM_X86_64, .e_version = EV_CURRENT, .e_entry = 0,
+            .e_phoff = 0, .e_shoff = 0, /* set by write_file_x86_64 */
+            .e_flags = 0, .e_ehsize = sizeof(Elf64_Ehdr), .e_phentsize = 0,
+            .e_phnum = 0, .e_shentsize = sizeof(Elf64_Shdr)
+        };
+
+        /* indirect functions are a GNU extension */
+        for (int i = 0; i < obj.sym_count; i++) {
+            if (ELF64_ST_TYPE(obj.syms[i].sym.st_info) == STT_GNU_IFUNC) {
+                ehdr.e_ident[EI_OSABI] = ELFOSABI_GNU;
+            }
+        }
+
+        obj.ehdr = &ehdr;
+        return_value = write_file_x86_64(outfile, &obj);
+    }
+
+    for (int i = 0; i < obj.section_count; i++) {
+        for (int j = 0; j < obj.sections[i].frag_count; j++) {
+            frag_t *frag = &(obj.sections[i].frags[j]);
 
-    obj.ehdr = &ehdr;
+            if (frag->type == FRAG_FILE) {
+                size_t delta = frag->offset % sysconf(_SC_PAGESIZE);
 
-    default_shdrtabs_x86_64(&obj);
-    write_file_x86_64(outfile, &obj);
+                munmap(frag->data - delta, frag->size + delta);
+                close(frag->fd);
+            }
+            else {
+                free(frag->data);
+            }
+        }
+        free(obj.sections[i].frags);
+        free(obj.sections[i].relocs);
+        free(obj.sections[i].name);
+    }
+    free(obj.sections);
+    free(obj.section_stack);
 
+    for (int i = 0; i < obj.sym_count; i++) {
+        free(obj.syms[i].name);
+    }
     free(obj.syms);
-    free(obj.shdrs);
+    free(obj.deferred);
+    free(obj.fixups);
+    free(obj.loop_heads);
+    free(obj.branches);
+    free(obj.aligns);
+    free(obj.labels);
 
-    for (int i = 0; i < obj.strtab_count; i++) {
-        free(obj.strtab[i]);
+    for (int i = 0; i < obj.fde_count; i++) {
+        free(obj.fdes[i].insns);
+        free(obj.fdes[i].rows);
+        free(obj.fdes[i].remembered);
     }
-    free(obj.strtab);
+    free(obj.fdes);
 
-    for (int i = 0; i < obj.shstrtab_count; i++) {
-        free(obj.shstrtab[i]);
+    for (int i = 0; i < obj.file_count; i++) {
+        free(obj.files[i].name);
     }
-    free(obj.shstrtab);
+    free(obj.files);
+    for (int i = 0; i < obj.dir_count; i++) {
+        free(obj.dirs[i]);
+    }
+    free(obj.dirs);
+    free(obj.lines);
 
-    return 0;
+    return return_value;
 }
 
-int default_shdrtabs_x86_64(elf64_obj_t *obj)
+/*
+ * qsort order of the .align paddings: by section, then by location, the
+ * empty ones first and as written
+ */
+int compare_aligns(const void *a, const void *b)
 {
-    Elf64_Shdr shdr_null, shdr_text, shdr_data, shdr_bss,
-               shdr_symtab, shdr_strtab, shdr_shstrtab;
-    size_t sh_offset, strtab_len, shstrtab_len;
-    sh_offset = sizeof(Elf64_Ehdr);
-
-    shdr_null = (Elf64_Shdr){};
-
-    shdr_text = (Elf64_Shdr){
-        .sh_name = 0x1b, .sh_type = SHT_PROGBITS,
-        .sh_flags = SHF_ALLOC | SHF_EXECINSTR, .sh_addr = 0,
-        .sh_offset = sh_offset, .sh_size = obj->assembly_size, .sh_link = 0,
-        .sh_info = 0, .sh_addralign = 1, .sh_entsize = 0
-    };
-    sh_offset += shdr_text.sh_size;
-
-    shdr_data = (Elf64_Shdr){
-        .sh_name = 0x21, .sh_type = SHT_PROGBITS,
-        .sh_flags = SHF_ALLOC | SHF_WRITE, .sh_addr = 0,
-        .sh_offset = sh_offset, .sh_size = 0x0, .sh_link = 0, .sh_info = 0,
-        .sh_addralign = 1, .sh_entsize = 0
-    };
-    sh_offset += shdr_data.sh_size;
+    const align_t *x, *y;
 
-    shdr_bss = (Elf64_Shdr){
-        .sh_name = 0x27, .sh_type = SHT_NOBITS,
-        .sh_flags = SHF_ALLOC | SHF_WRITE, .sh_addr = 0,
-        .sh_offset = sh_offset, .sh_size = 0x0, .sh_link = 0, .sh_info = 0,
-        .sh_addralign = 1, .sh_entsize = 0
-    };
-    sh_offset += shdr_bss.sh_size;
-
-    /* align the offset to be dividable by 8 bytes */
-    if (sh_offset % 8) {
-        sh_offset += 8 - (sh_offset % 8);
+    x = a;
+    y = b;
+    if (x->section != y->section) {
+        return (x->section > y->section) - (x->section < y->section);
     }
-    shdr_symtab = (Elf64_Shdr){
-        .sh_name = 0x01, .sh_type = SHT_SYMTAB, .sh_flags = 0, .sh_addr = 0,
-        .sh_offset = sh_offset, .sh_size = sizeof(Elf64_Sym) * 5, .sh_link = 5,
-        .sh_info = obj->section_count + obj->label_count, /* The number of LOCAL symtabs */
-        .sh_addralign = 8, .sh_entsize = 0x18
-    };
-    sh_offset += shdr_symtab.sh_size;
-
-    strtab_len = 1;
-    for (int i = 0; i < obj->strtab_count; i++) {
-        strtab_len += strlen(obj->strtab[i]) + 1;
+    if (x->start != y->start) {
+        return (x->start > y->start) - (x->start < y->start);
     }
+    if (x->len != y->len) {
+        return (x->len > y->len) - (x->len < y->len);
+    }
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
 
-    shdr_strtab = (Elf64_Shdr){
-        .sh_name = 0x09, .sh_type = SHT_STRTAB, .sh_flags = 0, .sh_addr = 0,
-        .sh_offset = sh_offset, .sh_size = strtab_len, .sh_link = 0,
-        .sh_info = 0, .sh_addralign = 1, .sh_entsize = 0
-    };
-    sh_offset += shdr_strtab.sh_size;
-
-    /* temp */
-    /* default shstrtab */
-    obj->shstrtab_count = 6;
-    obj->shstrtab = malloc(obj->shstrtab_count * sizeof(char *));
-    
-    obj->shstrtab[0] = malloc(strlen(".symtab") + 1);
-    strcpy(obj->shstrtab[0], ".symtab");
-    
-    obj->shstrtab[1] = malloc(strlen(".strtab") + 1);
-    strcpy(obj->shstrtab[1], ".strtab");
-
-    obj->shstrtab[2] = malloc(strlen(".shstrtab") + 1);
-    strcpy(obj->shstrtab[2], ".shstrtab");
-
-    obj->shstrtab[3] = malloc(strlen(".text") + 1);
-    strcpy(obj->shstrtab[3], ".text");
-
-    obj->shstrtab[4] = malloc(strlen(".data") + 1);
-    strcpy(obj->shstrtab[4], ".data");
-    
-    obj->shstrtab[5] = malloc(strlen(".bss") + 1);
-    strcpy(obj->shstrtab[5], ".bss");
-
-    shstrtab_len = 1;
-    for (int i = 0; i < obj->shstrtab_count; i++) {
-        shstrtab_len += strlen(obj->shstrtab[i]) + 1;
-    }
-
-    shdr_shstrtab = (Elf64_Shdr){
-        .sh_name = 0x11, .sh_type = SHT_STRTAB, .sh_flags = 0,
-        .sh_addr = 0, .sh_offset = sh_offset,
-        .sh_size = shstrtab_len, .sh_link = 0, .sh_info = 0,
-        .sh_addralign = 1, .sh_entsize = 0
-    };
-    sh_offset += shdr_shstrtab.sh_size;
-
-    obj->shdrs = malloc(7 * sizeof(Elf64_Shdr));
-    memcpy(&(obj->shdrs[0]), &shdr_null, sizeof(Elf64_Shdr));
-    memcpy(&(obj->shdrs[1]), &shdr_text, sizeof(Elf64_Shdr));
-    memcpy(&(obj->shdrs[2]), &shdr_data, sizeof(Elf64_Shdr));
-    memcpy(&(obj->shdrs[3]), &shdr_bss, sizeof(Elf64_Shdr));
-    memcpy(&(obj->shdrs[4]), &shdr_symtab, sizeof(Elf64_Shdr));
-    memcpy(&(obj->shdrs[5]), &shdr_strtab, sizeof(Elf64_Shdr));
-    memcpy(&(obj->shdrs[6]), &shdr_shstrtab, sizeof(Elf64_Shdr));
+/* qsort order of insn_index: by mnemonic, then as listed in insns */
+int compare_insns(const void *a, const void *b)
+{
+    const insn_t *x, *y;
+    int order;
 
-    obj->shdr_count += 7;
-    return 0;
+    x = *(const insn_t **)a;
+    y = *(const insn_t **)b;
+    order = strcmp(x->mnemonic, y->mnemonic);
+    if (order) {
+        return order;
+    }
+    return (x > y) - (x < y);
 }
 
-int default_symtabs_x86_64(elf64_obj_t *obj)
+/*
+ * Worker thread: flattens a debug section and compresses it behind an
+ * Elf64_Chdr. Sections that don't get smaller are left as they are.
+ */
+void *compress_section(void *arg)
 {
-    Elf64_Sym sym_null, sym_text, sym_data, sym_bss;
+    compress_job_t *job;
+    section_t *sec;
+    uint8_t *raw, *p;
+    size_t bound, len;
+    uLongf zlib_len;
+    int ok;
 
-    sym_null = (Elf64_Sym){};
+    job = arg;
+    sec = job->sec;
 
-    sym_text = (Elf64_Sym){
-        .st_name = 0, .st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION),
-        .st_other = STV_DEFAULT, .st_shndx = 1, .st_value = 0, .st_size = 0
-    };
+    raw = malloc(sec->size);
+    p = raw;
+    for (size_t i = 0; i < sec->frag_count; i++) {
+        frag_t *frag = &(sec->frags[i]);
 
-    sym_data = (Elf64_Sym){
-        .st_name = 0, .st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION),
-        .st_other = STV_DEFAULT, .st_shndx = 2, .st_value = 0, .st_size = 0
-    };
+        if (frag->type == FRAG_FILL) {
+            for (size_t j = 0; j < frag->size; j++) {
+                p[j] = frag->pattern[j % frag->pattern_len];
+            }
+        }
+        else {
+            memcpy(p, frag->data, frag->size);
+        }
+        p += frag->size;
+    }
 
-    sym_bss = (Elf64_Sym){
-        .st_name = 0, .st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION),
-        .st_other = STV_DEFAULT, .st_shndx = 3, .st_value = 0, .st_size = 0
-    };
+    bound = job->type == ELFCOMPRESS_ZLIB ? compressBound(sec->size)
+                                          : zstd.compress_bound(sec->size);
+    job->data = malloc(sizeof(Elf64_Chdr) + bound);
+    if (job->type == ELFCOMPRESS_ZLIB) {
+        zlib_len = bound;
+        ok = compress2(job->data + sizeof(Elf64_Chdr), &zlib_len, raw,
+                       sec->size, Z_DEFAULT_COMPRESSION) == Z_OK;
+        len = zlib_len;
+    }
+    else {
+        len = zstd.compress(job->data + sizeof(Elf64_Chdr), bound, raw,
+                            sec->size, 3 /* ZSTD_CLEVEL_DEFAULT */);
+        ok = !zstd.is_error(len);
+    }
+    free(raw);
 
-    obj->syms = malloc(4 * sizeof(Elf64_Sym));
-    memcpy(&(obj->syms[0]), &sym_null, sizeof(Elf64_Sym));
-    memcpy(&(obj->syms[1]), &sym_text, sizeof(Elf64_Sym));
-    memcpy(&(obj->syms[2]), &sym_data, sizeof(Elf64_Sym));
-    memcpy(&(obj->syms[3]), &sym_bss, sizeof(Elf64_Sym));
+    if (!ok || sizeof(Elf64_Chdr) + len >= sec->size) {
+        free(job->data);
+        job->data = NULL;
+        job->size = 0;
+        return NULL;
+    }
 
-    obj->section_count += 4;
-    return 0;
+    *(Elf64_Chdr *)job->data = (Elf64_Chdr){
+        .ch_type = job->type, .ch_size = sec->size,
+        .ch_addralign = sec->addralign
+    };
+    job->size = sizeof(Elf64_Chdr) + len;
+    return NULL;
 }
 
-int lex(unit_t *unit, token_t *token)
+size_t decode_string(const char *s, size_t len, uint8_t *out)
 {
-    char c;
-    int return_value;
-
-    /* Skip Whitespace */
-    while (isblank(unit->src[unit->i])) {
-        unit->i++;
-    }
+    const char *end;
+    uint8_t *o;
+    size_t run;
+    int value, digits;
 
-    skip_comments(unit);
+    end = s + len;
+    o = out;
 
-    c = unit->src[unit->i];
-    return_value = 0;
+    while (s < end) {
+        /* copy everything up to the next backslash in one go */
+        run = scan_string(s);
+        if (run > end - s) {
+            run = end - s;
+        }
+        memcpy(o, s, run);
+        o += run;
+        s += run;
 
-    switch (c)
-    {
-        case '$':
-            unit->i++;
-            return_value = lex_constant(unit, token);
-            break;
-        case '%':
-            unit->i++;
-            return_value = lex_id(unit, token);
-            token->type = REGISTER;
-            break;
-        case '\n':
-            token->type = NEWLINE;
-            token->start = unit->i;
-            unit->i++;
-            token->len = 1;
-            break;
-        case '\0':
-            token->type = ENDOFFILE;
-            token->start = unit->i;
-            token->len = 1;
+        if (s >= end) {
             break;
-        default:
-            if (c == '.' || c == '_' || isalpha(c)) {
-                return_value = lex_id(unit, token);
-                if (unit->src[unit->i] == ':') {
-                    token->type = LABEL;
-                    unit->i++;
+        }
+
+        s++; /* the backslash */
+        switch (*s)
+        {
+            case 'b': *o++ = '\b'; s++; break;
+            case 'f': *o++ = '\f'; s++; break;
+            case 'n': *o++ = '\n'; s++; break;
+            case 'r': *o++ = '\r'; s++; break;
+            case 't': *o++ = '\t'; s++; break;
+            case 'v': *o++ = '\v'; s++; break;
+            case 'x':
+            case 'X':
+                s++;
+                value = 0;
+                while (s < end && isxdigit(*s)) {
+                    value = (value << 4)
+                          | (isdigit(*s) ? *s - '0' : (tolower(*s) - 'a' + 10));
+                    s++;
                 }
-                else if (c == '.') {
-                    token->type = DIRECTIVE;
+                *o++ = value;
+                break;
+            default:
+                if (*s >= '0' && *s <= '7') {
+                    value = 0;
+                    for (digits = 0; digits < 3 && s < end
+                                     && *s >= '0' && *s <= '7'; digits++) {
+                        value = (value << 3) | (*s - '0');
+                        s++;
+                    }
+                    *o++ = value;
+                }
+                else {
+                    /* `\\`, `\"` and anything unknown stand for themselves */
+                    *o++ = *s++;
                 }
                 break;
-            }
-
-            fprintf(stderr, "Invalid character `%c` in mnemonic.\n", c);
-            return 1;
+        }
     }
 
-    return return_value;
+    return o - out;
 }
 
-int lex_constant(unit_t *unit, token_t *token)
+int default_sections_x86_64(elf64_obj_t *obj)
 {
-    fprintf(stderr, "lex_constant is not yet implemented!\n");
-    return 1;
+    add_section(obj, "", SHT_NULL, 0);
+    add_section(obj, ".text", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR);
+    add_section(obj, ".data", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE);
+    add_section(obj, ".bss", SHT_NOBITS, SHF_ALLOC | SHF_WRITE);
+    obj->sections[0].addralign = 0;
+
+    obj->section = 1;
+    return 0;
 }
 
-int lex_id(unit_t *unit, token_t *token)
+/*
+ * EVEX's compressed disp8 counts in units of N bytes, the size of the memory
+ * operand, or of one element when it is broadcast.
+ */
+int disp8_scale(const insn_t *insn, const arg_t *rm)
 {
-    token->type = ID;
-    token->start = unit->i++;
+    int length;
 
-    while (isalnum(unit->src[unit->i])) {
-        unit->i++;
+    length = insn->flags & INSN_EVEX_LL ? 64 : insn->flags & INSN_VEX_L ? 32
+           : 16;
+    switch (insn->tuple)
+    {
+        case TUPLE_FV:
+            return rm->broadcast ? (insn->flags & INSN_VEX_W ? 8 : 4) : length;
+        case TUPLE_HV:
+            return rm->broadcast ? 4 : length / 2;
+        case TUPLE_FVM:
+            return length;
+        case TUPLE_HVM:
+            return length / 2;
+        case TUPLE_QVM:
+            return length / 4;
+        case TUPLE_OVM:
+            return length / 8;
+        case TUPLE_DUP:
+            /* vmovddup reads one double for a 128-bit vector */
+            return length == 16 ? 8 : length;
+        default:
+            return 1 << (insn->tuple - TUPLE_N1);
     }
-
-    token->len = unit->i - token->start;
-    return 0;
 }
 
-int parse_x86_64(unit_t *unit, elf64_obj_t *obj)
+int evaluate_deferred(unit_t *unit, elf64_obj_t *obj)
 {
     token_t token;
-    char *buff;
+    expr_t value;
 
-    while (!lex(unit, &token)) {
-        buff = malloc(token.len + 1);
-        memcpy(buff, unit->src + token.start, token.len);
-        buff[token.len] = '\0';
+    for (size_t i = 0; i < obj->deferred_count; i++) {
+        symbol_t *sym;
 
-        printf("token: type=%s, text=`", token_types[token.type]);
-        switch (token.type)
+        obj->evaluating = &(obj->deferred[i]);
+        unit->i = obj->evaluating->src;
+
+        if (lex(unit, &token) || parse_expression(unit, obj, &token, &value)) {
+            obj->evaluating = NULL;
+            return 1;
+        }
+
+        /* after the expression, which may have grown the symbols */
+        sym = &(obj->syms[obj->evaluating->sym]);
+        if (value.section || value.sym || value.minus) {
+            fprintf(stderr, "Error: .size expression for `%s` does not evaluate to a constant.\n",
+                    sym->name);
+            obj->evaluating = NULL;
+            return 1;
+        }
+        sym->sym.st_size = value.value;
+    }
+
+    obj->evaluating = NULL;
+    return 0;
+}
+
+/*
+ * An avx512_insns row made for one vector length of 16, 32 or 64 bytes, its
+ * V, H, Q and O operands the vectors of that length or a part of it.
+ */
+insn_t evex_form(const insn_t *insn, int length)
+{
+    static const int regs[3] = { OPERAND_X, OPERAND_Y, OPERAND_Z };
+    static const int rms[3] = { OPERAND_XM, OPERAND_YM, OPERAND_ZM };
+    static const int rm_regs[3] = { OPERAND_XR, OPERAND_YR, OPERAND_ZR };
+    static const int vvvvs[3] = { OPERAND_XV, OPERAND_YV, OPERAND_ZV };
+    static const int vsibs[3] = { OPERAND_XS, OPERAND_YS, OPERAND_ZS };
+    insn_t form;
+    int part, size;
+
+    form = *insn;
+    form.flags = (insn->flags & ~INSN_VL) | INSN_EVEX
+               | (length == 32 ? INSN_VEX_L : length == 64 ? INSN_EVEX_LL : 0);
+    for (int i = 0; i < insn->operand_count; i++) {
+        switch (insn->operands[i])
         {
-            case NEWLINE:
-                printf("\\n");
+            case OPERAND_H: case OPERAND_HM: case OPERAND_HS:
+                part = 2;
                 break;
-            case ENDOFFILE:
-                printf("\\0");
+            case OPERAND_QM:
+                part = 4;
+                break;
+            case OPERAND_OM:
+                part = 8;
                 break;
             default:
-                printf("%s", buff);
+                part = 1;
                 break;
         }
-        printf("`\n");
+        size = length / part >= 64 ? 2 : length / part >= 32 ? 1 : 0;
 
-        switch (token.type)
+        switch (insn->operands[i])
         {
-            case ID:
-            {
-                for (char *p = buff; *p; ++p) {
-                    *p = tolower(*p);
-                }
+            case OPERAND_V: case OPERAND_H:
+                form.operands[i] = regs[size];
+                break;
+            case OPERAND_VM: case OPERAND_HM: case OPERAND_QM:
+            case OPERAND_OM:
+                form.operands[i] = rms[size];
+                break;
+            case OPERAND_VR:
+                form.operands[i] = rm_regs[size];
+                break;
+            case OPERAND_VV:
+                form.operands[i] = vvvvs[size];
+                break;
+            case OPERAND_VS: case OPERAND_HS:
+                form.operands[i] = vsibs[size];
+                break;
+        }
+    }
 
-                if (!strcmp(buff, "clc")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xF8;
-                    obj->assembly_size++;
+    return form;
+}
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "stc")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xF9;
-                    obj->assembly_size++;
+/* Whether the value is a plain number, known now. */
+int expr_constant(const expr_t *value)
+{
+    return !value->pending && !value->section && !value->sym && !value->minus;
+}
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "cli")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xFA;
-                    obj->assembly_size++;
+/* The section an expression points into and its offset there, if known. */
+size_t expr_location(elf64_obj_t *obj, expr_t *expr, int64_t *offset)
+{
+    symbol_t *sym;
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "sti")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xFB;
-                    obj->assembly_size++;
+    if (expr->minus || expr->pending) {
+        return 0;
+    }
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "cld")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xFC;
-                    obj->assembly_size++;
+    if (expr->sym) {
+        sym = &(obj->syms[expr->sym - 1]);
+        if (!sym->defined || sym->sym.st_shndx == SHN_COMMON) {
+            return 0;
+        }
+        *offset = sym->sym.st_value + expr->value;
+        return sym->sym.st_shndx;
+    }
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "std")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xFD;
-                    obj->assembly_size++;
+    *offset = expr->value;
+    return expr->section;
+}
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "leave") || !strcmp(buff, "leaveq")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xC9;
-                    obj->assembly_size++;
+/*
+ * The size of a DW_EH_PE_* encoded pointer, or 0 if it is not supported.
+ * `flags` tells how its fixup is resolved.
+ */
+int eh_pointer_size(uint8_t encoding, int *flags)
+{
+    *flags = 0;
+    switch (encoding & 0x70)
+    {
+        case 0x00: break;                     /* DW_EH_PE_absptr */
+        case 0x10: *flags = FIXUP_PCREL; break; /* DW_EH_PE_pcrel */
+        default:   return 0;
+    }
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "nop")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0x90;
-                    obj->assembly_size++;
+    /* DW_EH_PE_indirect only changes what the value points to */
+    switch (encoding & 0x0F)
+    {
+        case 0x00: return 8;                   /* DW_EH_PE_absptr */
+        case 0x03: return 4;                   /* DW_EH_PE_udata4 */
+        case 0x04: return 8;                   /* DW_EH_PE_udata8 */
+        case 0x0B: *flags |= FIXUP_SIGNED; return 4; /* DW_EH_PE_sdata4 */
+        case 0x0C: *flags |= FIXUP_SIGNED; return 8; /* DW_EH_PE_sdata8 */
+    }
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "ret") || !strcmp(buff, "retq")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 1);
-                    obj->assembly[obj->assembly_size] = 0xC3;
-                    obj->assembly_size++;
+    return 0;
+}
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else if (!strcmp(buff, "syscall")) {
-                    obj->assembly = realloc(obj->assembly,
-                                            obj->assembly_size + 2);
-                    obj->assembly[obj->assembly_size] = 0x0F;
-                    obj->assembly_size++;
-                    obj->assembly[obj->assembly_size] = 0x05;
-                    obj->assembly_size++;
+/*
+ * Pads the current section to a multiple of `align` bytes, with `fill` or,
+ * when it is negative, nops in code and zeroes elsewhere. Nothing is done
+ * if more than `max` bytes would be needed.
+ */
+int emit_align(elf64_obj_t *obj, uint64_t align, int64_t fill, int64_t max)
+{
+    section_t *sec;
+    size_t len;
+    uint8_t byte;
 
-                    if (lex(unit, &token)) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        goto FREE_BUFF_ERROR;
-                    }
-                }
-                else {
-                    fprintf(stderr, "Error: unknown instruction: `%s`\n", buff);
-                    goto FREE_BUFF_ERROR;
-                }
-                free(buff);
-                break;
+    sec = &(obj->sections[obj->section]);
+
+    if (align & (align - 1)) {
+        fprintf(stderr, "Error: alignment %lu is not a power of 2.\n", align);
+        return 1;
+    }
+    if (align <= 1) {
+        return 0;
+    }
+
+    len = -sec->size & (align - 1);
+
+    /*
+     * The labels right before it are at its start too, but stay in front
+     * of the padding relax_branches may add.
+     */
+    if ((!len || (max > 0 && len > max))
+        && obj->label_section == obj->section && obj->label_end == sec->size) {
+        for (size_t i = 0; i < obj->label_count; i++) {
+            if (!obj->syms[obj->labels[i]].pad_seq) {
+                obj->syms[obj->labels[i]].pad_seq = obj->align_count + 1;
             }
-            case LABEL:
-            {
-                size_t syms_index = obj->section_count + obj->label_count
-                                  + obj->glabel_count;
-                size_t available = 0;
-                for (int i = 0; i < obj->label_count + obj->glabel_count; i++) {
-                    if (!strcmp(buff, obj->strtab[i]))
-                        available = i + 1;
-                }
+        }
+    }
 
-                if (available) {
-                    obj->syms[obj->section_count + available - 1].st_shndx = available;
-                    free(buff);
-                }
-                else {
-                    obj->syms = realloc(obj->syms,
-                                        (syms_index + 1) * sizeof(Elf64_Sym));
-                    obj->syms[syms_index] = (Elf64_Sym){
-                        .st_name = 0x01,
-                        .st_info = ELF64_ST_INFO(STB_LOCAL, STT_NOTYPE),
-                        .st_other = STV_DEFAULT, .st_shndx = obj->label_count + 1,
-                        .st_value = 0, .st_size = 0
-                    };
+    /* relax_branches sizes it again when the code before it moves */
+    obj->aligns = realloc(obj->aligns,
+                          (obj->align_count + 1) * sizeof(align_t));
+    obj->aligns[obj->align_count] = (align_t){
+        .section = obj->section, .start = sec->size,
+        .len = max > 0 && len > max ? 0 : len, .align = align, .max = max,
+        .fill = fill, .seq = obj->align_count + 1
+    };
+    obj->align_count++;
+
+    if (max > 0 && len > max) {
+        return 0;
+    }
+    obj->pad_addralign = sec->addralign;
+    if (align > sec->addralign) {
+        sec->addralign = align;
+    }
+    obj->pad_section = obj->section;
+    obj->pad_end = sec->size + len;
+    obj->pad_len = len;
+    obj->pad_align = align;
+    if (!len) {
+        return 0;
+    }
+
+    if (fill < 0 && (sec->flags & SHF_EXECINSTR)) {
+        fill_nops(reserve_bytes(obj, len), len);
+        return 0;
+    }
+
+    byte = fill < 0 ? 0 : fill;
+    return emit_fill(obj, &byte, 1, len);
+}
+
+void emit_bytes(elf64_obj_t *obj, const uint8_t *bytes, size_t len)
+{
+    memcpy(reserve_bytes(obj, len), bytes, len);
+}
+
+/*
+ * Without a compiler supplied .debug_info, a compile unit covering every
+ * section with line information is added to reference the line number
+ * program at `line_offset` in .debug_line, or tools like addr2line can't
+ * find it.
+ */
+void emit_debug_info(unit_t *unit, elf64_obj_t *obj, uint64_t line_offset)
+{
+    uint8_t *p;
+    size_t section, abbrev, info, ranges, range_count, first, len;
+    uint64_t abbrev_offset, ranges_offset, start;
+    char *cwd;
+
+    section = obj->section;
+    cwd = getcwd(NULL, 0);
+    p = malloc(64 + obj->section_count * 16 + strlen(unit->name)
+               + (cwd ? strlen(cwd) : 1));
+
+    ranges = range_count = first = 0;
+    for (size_t i = 1; i < obj->section_count; i++) {
+        for (size_t j = 0; j < obj->line_count; j++) {
+            if (obj->lines[j].section == i) {
+                first = first ? first : i;
+                range_count++;
+                break;
+            }
+        }
+    }
 
-                    obj->strtab = realloc(obj->strtab,
-                                         (obj->strtab_count + 1) * sizeof(char *));
-                    obj->strtab[obj->strtab_count] = buff;
+    /* more than one section needs a range list */
+    ranges_offset = 0;
+    if (range_count > 1) {
+        ranges = find_section(obj, ".debug_rnglists");
+        if (!ranges) {
+            ranges = add_section(obj, ".debug_rnglists", SHT_PROGBITS, 0);
+        }
+        obj->section = ranges;
+        ranges_offset = obj->sections[ranges].size;
 
-                    obj->strtab_count++;
-                    obj->label_count++;
+        len = 4;
+        *(uint16_t *)(p + len) = 5;  /* version */
+        len += 2;
+        p[len++] = 8;                /* address_size */
+        p[len++] = 0;                /* segment_selector_size */
+        *(uint32_t *)(p + len) = 0;  /* offset_entry_count */
+        len += 4;
+        for (size_t i = 1; i < obj->section_count; i++) {
+            for (size_t j = 0; j < obj->line_count; j++) {
+                if (obj->lines[j].section != i) {
+                    continue;
                 }
+                p[len++] = 0x07;     /* DW_RLE_start_length */
+                add_reloc(obj, ranges_offset + len, R_X86_64_64, i, 0);
+                memset(p + len, 0, 8);
+                len += 8;
+                len += encode_uleb128(p + len, obj->sections[i].size);
                 break;
             }
-            case DIRECTIVE:
-            {
-                size_t syms_index = obj->section_count + obj->label_count
-                                  + obj->glabel_count;
-                if (!strcmp(buff, ".globl")) {
-                    free(buff);
-                    if (lex(unit, &token)) {
-                        return 1;
-                    }
-                    if (token.type != ID) {
-                        fprintf(stderr, "Error: .globl directive expected a symbol.\n");
-                        return 1;
-                    }
+        }
+        p[len++] = 0x00;             /* DW_RLE_end_of_list */
+        *(uint32_t *)p = len - 4;
+        emit_bytes(obj, p, len);
+    }
+
+    abbrev = find_section(obj, ".debug_abbrev");
+    if (!abbrev) {
+        abbrev = add_section(obj, ".debug_abbrev", SHT_PROGBITS, 0);
+    }
+    obj->section = abbrev;
+    abbrev_offset = obj->sections[abbrev].size;
+    len = 0;
+    p[len++] = 1;        /* abbreviation code */
+    p[len++] = 0x11;     /* DW_TAG_compile_unit */
+    p[len++] = 0;        /* DW_CHILDREN_no */
+    p[len++] = 0x10;     /* DW_AT_stmt_list */
+    p[len++] = 0x17;     /* DW_FORM_sec_offset */
+    if (range_count > 1) {
+        p[len++] = 0x55; /* DW_AT_ranges */
+        p[len++] = 0x17; /* DW_FORM_sec_offset */
+    }
+    else {
+        p[len++] = 0x11; /* DW_AT_low_pc */
+        p[len++] = 0x01; /* DW_FORM_addr */
+        p[len++] = 0x12; /* DW_AT_high_pc */
+        p[len++] = 0x07; /* DW_FORM_data8 */
+    }
+    p[len++] = 0x03;     /* DW_AT_name */
+    p[len++] = 0x08;     /* DW_FORM_string */
+    p[len++] = 0x1B;     /* DW_AT_comp_dir */
+    p[len++] = 0x08;     /* DW_FORM_string */
+    p[len++] = 0x25;     /* DW_AT_producer */
+    p[len++] = 0x08;     /* DW_FORM_string */
+    p[len++] = 0x13;     /* DW_AT_language */
+    p[len++] = 0x05;     /* DW_FORM_data2 */
+    p[len++] = 0;
+    p[len++] = 0;
+    p[len++] = 0;        /* the end of the abbreviations */
+    emit_bytes(obj, p, len);
+
+    info = find_section(obj, ".debug_info");
+    if (!info) {
+        info = add_section(obj, ".debug_info", SHT_PROGBITS, 0);
+    }
+    obj->section = info;
+    start = obj->sections[info].size;
+
+    len = 4;
+    *(uint16_t *)(p + len) = 5;      /* version */
+    len += 2;
+    p[len++] = 0x01;                 /* DW_UT_compile */
+    p[len++] = 8;                    /* address_size */
+    add_reloc(obj, start + len, R_X86_64_32, abbrev, abbrev_offset);
+    *(uint32_t *)(p + len) = 0;      /* debug_abbrev_offset */
+    len += 4;
+    p[len++] = 1;
+    add_reloc(obj, start + len, R_X86_64_32, find_section(obj, ".debug_line"),
+              line_offset);
+    *(uint32_t *)(p + len) = 0;
+    len += 4;
+    if (range_count > 1) {
+        /* the list itself, after the header */
+        add_reloc(obj, start + len, R_X86_64_32, ranges, ranges_offset + 12);
+        *(uint32_t *)(p + len) = 0;
+        len += 4;
+    }
+    else {
+        add_reloc(obj, start + len, R_X86_64_64, first, 0);
+        *(uint64_t *)(p + len) = 0;
+        *(uint64_t *)(p + len + 8) = obj->sections[first].size;
+        len += 16;
+    }
+    strcpy((char *)p + len, unit->name);
+    len += strlen(unit->name) + 1;
+    strcpy((char *)p + len, cwd ? cwd : ".");
+    len += strlen(cwd ? cwd : ".") + 1;
+    strcpy((char *)p + len, "pasm");
+    len += sizeof("pasm");
+    *(uint16_t *)(p + len) = 0x8001; /* DW_LANG_Mips_Assembler */
+    len += 2;
+    *(uint32_t *)p = len - 4;
+    emit_bytes(obj, p, len);
+
+    free(cwd);
+    free(p);
+    obj->section = section;
+}
+
+/*
+ * Builds the DWARF 5 line number program of .file/.loc, or of the source
+ * lines with -g, one sequence per section.
+ */
+int emit_debug_line(unit_t *unit, elf64_obj_t *obj)
+{
+    section_t *sec;
+    uint8_t *p;
+    size_t section, line_section, info, capacity, len, header_start;
+    uint64_t start;
+    char *cwd;
+
+    if (!obj->line_count) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < obj->line_count; i++) {
+        if (obj->lines[i].file >= obj->file_count
+            || !obj->files[obj->lines[i].file].name) {
+            fprintf(stderr, "Error: unassigned file number %lu.\n",
+                    obj->lines[i].file);
+            return 1;
+        }
+    }
+
+    section = obj->section;
+    line_section = find_section(obj, ".debug_line");
+    if (!line_section) {
+        line_section = add_section(obj, ".debug_line", SHT_PROGBITS, 0);
+    }
+    obj->section = line_section;
+    sec = &(obj->sections[line_section]);
+    start = sec->size;
+
+    cwd = getcwd(NULL, 0);
+    if (!obj->dir_count) {
+        obj->dir_count = 1;
+        obj->dirs = calloc(1, sizeof(char *));
+    }
+    if (!obj->dirs[0]) {
+        obj->dirs[0] = strdup(cwd ? cwd : ".");
+    }
+    free(cwd);
+    /* DWARF 5 wants the primary source file as file 0 */
+    if (!obj->files[0].name) {
+        obj->files[0].name = strdup(obj->files[1].name ? obj->files[1].name
+                                                       : "");
+        obj->files[0].dir = obj->files[1].dir;
+    }
+
+    capacity = 64 + obj->line_count * 96 + obj->section_count * 32;
+    for (size_t i = 0; i < obj->dir_count; i++) {
+        capacity += strlen(obj->dirs[i]) + 1;
+    }
+    for (size_t i = 0; i < obj->file_count; i++) {
+        capacity += (obj->files[i].name ? strlen(obj->files[i].name) : 0) + 12;
+    }
+    p = malloc(capacity);
+
+    len = 4;
+    *(uint16_t *)(p + len) = 5;  /* version */
+    len += 2;
+    p[len++] = 8;                /* address_size */
+    p[len++] = 0;                /* segment_selector_size */
+    len += 4;                    /* header_length */
+    header_start = len;
+    p[len++] = 1;                /* minimum_instruction_length */
+    p[len++] = 1;                /* maximum_operations_per_instruction */
+    p[len++] = 1;                /* default_is_stmt */
+    p[len++] = (uint8_t)LINE_BASE;
+    p[len++] = LINE_RANGE;
+    p[len++] = OPCODE_BASE;
+    memcpy(p + len, (uint8_t[]){ 0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1 }, 12);
+    len += 12;                   /* standard_opcode_lengths */
+
+    p[len++] = 1;                /* DW_LNCT_path, DW_FORM_string */
+    p[len++] = 0x01;
+    p[len++] = 0x08;
+    len += encode_uleb128(p + len, obj->dir_count);
+    for (size_t i = 0; i < obj->dir_count; i++) {
+        strcpy((char *)p + len, obj->dirs[i]);
+        len += strlen(obj->dirs[i]) + 1;
+    }
+
+    p[len++] = 2;                /* and DW_LNCT_directory_index, DW_FORM_udata */
+    p[len++] = 0x01;
+    p[len++] = 0x08;
+    p[len++] = 0x02;
+    p[len++] = 0x0F;
+    len += encode_uleb128(p + len, obj->file_count);
+    for (size_t i = 0; i < obj->file_count; i++) {
+        const char *name = obj->files[i].name ? obj->files[i].name : "";
+
+        strcpy((char *)p + len, name);
+        len += strlen(name) + 1;
+        len += encode_uleb128(p + len, obj->files[i].dir);
+    }
+    *(uint32_t *)(p + header_start - 4) = len - header_start;
+
+    for (size_t i = 1; i < obj->section_count; i++) {
+        uint64_t addr, file, line, column, isa;
+        int64_t line_delta;
+        int stmt, first;
+
+        first = 1;
+        addr = isa = column = 0;
+        file = line = stmt = 1;
+
+        for (size_t j = 0; j < obj->line_count; j++) {
+            line_t *row = &(obj->lines[j]);
+            uint64_t addr_delta;
+            int special;
+
+            if (row->section != i) {
+                continue;
+            }
+
+            if (first) {
+                p[len++] = 0;
+                p[len++] = 9;
+                p[len++] = DW_LNE_set_address;
+                memset(p + len, 0, 8);
+                add_reloc(obj, start + len, R_X86_64_64, i, row->loc);
+                len += 8;
+                addr = row->loc;
+                first = 0;
+            }
+
+            if (row->file != file) {
+                p[len++] = DW_LNS_set_file;
+                len += encode_uleb128(p + len, row->file);
+                file = row->file;
+            }
+            if (row->column != column) {
+                p[len++] = DW_LNS_set_column;
+                len += encode_uleb128(p + len, row->column);
+                column = row->column;
+            }
+            if (!(row->flags & LINE_STMT) != !stmt) {
+                p[len++] = DW_LNS_negate_stmt;
+                stmt = !stmt;
+            }
+            if (row->isa != isa) {
+                p[len++] = DW_LNS_set_isa;
+                len += encode_uleb128(p + len, row->isa);
+                isa = row->isa;
+            }
+            if (row->flags & LINE_BASIC_BLOCK) {
+                p[len++] = DW_LNS_set_basic_block;
+            }
+            if (row->flags & LINE_PROLOGUE_END) {
+                p[len++] = DW_LNS_set_prologue_end;
+            }
+            if (row->flags & LINE_EPILOGUE_BEGIN) {
+                p[len++] = DW_LNS_set_epilogue_begin;
+            }
+            if (row->discriminator) {
+                uint8_t d[10];
+                size_t d_len = encode_uleb128(d, row->discriminator);
+
+                p[len++] = 0;
+                len += encode_uleb128(p + len, d_len + 1);
+                p[len++] = DW_LNE_set_discriminator;
+                memcpy(p + len, d, d_len);
+                len += d_len;
+            }
+
+            /* a special opcode advances both, when the deltas are small */
+            line_delta = row->line - line;
+            if (line_delta < LINE_BASE || line_delta >= LINE_BASE + LINE_RANGE) {
+                p[len++] = DW_LNS_advance_line;
+                len += encode_sleb128(p + len, line_delta);
+                line_delta = 0;
+            }
+            line = row->line;
+
+            addr_delta = row->loc - addr;
+            addr = row->loc;
+            special = line_delta - LINE_BASE + OPCODE_BASE;
+            if (addr_delta <= (255 - special) / LINE_RANGE) {
+                p[len++] = special + addr_delta * LINE_RANGE;
+                continue;
+            }
+
+            /* DW_LNS_const_add_pc advances as much as special opcode 255 */
+            addr_delta -= (255 - OPCODE_BASE) / LINE_RANGE;
+            if (addr_delta <= (255 - special) / LINE_RANGE) {
+                p[len++] = DW_LNS_const_add_pc;
+                p[len++] = special + addr_delta * LINE_RANGE;
+                continue;
+            }
+            addr_delta += (255 - OPCODE_BASE) / LINE_RANGE;
+
+            p[len++] = DW_LNS_advance_pc;
+            len += encode_uleb128(p + len, addr_delta);
+            p[len++] = special;
+        }
+
+        if (!first) {
+            if (obj->sections[i].size > addr) {
+                p[len++] = DW_LNS_advance_pc;
+                len += encode_uleb128(p + len, obj->sections[i].size - addr);
+            }
+            p[len++] = 0;
+            p[len++] = 1;
+            p[len++] = DW_LNE_end_sequence;
+        }
+    }
+    *(uint32_t *)p = len - 4;
+
+    emit_bytes(obj, p, len);
+    free(p);
+    obj->section = section;
+
+    /* as the GNU assembler does, for -g or a hand written .file/.loc */
+    info = find_section(obj, ".debug_info");
+    if (!info || !obj->sections[info].size) {
+        emit_debug_info(unit, obj, start);
+    }
+
+    return 0;
+}
+
+/* the call frame information for .cfi_sections, .eh_frame by default */
+int emit_eh_frame(elf64_obj_t *obj)
+{
+    if (!obj->fde_count) {
+        return 0;
+    }
+    if (!obj->no_eh_frame && emit_frame(obj, 0)) {
+        return 1;
+    }
+    return obj->debug_frame ? emit_frame(obj, 1) : 0;
+}
+
+/*
+ * Emits `count` copies of `pattern`. Zeroes in SHT_NOBITS sections only grow
+ * the section, and large fills elsewhere are kept as a single fragment that
+ * is expanded by write_file_x86_64, so no memory is spent on them.
+ */
+int emit_fill(elf64_obj_t *obj, const uint8_t *pattern, size_t pattern_len,
+              size_t count)
+{
+    section_t *sec;
+    frag_t *frag;
+    uint8_t *p;
+    size_t len;
+
+    sec = &(obj->sections[obj->section]);
+    if (pattern_len && (count > SIZE_MAX / pattern_len
+                        || pattern_len * count > SIZE_MAX - sec->size)) {
+        fprintf(stderr, "Error: fill of %zu times %zu bytes is too large.\n",
+                count, pattern_len);
+        return 1;
+    }
+    len = pattern_len * count;
+
+    if (sec->type == SHT_NOBITS) {
+        for (int i = 0; i < pattern_len; i++) {
+            if (pattern[i]) {
+                fprintf(stderr, "Error: attempt to store non-zero value in section `%s`.\n",
+                        sec->name);
+                return 1;
+            }
+        }
+        sec->size += len;
+        return 0;
+    }
+
+    if (len <= FILL_INLINE_MAX) {
+        p = reserve_bytes(obj, len);
+        for (size_t i = 0; i < count; i++) {
+            memcpy(p + i * pattern_len, pattern, pattern_len);
+        }
+        return 0;
+    }
+
+    sec->frags = realloc(sec->frags, (sec->frag_count + 1) * sizeof(frag_t));
+    frag = &(sec->frags[sec->frag_count++]);
+    *frag = (frag_t){ .type = FRAG_FILL, .size = len,
+                      .pattern_len = pattern_len };
+    memcpy(frag->pattern, pattern, pattern_len);
+    sec->size += len;
+
+    return 0;
+}
+
+/*
+ * Builds .eh_frame, or .debug_frame when `debug` is set, from the .cfi_*
+ * directives. FDEs share a CIE when their augmentation and leading
+ * instructions match, as the GNU assembler does, and the instructions at
+ * the start of a function move into its CIE. .debug_frame has no
+ * personality or LSDA, refers to the CIE by its offset and to the code by
+ * absolute addresses.
+ */
+int emit_frame(elf64_obj_t *obj, int debug)
+{
+    const char *name;
+    size_t *cie_of, *initial;
+    size_t section, eh_frame;
+    section_t *sec;
+
+    section = obj->section;
+    name = debug ? ".debug_frame" : ".eh_frame";
+    eh_frame = find_section(obj, name);
+    if (!eh_frame) {
+        eh_frame = add_section(obj, name, SHT_PROGBITS,
+                               debug ? 0 : SHF_ALLOC);
+    }
+    obj->section = eh_frame;
+    if (obj->sections[eh_frame].type == SHT_NOBITS
+        || emit_align(obj, 8, 0, 0)) {
+        fprintf(stderr, "Error: can't write call frame information to `%s`.\n",
+                obj->sections[eh_frame].name);
+        obj->section = section;
+        return 1;
+    }
+
+    cie_of = malloc(obj->fde_count * sizeof(size_t));
+    initial = malloc(obj->fde_count * sizeof(size_t));
+
+    for (size_t i = 0; i < obj->fde_count; i++) {
+        fde_t *fde;
+        uint8_t buff[64], *body;
+        size_t len, body_len, fde_len, cie, initial_len;
+        uint64_t loc;
+        int pointer_size, flags, lsda, lsda_size, lsda_flags;
+
+        fde = &(obj->fdes[i]);
+
+        /* the leading rows that may go into the CIE */
+        initial[i] = 0;
+        while (initial[i] < fde->row_count
+               && fde->rows[initial[i]].loc == fde->start
+               && fde->rows[initial[i]].initial) {
+            initial[i]++;
+        }
+        initial_len = initial[i] ? fde->rows[initial[i] - 1].offset
+                                   + fde->rows[initial[i] - 1].len : 0;
+
+        for (cie = 0; cie < i; cie++) {
+            fde_t *other = &(obj->fdes[cie]);
+            size_t other_len;
+
+            other_len = initial[cie] ? other->rows[initial[cie] - 1].offset
+                                       + other->rows[initial[cie] - 1].len : 0;
+            if (other->signal_frame == fde->signal_frame
+                && other->return_column == fde->return_column
+                && (debug
+                    || (other->personality_encoding == fde->personality_encoding
+                        && other->personality == fde->personality
+                        && (other->lsda_encoding == 0xFF)
+                           == (fde->lsda_encoding == 0xFF)
+                        && (fde->lsda_encoding == 0xFF
+                            || other->lsda_encoding == fde->lsda_encoding)))
+                && other_len == initial_len
+                && !memcmp(other->insns, fde->insns, initial_len)) {
+                break;
+            }
+        }
+
+        sec = &(obj->sections[eh_frame]);
+        if (cie < i) {
+            cie_of[i] = cie_of[cie];
+        }
+        else {
+            /* a new CIE */
+            cie_of[i] = sec->size;
+            pointer_size = debug || fde->personality_encoding == 0xFF ? 0
+                         : eh_pointer_size(fde->personality_encoding, &flags);
+            lsda = !debug && fde->lsda_encoding != 0xFF;
+
+            len = 8;
+            buff[len++] = fde->return_column > 0xFF ? 3 : 1;
+            if (!debug) {
+                buff[len++] = 'z';
+            }
+            if (pointer_size) {
+                buff[len++] = 'P';
+            }
+            if (lsda) {
+                buff[len++] = 'L';
+            }
+            if (!debug) {
+                buff[len++] = 'R';
+            }
+            if (fde->signal_frame) {
+                buff[len++] = 'S';
+            }
+            buff[len++] = '\0';
+            len += encode_uleb128(buff + len, 1);  /* code alignment */
+            len += encode_sleb128(buff + len, -8); /* data alignment */
+            if (fde->return_column > 0xFF) {
+                len += encode_uleb128(buff + len, fde->return_column);
+            }
+            else {
+                buff[len++] = fde->return_column;
+            }
+            if (!debug) {
+                len += encode_uleb128(buff + len,
+                                      (pointer_size ? 1 + pointer_size : 0)
+                                      + lsda + 1);
+            }
+            if (pointer_size) {
+                buff[len++] = fde->personality_encoding;
+            }
+
+            /* the length excludes itself, and the CIE ends 8 byte aligned */
+            body_len = len + pointer_size + (debug ? 0 : lsda + 1)
+                     + initial_len;
+            body_len = ALIGNTO8(body_len);
+            *(uint32_t *)buff = body_len - 4;
+            *(uint32_t *)(buff + 4) = debug ? 0xFFFFFFFF : 0; /* CIE id */
+
+            emit_bytes(obj, buff, len);
+            if (pointer_size) {
+                memset(reserve_bytes(obj, pointer_size), 0, pointer_size);
+                add_fixup(obj, fde->personality_src, sec->size - pointer_size,
+                          pointer_size, flags, 0);
+            }
+            len = 0;
+            if (lsda) {
+                buff[len++] = fde->lsda_encoding;
+            }
+            if (!debug) {
+                buff[len++] = 0x1B; /* DW_EH_PE_pcrel | DW_EH_PE_sdata4 */
+            }
+            emit_bytes(obj, buff, len);
+            emit_bytes(obj, fde->insns, initial_len);
+            memset(reserve_bytes(obj, body_len - (sec->size - cie_of[i])),
+                   DW_CFA_nop, body_len - (sec->size - cie_of[i]));
+        }
+
+        /* the rest of the rows, with the advances between them */
+        body = malloc(fde->insns_len + fde->row_count * 5);
+        body_len = 0;
+        loc = fde->start;
+        for (size_t j = initial[i]; j < fde->row_count; j++) {
+            cfi_row_t *row = &(fde->rows[j]);
+            uint64_t delta = row->loc - loc;
+
+            if (!delta) {
+                ;
+            }
+            else if (delta < 0x40) {
+                body[body_len++] = DW_CFA_advance_loc | delta;
+            }
+            else if (delta <= 0xFF) {
+                body[body_len++] = DW_CFA_advance_loc1;
+                body[body_len++] = delta;
+            }
+            else if (delta <= 0xFFFF) {
+                body[body_len++] = DW_CFA_advance_loc2;
+                memcpy(body + body_len, &(uint16_t){ delta }, 2);
+                body_len += 2;
+            }
+            else {
+                body[body_len++] = DW_CFA_advance_loc4;
+                memcpy(body + body_len, &(uint32_t){ delta }, 4);
+                body_len += 4;
+            }
+            loc = row->loc;
+
+            memcpy(body + body_len, fde->insns + row->offset, row->len);
+            body_len += row->len;
+        }
+
+        /*
+         * .eh_frame FDEs are 4 byte aligned, the last one pads the section
+         * to its alignment. .debug_frame ones are all 8 byte aligned.
+         */
+        lsda_size = debug || fde->lsda_encoding == 0xFF ? 0
+                  : eh_pointer_size(fde->lsda_encoding, &lsda_flags);
+        if (debug) {
+            len = 24;
+            *(uint32_t *)(buff + 4) = 0;
+            *(uint64_t *)(buff + 8) = 0;
+            *(uint64_t *)(buff + 16) = fde->end - fde->start;
+        }
+        else {
+            len = 16 + encode_uleb128(buff + 16, lsda_size);
+            *(uint32_t *)(buff + 4) = sec->size + 4 - cie_of[i];
+            *(uint32_t *)(buff + 8) = 0;
+            *(uint32_t *)(buff + 12) = fde->end - fde->start;
+        }
+        fde_len = len + lsda_size + body_len;
+        if (debug || i + 1 == obj->fde_count) {
+            fde_len = ALIGNTO8(fde_len);
+        }
+        else {
+            fde_len = (fde_len + 3) & ~3;
+        }
+        *(uint32_t *)buff = fde_len - 4;
+
+        emit_bytes(obj, buff, len);
+        if (debug) {
+            add_reloc(obj, sec->size - len + 4, R_X86_64_32, eh_frame,
+                      cie_of[i]);
+            add_reloc(obj, sec->size - len + 8, R_X86_64_64, fde->section,
+                      fde->start);
+        }
+        else {
+            add_reloc(obj, sec->size - len + 8, R_X86_64_PC32, fde->section,
+                      fde->start);
+        }
+        if (lsda_size) {
+            memset(reserve_bytes(obj, lsda_size), 0, lsda_size);
+            add_fixup(obj, fde->lsda_src, sec->size - lsda_size, lsda_size,
+                      lsda_flags, 0);
+        }
+        emit_bytes(obj, body, body_len);
+        len = fde_len - len - lsda_size - body_len;
+        memset(reserve_bytes(obj, len), DW_CFA_nop, len);
+        free(body);
+    }
+
+    free(initial);
+    free(cie_of);
+    obj->section = section;
+    return 0;
+}
+
+/*
+ * Encodes the instruction form `insn` with its operands: the prefixes, REX,
+ * the opcode, ModRM and SIB, then the displacement and immediates, which get
+ * fixups when they aren't known yet.
+ */
+int encode_insn(elf64_obj_t *obj, const insn_t *insn, arg_t *args, int prefix,
+                int round, int size, uint64_t dot)
+{
+    static const uint8_t scales[9] = { [1] = 0, [2] = 1, [4] = 2, [8] = 3 };
+    uint8_t bytes[16], opcode[4], *p;
+    arg_t *reg, *rm, *plus, *rel, *vvvv, *is4, *mask, *imms[2];
+    int imm_sizes[2], imm_flags[2], imm_count, imm_len, disp_len, disp_scale,
+        rex, need_rex, high, start, mod, got_flags;
+    int64_t disp;
+    size_t len;
+
+    reg = rm = plus = rel = vvvv = is4 = mask = NULL;
+    imm_count = imm_len = 0;
+    for (int i = 0; i < insn->operand_count; i++) {
+        int imm_size, flags;
+
+        imm_size = flags = 0;
+        switch (insn->operands[i])
+        {
+            case OPERAND_R:
+                if (insn->flags & INSN_PLUSR) {
+                    plus = &(args[i]);
+                }
+                else {
+                    reg = &(args[i]);
+                }
+                break;
+            case OPERAND_RLQ: case OPERAND_X: case OPERAND_Y: case OPERAND_Z:
+            case OPERAND_K: case OPERAND_RL:
+                reg = &(args[i]);
+                break;
+            case OPERAND_RM: case OPERAND_M: case OPERAND_R8:
+            case OPERAND_R16: case OPERAND_R32: case OPERAND_R64:
+            case OPERAND_RM8:
+            case OPERAND_RM16: case OPERAND_RM32: case OPERAND_TARGET:
+            case OPERAND_RMLQ: case OPERAND_XM: case OPERAND_XR:
+            case OPERAND_YM: case OPERAND_YR: case OPERAND_ZM:
+            case OPERAND_ZR: case OPERAND_KM: case OPERAND_KR:
+            case OPERAND_XS: case OPERAND_YS: case OPERAND_ZS:
+                rm = &(args[i]);
+                break;
+            case OPERAND_XV: case OPERAND_YV: case OPERAND_ZV:
+            case OPERAND_KV: case OPERAND_RV:
+                vvvv = &(args[i]);
+                break;
+            case OPERAND_XI: case OPERAND_YI:
+                /* in the high bits of an immediate byte */
+                is4 = &(args[i]);
+                imm_len++;
+                break;
+            case OPERAND_IMM8: case OPERAND_UIMM8:
+                imm_size = 1;
+                break;
+            case OPERAND_IMM:
+                /* 64-bit operations take a sign extended imm32 */
+                imm_size = size == 8 ? 4 : size;
+                flags = size == 8 ? FIXUP_SIGNED : 0;
+                break;
+            case OPERAND_IMM16:
+                imm_size = 2;
+                break;
+            case OPERAND_IMM64:
+                imm_size = 8;
+                break;
+            case OPERAND_REL32:
+                rel = &(args[i]);
+                break;
+        }
+        if (args[i].mask) {
+            mask = &(args[i]);
+        }
+        if (imm_size) {
+            imms[imm_count] = &(args[i]);
+            imm_sizes[imm_count] = imm_size;
+            imm_flags[imm_count++] = flags;
+            imm_len += imm_size;
+        }
+    }
+
+    /* %spl..%dil need a REX prefix and %ah..%bh can't have one */
+    rex = (size == 8 && !(insn->flags & INSN_D64))
+          || (insn->flags & INSN_REX_W) ? 0x08 : 0;
+    need_rex = high = 0;
+    if (reg) {
+        rex |= (reg->reg & 8) >> 1;
+        need_rex |= reg->rex;
+        high |= reg->high;
+    }
+    if (plus) {
+        rex |= (plus->reg & 8) >> 3;
+        need_rex |= plus->rex;
+        high |= plus->high;
+    }
+    if (rm && rm->type == ARG_REG) {
+        rex |= (rm->reg & 8) >> 3;
+        need_rex |= rm->rex;
+        high |= rm->high;
+    }
+    else if (rm) {
+        rex |= rm->index >= 0 ? (rm->index & 8) >> 2 : 0;
+        rex |= rm->base >= 0 ? (rm->base & 8) >> 3 : 0;
+    }
+    if (high && (rex || need_rex)) {
+        fprintf(stderr, "Error: can't encode %%ah, %%ch, %%dh or %%bh in an instruction requiring a REX prefix.\n");
+        return 1;
+    }
+
+    len = 0;
+    if (rm && rm->segment) {
+        bytes[len++] = rm->segment;
+    }
+    if (size == 2) {
+        bytes[len++] = 0x66;
+    }
+    if (rm && rm->type == ARG_MEM && rm->addr32) {
+        bytes[len++] = 0x67;
+    }
+    if (prefix) {
+        bytes[len++] = prefix;
+    }
+
+    /* a mandatory prefix goes before REX, the escape bytes after it */
+    opcode[0] = insn->opcode >> 24;
+    opcode[1] = insn->opcode >> 16;
+    opcode[2] = insn->opcode >> 8;
+    opcode[3] = insn->opcode;
+    for (start = 0; start < 3 && !opcode[start]; start++);
+    if (insn->flags & (INSN_VEX | INSN_EVEX)) {
+        int pp, map, w, v, ll, vsib;
+
+        /* VEX.pp and VEX.mmmmm stand for them, REX.W is VEX.W */
+        pp = opcode[start] == 0x66 ? 1 : opcode[start] == 0xF3 ? 2
+           : opcode[start] == 0xF2 ? 3 : 0;
+        start += pp != 0;
+        map = start == 2 ? 1 : opcode[2] == 0x38 ? 2 : 3;
+        w = (rex & 0x08) || (insn->flags & INSN_VEX_W);
+        v = (~(vvvv ? vvvv->reg : 0) & 15) << 3
+          | (insn->flags & INSN_VEX_L ? 0x04 : 0) | pp;
+        if (insn->flags & INSN_EVEX) {
+            /*
+             * R' and V' extend reg and vvvv to 32 registers, X does rm's
+             * when it is one and V' a vector index. The rounding takes the
+             * place of L'L.
+             */
+            if (rm && rm->type == ARG_REG && (rm->reg & 16)) {
+                rex |= 0x02;
+            }
+            vsib = rm && rm->type == ARG_MEM && rm->vsib;
+            ll = round >= 0 ? round & 3 : insn->flags & INSN_EVEX_LL ? 2
+               : insn->flags & INSN_VEX_L ? 1 : 0;
+            bytes[len++] = 0x62;
+            bytes[len++] = (~rex & 0x07) << 5
+                         | (reg && (reg->reg & 16) ? 0 : 0x10) | map;
+            bytes[len++] = (w ? 0x80 : 0) | (v & 0x7B) | 0x04;
+            bytes[len++] = (mask && mask->zeroing ? 0x80 : 0) | ll << 5
+                         | (round >= 0 || (rm && rm->broadcast) ? 0x10 : 0)
+                         | ((vvvv && (vvvv->reg & 16))
+                            || (vsib && (rm->index & 16)) ? 0 : 0x08)
+                         | (mask ? mask->mask : 0);
+        }
+        else if (map == 1 && !w && !(rex & 0x03)) {
+            bytes[len++] = 0xC5;
+            bytes[len++] = (rex & 0x04 ? 0 : 0x80) | v;
+        }
+        else {
+            bytes[len++] = 0xC4;
+            bytes[len++] = (~rex & 0x07) << 5 | map;
+            bytes[len++] = (w ? 0x80 : 0) | v;
+        }
+    }
+    else {
+        if (start < 2 && opcode[start + 1] == 0x0F
+            && (opcode[start] == 0x66 || opcode[start] == 0xF2
+                || opcode[start] == 0xF3)) {
+            bytes[len++] = opcode[start++];
+        }
+        if (rex || need_rex) {
+            bytes[len++] = 0x40 | rex;
+        }
+        while (start < 3) {
+            bytes[len++] = opcode[start++];
+        }
+    }
+    bytes[len++] = opcode[3] | (plus ? plus->reg & 7 : 0);
+
+    disp_len = 0;
+    disp_scale = rm && rm->type == ARG_MEM && (insn->flags & INSN_EVEX)
+               ? disp8_scale(insn, rm) : 1;
+    disp = rm ? rm->value.value : 0;
+    if (rm && rm->type == ARG_REG) {
+        bytes[len++] = 0xC0 | (reg ? reg->reg & 7 : insn->ext) << 3
+                     | (rm->reg & 7);
+    }
+    else if (rm) {
+        mod = (reg ? reg->reg & 7 : insn->ext) << 3;
+        if (rm->rip) {
+            /* disp32(%rip) */
+            bytes[len++] = mod | 0x05;
+            disp_len = 4;
+        }
+        else if (rm->base < 0) {
+            /* disp32(, %index, scale), or just disp32 without an index */
+            bytes[len++] = mod | 0x04;
+            bytes[len++] = scales[rm->scale] << 6
+                         | (rm->index >= 0 ? rm->index & 7 : 4) << 3 | 0x05;
+            disp_len = 4;
+        }
+        else {
+            /* %rbp and %r13 as base always have a displacement */
+            if (!expr_constant(&(rm->value))) {
+                disp_len = 4;
+            }
+            else if (disp || (rm->base & 7) == 5) {
+                /* EVEX's disp8 is a multiple of the operand size */
+                disp_len = disp % disp_scale == 0
+                           && disp / disp_scale >= -128
+                           && disp / disp_scale <= 127 ? 1 : 4;
+                disp /= disp_len == 1 ? disp_scale : 1;
+            }
+            mod |= disp_len == 4 ? 0x80 : disp_len << 6;
+            /* %rsp and %r12 as base need a SIB byte */
+            if (rm->index >= 0 || (rm->base & 7) == 4) {
+                bytes[len++] = mod | 0x04;
+                bytes[len++] = scales[rm->scale] << 6
+                             | (rm->index >= 0 ? rm->index & 7 : 4) << 3
+                             | (rm->base & 7);
+            }
+            else {
+                bytes[len++] = mod | (rm->base & 7);
+            }
+        }
+
+        if (disp_len == 4 && expr_constant(&(rm->value)) && !rm->rip
+            && (rm->value.value < INT32_MIN
+                || rm->value.value > (rm->addr32 ? UINT32_MAX : INT32_MAX))) {
+            fprintf(stderr, "Error: displacement %ld is out of range.\n",
+                    rm->value.value);
+            return 1;
+        }
+    }
+
+    /*
+     * A GOT load by mov, test or a binary operator, or a call or jmp
+     * through the GOT, which the linker may rewrite when the symbol turns
+     * out to be local
+     */
+    got_flags = 0;
+    if (rm && rm->rip && size != 2
+        && !(insn->flags & (INSN_VEX | INSN_EVEX))
+        && (insn->opcode == 0x8B || insn->opcode == 0x85
+            || (insn->opcode | 0x38) == 0x3B
+            || (insn->opcode == 0xFF && (insn->ext == 2 || insn->ext == 4)))) {
+        got_flags = FIXUP_GOTPCRELX | (rex || need_rex ? FIXUP_REX : 0);
+    }
+
+    p = reserve_bytes(obj, len + disp_len);
+    memcpy(p, bytes, len);
+    if (disp_len && expr_constant(&(rm->value))) {
+        for (int i = 0; i < disp_len; i++) {
+            p[len + i] = (uint64_t)disp >> (i * 8);
+        }
+    }
+    else if (disp_len) {
+        memset(p + len, 0, disp_len);
+        /*
+         * %rip points past the immediates; a narrow lea keeps only the low
+         * bits of the address, so it need not sign extend
+         */
+        add_fixup(obj, rm->src, dot, 4,
+                  rm->rip ? FIXUP_PCREL | got_flags
+                  : rm->addr32 || (insn->opcode == 0x8D && size < 8)
+                  ? 0 : FIXUP_SIGNED,
+                  rm->rip ? -4 - imm_len : 0);
+    }
+
+    for (int i = 0; i < imm_count; i++) {
+        p = reserve_bytes(obj, imm_sizes[i]);
+        if (expr_constant(&(imms[i]->value))) {
+            for (int j = 0; j < imm_sizes[i]; j++) {
+                p[j] = (uint64_t)imms[i]->value.value >> (j * 8);
+            }
+        }
+        else {
+            memset(p, 0, imm_sizes[i]);
+            add_fixup(obj, imms[i]->src, dot, imm_sizes[i], imm_flags[i], 0);
+        }
+    }
+
+    if (is4) {
+        *reserve_bytes(obj, 1) = is4->reg << 4;
+    }
+
+    if (rel) {
+        memset(reserve_bytes(obj, 4), 0, 4);
+        add_fixup(obj, rel->src, dot, 4, FIXUP_PCREL | FIXUP_BRANCH, -4);
+    }
+
+    return 0;
+}
+
+size_t encode_sleb128(uint8_t *p, int64_t value)
+{
+    size_t len;
+    uint8_t byte;
+
+    len = 0;
+    do {
+        byte = value & 0x7F;
+        value >>= 7;
+        if ((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40))) {
+            p[len++] = byte;
+            return len;
+        }
+        p[len++] = byte | 0x80;
+    } while (1);
+}
+
+size_t encode_uleb128(uint8_t *p, uint64_t value)
+{
+    size_t len;
+
+    len = 0;
+    do {
+        p[len] = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            p[len] |= 0x80;
+        }
+        len++;
+    } while (value);
+
+    return len;
+}
+
+void fill_nops(uint8_t *p, size_t len)
+{
+    while (len > 0) {
+        size_t n = len < 11 ? len : 11;
+
+        memcpy(p, nops[n - 1], n);
+        p += n;
+        len -= n;
+    }
+}
+
+/*
+ * -ffunction-sections: moves the function starting at `sym` into a section
+ * of its own, named after the text section it is written in, so .text.hot
+ * and .text.unlikely functions stay grouped for the linker. An .align right
+ * before the label moves along with it. Code that falls through into the
+ * label keeps it in its own section, the two can't be apart.
+ */
+void function_section(elf64_obj_t *obj, symbol_t *sym)
+{
+    static const char *texts[] = {
+        ".text", ".text.hot", ".text.unlikely", ".text.startup", ".text.exit"
+    };
+    section_t *sec;
+    frag_t *frag;
+    size_t base, index;
+    uint64_t end;
+    char *name;
+    int text;
+
+    sec = &(obj->sections[obj->section]);
+    base = sec->base ? sec->base : obj->section;
+
+    text = 0;
+    for (int i = 0; i < sizeof(texts) / sizeof(texts[0]); i++) {
+        text |= !strcmp(obj->sections[base].name, texts[i]);
+    }
+    if (!text || !strncmp(sym->name, ".L", 2)) {
+        return;
+    }
+    if (ELF64_ST_TYPE(sym->sym.st_info) != STT_FUNC
+        && ELF64_ST_TYPE(sym->sym.st_info) != STT_GNU_IFUNC
+        && ELF64_ST_BIND(sym->sym.st_info) == STB_LOCAL) {
+        return;
+    }
+
+    /* only the start of a section or a jmp, ret or ud2 can come before */
+    end = sec->size;
+    if (obj->pad_section == obj->section && obj->pad_end == end) {
+        end -= obj->pad_len;
+    }
+    if ((end || sec->base)
+        && (obj->stop_section != obj->section || obj->stop_end != end)) {
+        return;
+    }
+
+    name = malloc(strlen(obj->sections[base].name) + strlen(sym->name) + 2);
+    sprintf(name, "%s.%s", obj->sections[base].name, sym->name);
+    index = find_section(obj, name);
+    if (!index) {
+        index = add_section(obj, name, obj->sections[base].type,
+                            obj->sections[base].flags);
+        obj->sections[index].base = base;
+    }
+    free(name);
+
+    sec = &(obj->sections[obj->section]);
+    if (obj->pad_section == obj->section && obj->pad_end == sec->size) {
+        frag = sec->frag_count ? &(sec->frags[sec->frag_count - 1]) : NULL;
+        if (frag && frag->type == FRAG_DATA && frag->size >= obj->pad_len) {
+            shrink_bytes(obj, obj->pad_len);
+        }
+        else if (frag && frag->type == FRAG_FILL && frag->size == obj->pad_len) {
+            sec->frag_count--;
+            sec->size -= obj->pad_len;
+        }
+        if (obj->pad_align > obj->sections[index].addralign) {
+            obj->sections[index].addralign = obj->pad_align;
+        }
+        /* the new section starts aligned, none of it is needed there */
+        while (obj->align_count
+               && obj->aligns[obj->align_count - 1].section == obj->section
+               && obj->aligns[obj->align_count - 1].start >= sec->size) {
+            obj->align_count--;
+        }
+        sec->addralign = obj->pad_addralign;
+        obj->pad_section = 0;
+    }
+
+    obj->section = index;
+}
+
+/*
+ * The forms of an instruction, in the order they are tried. The index is
+ * sorted on first use, the forms all in one array so that those of a
+ * mnemonic keep their order in the tables.
+ */
+const insn_t **find_insns(const char *mnemonic, size_t *count)
+{
+    static const insn_t **insn_index;
+    static insn_t *forms;
+    static size_t total;
+    size_t low, high, cc_count, evex_count;
+    char *name;
+
+    if (!insn_index) {
+        cc_count = sizeof(conditions) / sizeof(conditions[0]);
+        evex_count = sizeof(avx512_insns) / sizeof(avx512_insns[0]);
+        forms = malloc(sizeof(insns) + 3 * (cc_count + evex_count)
+                                       * sizeof(insn_t));
+        memcpy(forms, insns, sizeof(insns));
+        total = sizeof(insns) / sizeof(insns[0]);
+
+        /* jcc, setcc and cmovcc for each name of each condition */
+        for (size_t i = 0; i < cc_count; i++) {
+            name = malloc(3 * strlen(conditions[i].name) + 11);
+            forms[total++] = (insn_t){
+                name, 0x0F80 | conditions[i].code, -1, INSN_D64, 1,
+                { OPERAND_REL32 }
+            };
+            name += sprintf(name, "j%s", conditions[i].name) + 1;
+            forms[total++] = (insn_t){
+                name, 0x0F90 | conditions[i].code, 0, INSN_B, 1,
+                { OPERAND_RM }
+            };
+            name += sprintf(name, "set%s", conditions[i].name) + 1;
+            forms[total++] = (insn_t){
+                name, 0x0F40 | conditions[i].code, -1, INSN_WLQ, 2,
+                { OPERAND_RM, OPERAND_R }
+            };
+            sprintf(name, "cmov%s", conditions[i].name);
+        }
+
+        /* the AVX-512 forms, shortest vectors first */
+        for (size_t i = 0; i < evex_count; i++) {
+            for (int length = 16; length <= 64; length *= 2) {
+                if (avx512_insns[i].flags & (INSN_128 * length / 16)) {
+                    forms[total++] = evex_form(&(avx512_insns[i]), length);
+                }
+            }
+        }
+
+        insn_index = malloc(total * sizeof(insn_t *));
+        for (size_t i = 0; i < total; i++) {
+            insn_index[i] = &(forms[i]);
+        }
+        qsort(insn_index, total, sizeof(insn_t *), compare_insns);
+    }
+
+    low = 0;
+    high = total;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+
+        if (strcmp(insn_index[middle]->mnemonic, mnemonic) < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    for (*count = 0; low + *count < total
+                     && !strcmp(insn_index[low + *count]->mnemonic, mnemonic);
+         (*count)++);
+    return insn_index + low;
+}
+
+size_t find_section(elf64_obj_t *obj, const char *name)
+{
+    for (size_t i = 1; i < obj->section_count; i++) {
+        if (!strcmp(obj->sections[i].name, name)) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+symbol_t *find_symbol(elf64_obj_t *obj, const char *name)
+{
+    for (size_t i = 0; i < obj->sym_count; i++) {
+        if (!strcmp(obj->syms[i].name, name)) {
+            return &(obj->syms[i]);
+        }
+    }
+
+    return NULL;
+}
+
+symbol_t *get_symbol(elf64_obj_t *obj, const char *name)
+{
+    symbol_t *sym;
+
+    sym = find_symbol(obj, name);
+    if (sym) {
+        return sym;
+    }
+
+    obj->syms = realloc(obj->syms, (obj->sym_count + 1) * sizeof(symbol_t));
+    sym = &(obj->syms[obj->sym_count++]);
+    *sym = (symbol_t){
+        .name = malloc(strlen(name) + 1),
+        .sym = (Elf64_Sym){
+            .st_name = 0, .st_info = ELF64_ST_INFO(STB_LOCAL, STT_NOTYPE),
+            .st_other = STV_DEFAULT, .st_shndx = SHN_UNDEF, .st_value = 0,
+            .st_size = 0
+        }
+    };
+    strcpy(sym->name, name);
+
+    return sym;
+}
+
+int lex(unit_t *unit, token_t *token)
+{
+    char c;
+    int return_value;
+
+    /* Skip Whitespace */
+    while (isblank(unit->src[unit->i])) {
+        unit->i++;
+    }
+
+    skip_comments(unit);
+
+    c = unit->src[unit->i];
+    return_value = 0;
+
+    switch (c)
+    {
+        case '$':
+            token->type = IMMEDIATE;
+            token->start = unit->i;
+            unit->i++;
+            token->len = 1;
+            break;
+        case '%':
+            unit->i++;
+            return_value = lex_id(unit, token);
+            token->type = REGISTER;
+            break;
+        case '"':
+            return_value = lex_string(unit, token);
+            break;
+        case ',':
+            token->type = COMMA;
+            token->start = unit->i;
+            unit->i++;
+            token->len = 1;
+            break;
+        case '@':
+            /* section types, `@progbits` */
+            return_value = lex_id(unit, token);
+            break;
+        case '<':
+        case '>':
+            if (unit->src[unit->i + 1] != c) {
+                fprintf(stderr, "Invalid character `%c` in mnemonic.\n", c);
+                return 1;
+            }
+            token->type = OPERATOR;
+            token->start = unit->i;
+            unit->i += 2;
+            token->len = 2;
+            break;
+        case '+': case '-': case '*': case '/':
+        case '&': case '|': case '^': case '~': case '!':
+        case '(': case ')': case '{':
+            token->type = OPERATOR;
+            token->start = unit->i;
+            unit->i++;
+            token->len = 1;
+            break;
+        case '\'':
+            /* character constants, `'a` */
+            return_value = lex_constant(unit, token);
+            break;
+        case '\n':
+            token->type = NEWLINE;
+            token->start = unit->i;
+            unit->i++;
+            token->len = 1;
+            break;
+        case '\0':
+            token->type = ENDOFFILE;
+            token->start = unit->i;
+            token->len = 1;
+            break;
+        default:
+            if (isdigit(c)) {
+                return_value = lex_constant(unit, token);
+                break;
+            }
+            if (c == '.' || c == '_' || isalpha(c)) {
+                return_value = lex_id(unit, token);
+                if (unit->src[unit->i] == ':') {
+                    token->type = LABEL;
+                    unit->i++;
+                }
+                else if (c == '.') {
+                    token->type = DIRECTIVE;
+                }
+                break;
+            }
+
+            fprintf(stderr, "Invalid character `%c` in mnemonic.\n", c);
+            return 1;
+    }
+
+    return return_value;
+}
+
+int lex_constant(unit_t *unit, token_t *token)
+{
+    const char *s;
+    int base, digit;
+
+    token->type = CONSTANT;
+    token->start = unit->i;
+    token->value = 0;
+    s = unit->src;
+
+    if (s[unit->i] == '\'') {
+        unit->i++;
+        if (s[unit->i] == '\\' && s[unit->i + 1] != '\n'
+            && s[unit->i + 1] != '\0') {
+            uint8_t c;
+
+            /* reuse the string escapes, `'\n` */
+            decode_string(s + unit->i, 2, &c);
+            token->value = c;
+            unit->i += 2;
+        }
+        else if (s[unit->i] != '\n' && s[unit->i] != '\0') {
+            token->value = (uint8_t)s[unit->i++];
+        }
+        else {
+            fprintf(stderr, "Error: missing character in constant.\n");
+            return 1;
+        }
+        /* the closing quote is optional */
+        if (s[unit->i] == '\'') {
+            unit->i++;
+        }
+        token->len = unit->i - token->start;
+        return 0;
+    }
+
+    base = 10;
+    if (s[unit->i] == '0') {
+        if (s[unit->i + 1] == 'x' || s[unit->i + 1] == 'X') {
+            base = 16;
+            unit->i += 2;
+        }
+        else if (s[unit->i + 1] == 'b' || s[unit->i + 1] == 'B') {
+            base = 2;
+            unit->i += 2;
+        }
+        else {
+            base = 8;
+        }
+    }
+
+    for (;;) {
+        char c = tolower(s[unit->i]);
+
+        if (isdigit(c)) {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        }
+        else {
+            break;
+        }
+        if (digit >= base) {
+            fprintf(stderr, "Error: invalid digit `%c` in constant.\n", c);
+            return 1;
+        }
+
+        token->value = token->value * base + digit;
+        unit->i++;
+    }
+
+    if (isalpha(s[unit->i]) || s[unit->i] == '_') {
+        fprintf(stderr, "Error: junk `%c` after constant.\n", s[unit->i]);
+        return 1;
+    }
+
+    token->len = unit->i - token->start;
+    return 0;
+}
+
+int lex_id(unit_t *unit, token_t *token)
+{
+    char c;
+
+    token->type = ID;
+    token->start = unit->i++;
+
+    c = unit->src[unit->i];
+    while (isalnum(c) || c == '_' || c == '.' || c == '$') {
+        c = unit->src[++unit->i];
+    }
+
+    token->len = unit->i - token->start;
+    return 0;
+}
+
+int lex_string(unit_t *unit, token_t *token)
+{
+    token->type = STRING;
+    token->start = unit->i++;
+    token->value = 0;
+
+    for (;;) {
+        unit->i += scan_string(unit->src + unit->i);
+
+        switch (unit->src[unit->i])
+        {
+            case '"':
+                unit->i++;
+                token->len = unit->i - token->start;
+                return 0;
+            case '\\':
+                if (unit->src[unit->i + 1] != '\n'
+                    && unit->src[unit->i + 1] != '\0') {
+                    token->value++;
+                    unit->i += 2;
+                    break;
+                }
+                /* fallthrough */
+            default:
+                fprintf(stderr, "Error: missing end quote.\n");
+                return 1;
+        }
+    }
+}
+
+int load_zstd()
+{
+    void *lib;
+
+    lib = dlopen("libzstd.so.1", RTLD_NOW);
+    if (!lib) {
+        fprintf(stderr, "Error: zstd compression needs libzstd.so.1: %s\n",
+                dlerror());
+        return 1;
+    }
+
+    zstd.compress_bound = dlsym(lib, "ZSTD_compressBound");
+    zstd.compress = dlsym(lib, "ZSTD_compress");
+    zstd.is_error = dlsym(lib, "ZSTD_isError");
+    if (!zstd.compress_bound || !zstd.compress || !zstd.is_error) {
+        fprintf(stderr, "Error: libzstd.so.1 lacks the simple compression API.\n");
+        dlclose(lib);
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Whether lock may go before the instruction: a read-modify-write of the
+ * memory operand that is its destination.
+ */
+int lockable(const insn_t *insn, const arg_t *args, int arg_count)
+{
+    static const char *mnemonics[] = {
+        "adc", "add", "and", "btc", "btr", "bts", "cmpxchg", "cmpxchg16b",
+        "cmpxchg8b", "dec", "inc", "neg", "not", "or", "sbb", "sub", "xadd",
+        "xchg", "xor"
+    };
+
+    if (!arg_count || args[arg_count - 1].type != ARG_MEM) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(mnemonics) / sizeof(mnemonics[0]); i++) {
+        if (!strcmp(insn->mnemonic, mnemonics[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Whether the operand can be of the form's class. The registers that have
+ * the operand size set it, or have to agree with it.
+ */
+int match_arg(int operand, const arg_t *arg, int *size)
+{
+    int gpr, xmm, ymm, zmm, k, reg_size;
+
+    if (arg->indirect != (operand == OPERAND_TARGET)) {
+        return 0;
+    }
+    /* a vector index only addresses the elements of a gather or scatter */
+    if (arg->type == ARG_MEM && arg->vsib
+        && operand != OPERAND_XS && operand != OPERAND_YS
+        && operand != OPERAND_ZS) {
+        return 0;
+    }
+
+    gpr = arg->type == ARG_REG && arg->kind == REG_GPR;
+    xmm = arg->type == ARG_REG && arg->kind == REG_XMM;
+    ymm = arg->type == ARG_REG && arg->kind == REG_YMM;
+    zmm = arg->type == ARG_REG && arg->kind == REG_ZMM;
+    k = arg->type == ARG_REG && arg->kind == REG_K;
+    reg_size = 0;
+    switch (operand)
+    {
+        case OPERAND_R: case OPERAND_RV:
+            if (!gpr) {
+                return 0;
+            }
+            reg_size = arg->size;
+            break;
+        case OPERAND_ACC:
+            if (!gpr || arg->reg || arg->high) {
+                return 0;
+            }
+            reg_size = arg->size;
+            break;
+        case OPERAND_RM:
+            if (!gpr && arg->type != ARG_MEM) {
+                return 0;
+            }
+            reg_size = gpr ? arg->size : 0;
+            break;
+        case OPERAND_TARGET:
+            return (gpr && arg->size == 8) || arg->type == ARG_MEM;
+        case OPERAND_M:
+            return arg->type == ARG_MEM;
+        case OPERAND_R8:
+            return gpr && arg->size == 1;
+        case OPERAND_R16:
+            return gpr && arg->size == 2;
+        case OPERAND_R32: case OPERAND_RL:
+            return gpr && arg->size == 4;
+        case OPERAND_R64:
+            return gpr && arg->size == 8;
+        case OPERAND_RM8:
+            return (gpr && arg->size == 1) || arg->type == ARG_MEM;
+        case OPERAND_RM16:
+            return (gpr && arg->size == 2) || arg->type == ARG_MEM;
+        case OPERAND_RM32:
+            return (gpr && arg->size == 4) || arg->type == ARG_MEM;
+        case OPERAND_RLQ:
+            return gpr && arg->size >= 4;
+        case OPERAND_RMLQ:
+            return (gpr && arg->size >= 4) || arg->type == ARG_MEM;
+        case OPERAND_X: case OPERAND_XR: case OPERAND_XV: case OPERAND_XI:
+            return xmm;
+        case OPERAND_XM:
+            return xmm || arg->type == ARG_MEM;
+        case OPERAND_Y: case OPERAND_YR: case OPERAND_YV: case OPERAND_YI:
+            return ymm;
+        case OPERAND_YM:
+            return ymm || arg->type == ARG_MEM;
+        case OPERAND_Z: case OPERAND_ZR: case OPERAND_ZV:
+            return zmm;
+        case OPERAND_ZM:
+            return zmm || arg->type == ARG_MEM;
+        case OPERAND_K: case OPERAND_KR: case OPERAND_KV:
+            return k;
+        case OPERAND_KM:
+            return k || arg->type == ARG_MEM;
+        case OPERAND_XS:
+            return arg->type == ARG_MEM && arg->vsib == REG_XMM;
+        case OPERAND_YS:
+            return arg->type == ARG_MEM && arg->vsib == REG_YMM;
+        case OPERAND_ZS:
+            return arg->type == ARG_MEM && arg->vsib == REG_ZMM;
+        case OPERAND_XMM0:
+            return xmm && !arg->reg;
+        case OPERAND_CL:
+            return gpr && arg->size == 1 && arg->reg == 1 && !arg->high;
+        case OPERAND_ONE:
+            return arg->type == ARG_IMM && expr_constant(&(arg->value))
+                   && arg->value.value == 1;
+        case OPERAND_IMM8: case OPERAND_UIMM8: case OPERAND_IMM:
+        case OPERAND_IMM16: case OPERAND_IMM64:
+            return arg->type == ARG_IMM;
+        case OPERAND_REL32:
+            return arg->type == ARG_MEM && arg->base < 0 && arg->index < 0
+                   && !arg->rip && !arg->segment;
+        default:
+            return 0;
+    }
+
+    if (reg_size && *size && reg_size != *size) {
+        return 0;
+    }
+    if (reg_size) {
+        *size = reg_size;
+    }
+    return 1;
+}
+
+/*
+ * Whether the EVEX form takes the operands' decorators and the rounding: a
+ * broadcast has to fill the vector, and the rounding replaces the vector
+ * length, so only registers of 512-bit and scalar forms have it.
+ */
+int match_evex(const insn_t *insn, const arg_t *args, int arg_count,
+               int round)
+{
+    int length, count, vsib, mask;
+
+    length = insn->flags & INSN_EVEX_LL ? 64 : insn->flags & INSN_VEX_L ? 32
+           : 16;
+    vsib = mask = 0;
+    for (int i = 0; i < arg_count; i++) {
+        if (args[i].mask && (insn->flags & INSN_NOMASK)) {
+            return 0;
+        }
+        vsib |= args[i].type == ARG_MEM && args[i].vsib;
+        mask |= args[i].mask && !args[i].zeroing;
+        if (!args[i].broadcast) {
+            continue;
+        }
+        count = length / (insn->tuple == TUPLE_HV
+                          || (insn->flags & INSN_VEX_W) ? 8 : 4);
+        if ((insn->tuple != TUPLE_FV && insn->tuple != TUPLE_HV)
+            || args[i].broadcast != count) {
+            return 0;
+        }
+    }
+    /* gathers and scatters clear the mask as they go, it can't be left out */
+    if (vsib && !mask) {
+        return 0;
+    }
+
+    if (round < 0) {
+        return 1;
+    }
+    if (!(insn->flags & (round == 4 ? INSN_SAE : INSN_ER))) {
+        return 0;
+    }
+    for (int i = 0; i < arg_count; i++) {
+        if (args[i].type == ARG_MEM) {
+            return 0;
+        }
+    }
+    return length == 64 || insn->tuple >= TUPLE_N1;
+}
+
+/* Whether the immediate fits the form's class at the operand size. */
+int match_imm(int operand, const arg_t *arg, int size)
+{
+    int64_t value, min, max;
+
+    value = arg->value.value;
+    if (!expr_constant(&(arg->value))) {
+        /* only known values pick the short forms */
+        return operand != OPERAND_IMM8;
+    }
+
+    switch (operand)
+    {
+        case OPERAND_IMM8:
+            /* an unsigned value of the operand size may be negative */
+            if (size == 4 && value >= 0 && value <= UINT32_MAX) {
+                value = (int32_t)value;
+            }
+            else if (size == 2 && value >= 0 && value <= UINT16_MAX) {
+                value = (int16_t)value;
+            }
+            return value >= INT8_MIN && value <= INT8_MAX;
+        case OPERAND_UIMM8:
+            return value >= INT8_MIN && value <= UINT8_MAX;
+        case OPERAND_IMM16:
+            return value >= INT16_MIN && value <= UINT16_MAX;
+        case OPERAND_IMM:
+            min = size == 8 ? INT32_MIN : -((int64_t)1 << (size * 8 - 1));
+            max = size == 8 ? INT32_MAX : ((int64_t)1 << (size * 8)) - 1;
+            return value >= min && value <= max;
+        default:
+            return 1;
+    }
+}
+
+/*
+ * Picks the first form the operands fit. `size` is the operand size from
+ * the mnemonic's suffix, or 0, and is set to the one used.
+ */
+const insn_t *match_insn(const insn_t **forms, size_t count, arg_t *args,
+                         int arg_count, int round, int *size)
+{
+    const insn_t *insn, *vex3;
+    int operand_size, sizes, ambiguous, ok, vex3_size;
+
+    ambiguous = 0;
+    vex3 = NULL;
+    vex3_size = 0;
+    for (size_t i = 0; i < count; i++) {
+        insn = forms[i];
+        if (insn->operand_count != arg_count) {
+            continue;
+        }
+
+        operand_size = *size;
+        sizes = insn->flags & (INSN_B | INSN_WLQ);
+        if (operand_size && !sizes
+            && !(operand_size == 8 && (insn->flags & INSN_D64))) {
+            continue;
+        }
+
+        ok = 1;
+        for (int j = 0; j < arg_count && ok; j++) {
+            ok = match_arg(insn->operands[j], &(args[j]), &operand_size);
+        }
+        if (!ok) {
+            continue;
+        }
+
+        if (!operand_size && sizes) {
+            /* the byte forms follow the others, `addb` isn't a guess */
+            if (!(sizes & (sizes - 1)) && !ambiguous) {
+                operand_size = sizes;
+            }
+            else if (insn->flags & INSN_D64) {
+                operand_size = 8;
+            }
+            else {
+                ambiguous = 1;
+                continue;
+            }
+        }
+        if (sizes && !(sizes & operand_size)) {
+            continue;
+        }
+
+        for (int j = 0; j < arg_count && ok; j++) {
+            ok = args[j].type != ARG_IMM
+                 || match_imm(insn->operands[j], &(args[j]), operand_size);
+        }
+        /* xchg %eax, %eax zero extends, unlike 0x90 */
+        if (!ok || ((insn->flags & INSN_PLUSR) && insn->opcode == 0x90
+                    && !args[0].reg && !args[1].reg && operand_size == 4)) {
+            continue;
+        }
+
+        /* %xmm16 and up, masks, {1toN} and rounding need an EVEX form */
+        if (insn->flags & INSN_EVEX ? !match_evex(insn, args, arg_count, round)
+            : round >= 0 || needs_evex(args, arg_count)) {
+            continue;
+        }
+
+        /* the store form of vmovaps %xmm8, %xmm0 does with a 2-byte VEX */
+        if ((insn->flags & INSN_VEX)
+            && needs_vex3(insn, args, operand_size)) {
+            if (!vex3) {
+                vex3 = insn;
+                vex3_size = operand_size;
+            }
+            continue;
+        }
+        if (vex3 && (insn->flags & INSN_EVEX)) {
+            continue;
+        }
+
+        *size = operand_size;
+        return insn;
+    }
+
+    if (vex3) {
+        *size = vex3_size;
+        return vex3;
+    }
+    if (ambiguous) {
+        fprintf(stderr, "Error: no operand size for `%s`, it needs a suffix.\n",
+                forms[0]->mnemonic);
+    }
+    else {
+        fprintf(stderr, "Error: invalid operands for `%s`.\n",
+                forms[0]->mnemonic);
+    }
+    return NULL;
+}
+
+/*
+ * Whether relax_branches may still change the distance between two offsets
+ * in the section: a branch between them may get shorter, and so may move
+ * the padding of an .align between them.
+ */
+int may_relax(elf64_obj_t *obj, size_t section, uint64_t a, uint64_t b)
+{
+    uint64_t low, high;
+    int before;
+
+    low = a < b ? a : b;
+    high = a < b ? b : a;
+    before = 0;
+    for (size_t i = 0; i < obj->branch_count; i++) {
+        deferred_t *expr = &(obj->fixups[obj->branches[i].fixup].expr);
+
+        if (expr->section == section && expr->dot < high) {
+            if (expr->dot >= low) {
+                return 1;
+            }
+            before = 1;
+        }
+    }
+    for (size_t i = 0; before && i < obj->align_count; i++) {
+        if (obj->aligns[i].section == section && obj->aligns[i].start >= low
+            && obj->aligns[i].start < high) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Whether only an EVEX form can encode the operands: %xmm16 to %xmm31 and
+ * the wider registers numbered like them, or a decorator.
+ */
+int needs_evex(const arg_t *args, int arg_count)
+{
+    for (int i = 0; i < arg_count; i++) {
+        if (args[i].mask || args[i].zeroing || args[i].broadcast
+            || (args[i].type == ARG_REG && args[i].kind >= REG_XMM
+                && args[i].kind <= REG_ZMM && (args[i].reg & 16))
+            || (args[i].type == ARG_MEM && args[i].vsib
+                && (args[i].index & 16))) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Whether the VEX form takes the 3-byte prefix with these operands: it is
+ * in the 0F38 or 0F3A map, sets VEX.W, or needs REX.X or REX.B.
+ */
+int needs_vex3(const insn_t *insn, const arg_t *args, int size)
+{
+    if ((insn->opcode >> 8 & 0xFF) != 0x0F || (insn->flags & INSN_VEX_W)
+        || size == 8) {
+        return 1;
+    }
+
+    for (int i = 0; i < insn->operand_count; i++) {
+        switch (insn->operands[i])
+        {
+            case OPERAND_RM: case OPERAND_M: case OPERAND_RM32:
+            case OPERAND_RMLQ: case OPERAND_XM: case OPERAND_XR:
+            case OPERAND_YM: case OPERAND_YR: case OPERAND_R32:
+            case OPERAND_KM: case OPERAND_KR:
+                if (args[i].type == ARG_REG) {
+                    return (args[i].reg & 8) != 0;
+                }
+                return (args[i].base >= 0 && (args[i].base & 8))
+                       || (args[i].index >= 0 && (args[i].index & 8));
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Binary operators bind in the GNU assembler's order: level 1 is
+ * `* / % << >>`, level 2 is `| & ^` and level 3 is `+ -`.
+ */
+int operator_level(unit_t *unit, token_t *token)
+{
+    /* a `%` after an operand is the modulo, it was lexed as a register */
+    if (token->type == REGISTER) {
+        return 1;
+    }
+    if (token->type != OPERATOR) {
+        return 0;
+    }
+
+    switch (unit->src[token->start])
+    {
+        case '*': case '/': case '<': case '>':
+            return 1;
+        case '|': case '&': case '^':
+            return 2;
+        case '+': case '-':
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * -O: rewrites the instruction into one that does the same in fewer bytes,
+ * the way the GNU assembler does at the same level. Returns the mnemonic to
+ * use.
+ */
+const char *optimize_insn(elf64_obj_t *obj, const char *mnemonic,
+                          arg_t *args, int count, int *size)
+{
+    arg_t *dst;
+    int64_t imm;
+
+    if (count >= 2 && ((args[0].type == ARG_REG && args[0].kind >= REG_XMM)
+                       || (args[count - 1].type == ARG_REG
+                           && args[count - 1].kind >= REG_XMM))) {
+        return optimize_vector(obj, mnemonic, args, count);
+    }
+    if (count != 2 || args[1].type != ARG_REG || args[1].kind != REG_GPR) {
+        return mnemonic;
+    }
+    dst = &(args[1]);
+
+    if (!strcmp(mnemonic, "lea") && args[0].type == ARG_MEM
+        && !args[0].rip) {
+        arg_t *src;
+        int reg;
+
+        /* only the low bits of the address are kept, 0x67 changes none */
+        src = &(args[0]);
+        if (src->addr32 && dst->size < 8) {
+            src->addr32 = 0;
+        }
+
+        /* lea disp, %r -> mov $disp, %r */
+        if (src->base < 0 && src->index < 0) {
+            src->type = ARG_IMM;
+            src->segment = 0;
+            mnemonic = "mov";
+        }
+        /* lea (%base), %r or lea (, %index, 1), %r -> mov %base, %r */
+        else if (expr_constant(&(src->value)) && !src->value.value
+                 && (src->base < 0 || src->index < 0) && src->scale == 1) {
+            reg = src->base >= 0 ? src->base : src->index;
+            if (src->addr32) {
+                dst->size = *size = 4;
+            }
+            *src = (arg_t){ .type = ARG_REG, .kind = REG_GPR, .reg = reg,
+                            .size = dst->size, .base = -1, .index = -1,
+                            .scale = 1 };
+            return "mov";
+        }
+        else {
+            return mnemonic;
+        }
+    }
+
+    if (args[0].type == ARG_IMM && expr_constant(&(args[0].value))) {
+        imm = args[0].value.value;
+
+        /* -Os: test $imm7, %r16/%r32/%r64 -> test $imm7, %r8 */
+        if (obj->options->optimize_space && !strcmp(mnemonic, "test")
+            && imm >= 0 && imm <= 0x7F && dst->size > 1) {
+            dst->rex = dst->reg >= 4 && dst->reg < 8;
+            dst->size = *size = 1;
+        }
+        /*
+         * movq $imm32, %r64 -> movl $imm32, %r32, which zero extends.
+         * andq and testq with a positive imm32 leave the upper half clear
+         * and the flags the same in 32 bits.
+         */
+        else if (dst->size == 8
+                 && ((!strcmp(mnemonic, "mov") && imm >= 0
+                      && imm <= UINT32_MAX)
+                     || ((!strcmp(mnemonic, "and")
+                          || !strcmp(mnemonic, "test"))
+                         && imm >= 0 && imm <= INT32_MAX))) {
+            dst->size = *size = 4;
+        }
+        return mnemonic;
+    }
+
+    if (args[0].type != ARG_REG || args[0].kind != REG_GPR
+        || args[0].reg != dst->reg || args[0].size != dst->size
+        || args[0].high != dst->high) {
+        return mnemonic;
+    }
+
+    /* xorq %r64, %r64 and subq %r64, %r64 -> xorl %r32, %r32 */
+    if (dst->size == 8
+        && (!strcmp(mnemonic, "xor") || !strcmp(mnemonic, "sub"))) {
+        args[0].size = dst->size = *size = 4;
+    }
+    /*
+     * -O2: and/or %r, %r -> test %r, %r, which doesn't write the register.
+     * It is no shorter, so not with -Os. In 32 bits the write clears the
+     * upper half, so those stay.
+     */
+    else if (obj->options->optimize > 1 && !obj->options->optimize_space
+             && dst->size != 4
+             && (!strcmp(mnemonic, "and") || !strcmp(mnemonic, "or"))) {
+        return "test";
+    }
+
+    return mnemonic;
+}
+
+/*
+ * -O for the vector and mask registers. An instruction that zeroes its
+ * destination only needs to write the low 128 bits, VEX clears the rest, and
+ * EVEX forms that have the same VEX form are a byte or two shorter in it.
+ */
+const char *optimize_vector(elf64_obj_t *obj, const char *mnemonic,
+                            arg_t *args, int count)
+{
+    static const char *const zeroing[] = {
+        "vandnpd", "vandnps", "vpandn", "vpandnd", "vpandnq", "vpsubb",
+        "vpsubd", "vpsubq", "vpsubw", "vpxor", "vpxord", "vpxorq", "vxorpd",
+        "vxorps"
+    };
+    static const char *const vex[][2] = {
+        { "vmovdqa32", "vmovdqa" }, { "vmovdqa64", "vmovdqa" },
+        { "vmovdqu8", "vmovdqu" },  { "vmovdqu16", "vmovdqu" },
+        { "vmovdqu32", "vmovdqu" }, { "vmovdqu64", "vmovdqu" },
+        { "vpandd", "vpand" },      { "vpandq", "vpand" },
+        { "vpandnd", "vpandn" },    { "vpandnq", "vpandn" },
+        { "vpord", "vpor" },        { "vporq", "vpor" },
+        { "vpxord", "vpxor" },      { "vpxorq", "vpxor" }
+    };
+    static const char *const commutative[] = {
+        "vandpd", "vandps", "vorpd", "vorps", "vpaddb", "vpaddd", "vpaddq",
+        "vpaddsb", "vpaddsw", "vpaddusb", "vpaddusw", "vpaddw", "vpand",
+        "vpavgb", "vpavgw", "vpcmpeqb", "vpcmpeqd", "vpcmpeqw", "vpmaddwd",
+        "vpmaxsw", "vpmaxub", "vpminsw", "vpminub", "vpmulhuw", "vpmulhw",
+        "vpmullw", "vpmuludq", "vpor", "vpsadbw", "vpxor", "vxorpd", "vxorps"
+    };
+    const char *to;
+    arg_t *dst;
+    int64_t disp;
+    size_t n;
+    int same, size;
+
+    dst = &(args[count - 1]);
+
+    /* the same register twice gives zero whatever the other value */
+    same = count == 3 && dst->type == ARG_REG && args[0].type == ARG_REG
+           && args[1].type == ARG_REG && args[0].kind == dst->kind
+           && args[1].kind == dst->kind && args[0].reg == args[1].reg;
+
+    /* kxord/kxorq/kandnd/kandnq %k, %k, %k -> kxorw/kandnw */
+    if (same && dst->kind == REG_K) {
+        if (!strcmp(mnemonic, "kxord") || !strcmp(mnemonic, "kxorq")) {
+            return "kxorw";
+        }
+        if (!strcmp(mnemonic, "kandnd") || !strcmp(mnemonic, "kandnq")) {
+            return "kandnw";
+        }
+        return mnemonic;
+    }
+
+    for (n = 0; n < sizeof(zeroing) / sizeof(zeroing[0]); n++) {
+        if (!strcmp(mnemonic, zeroing[n])) {
+            break;
+        }
+    }
+    if (same && n < sizeof(zeroing) / sizeof(zeroing[0])
+        && (dst->kind == REG_YMM || dst->kind == REG_ZMM)
+        && (!dst->mask || dst->zeroing)) {
+        /* vpxor %ymm, %ymm, %ymm and EVEX %zmm -> VEX %xmm, without a mask */
+        if (args[0].reg < 16 && dst->reg < 16) {
+            dst->mask = dst->zeroing = 0;
+            if (!strncmp(mnemonic, "vpxor", 5)) {
+                mnemonic = "vpxor";
+            }
+            else if (!strncmp(mnemonic, "vpandn", 6)) {
+                mnemonic = "vpandn";
+            }
+        }
+        /* -O2: EVEX %ymm16-31 -> EVEX %xmm16-31 */
+        else if (obj->options->optimize < 2 || dst->kind != REG_YMM) {
+            return mnemonic;
+        }
+        for (int i = 0; i < 3; i++) {
+            args[i].kind = REG_XMM;
+            args[i].size = 16;
+        }
+        return mnemonic;
+    }
+
+    /*
+     * EVEX vmovdqa32/64, vmovdqu8-64 and vpand/vpandn/vpor/vpxor{d,q} on
+     * %xmm0-15 or %ymm0-15, unmasked -> their VEX forms
+     */
+    to = NULL;
+    for (n = 0; n < sizeof(vex) / sizeof(vex[0]); n++) {
+        if (!strcmp(mnemonic, vex[n][0])) {
+            to = vex[n][1];
+        }
+    }
+    size = 16;
+    for (int i = 0; to && i < count; i++) {
+        if (args[i].type == ARG_REG && (args[i].kind == REG_XMM
+                                        || args[i].kind == REG_YMM)
+            && args[i].reg < 16 && !args[i].mask) {
+            size = args[i].size;
+        }
+        else if (args[i].type != ARG_MEM || args[i].broadcast) {
+            to = NULL;
+        }
+    }
+    /* not when EVEX scales the displacement into a disp8 and VEX can't */
+    for (int i = 0; to && i < count; i++) {
+        if (args[i].type == ARG_MEM && expr_constant(&(args[i].value))) {
+            disp = args[i].value.value;
+            if ((disp < INT8_MIN || disp > INT8_MAX) && disp % size == 0
+                && disp / size >= INT8_MIN && disp / size <= INT8_MAX) {
+                to = NULL;
+            }
+        }
+    }
+    if (to) {
+        mnemonic = to;
+    }
+
+    /*
+     * -O2: vpand %xmm8, %xmm1, %xmm2 -> vpand %xmm1, %xmm8, %xmm2, the
+     * sources swapped so that none needs VEX.B and the 2-byte VEX will do
+     */
+    for (n = 0; n < sizeof(commutative) / sizeof(commutative[0]); n++) {
+        if (!strcmp(mnemonic, commutative[n])) {
+            break;
+        }
+    }
+    if (obj->options->optimize > 1
+        && n < sizeof(commutative) / sizeof(commutative[0]) && count == 3
+        && dst->type == ARG_REG && !dst->mask
+        && (dst->kind == REG_XMM || dst->kind == REG_YMM)
+        && args[0].type == ARG_REG && args[0].kind == dst->kind
+        && args[1].type == ARG_REG && args[1].kind == dst->kind
+        && args[0].reg >= 8 && args[0].reg < 16 && args[1].reg < 8
+        && dst->reg < 8) {
+        arg_t swap;
+
+        swap = args[0];
+        args[0] = args[1];
+        args[1] = swap;
+    }
+    return mnemonic;
+}
+
+/*
+ * --symbol-ordering-file: lays out the functions of each text section in
+ * the listed order, then the others in source order, with the `.cold` parts
+ * GCC splits off at the end. The functions were parsed into sections of
+ * their own, here they are put back together. With -ffunction-sections they
+ * stay apart and only the section table is ordered, the linker keeps that
+ * order within each output section.
+ */
+int order_functions(elf64_obj_t *obj)
+{
+    section_t *sections, *sec, *out;
+    line_t *lines;
+    size_t *rank, *order, *where, *frag_shift, *first;
+    uint64_t *shift;
+    size_t n, count, family, other, pad, j;
+    const char *name, *cold;
+
+    if (!obj->options->order_count) {
+        return 0;
+    }
+
+    /*
+     * A listed function ranks by its place in the list, everything else
+     * by its place in the source. Functions that fall through into each
+     * other share a section, which ranks by the first of them listed.
+     */
+    n = obj->section_count;
+    rank = malloc(n * sizeof(size_t));
+    order = malloc(n * sizeof(size_t));
+    for (size_t i = 1; i < n; i++) {
+        rank[i] = obj->options->order_count + i;
+    }
+    for (size_t i = 0; i < obj->sym_count; i++) {
+        size_t index = obj->syms[i].sym.st_shndx;
+
+        if (!obj->syms[i].defined || !index || index >= n
+            || !obj->sections[index].base) {
+            continue;
+        }
+        for (size_t j = 0; j < obj->options->order_count
+                           && j < rank[index]; j++) {
+            if (!strcmp(obj->syms[i].name, obj->options->order[j])) {
+                rank[index] = j;
+                break;
+            }
+        }
+    }
+    for (size_t i = 1; i < n; i++) {
+        sec = &(obj->sections[i]);
+        if (sec->base) {
+            name = sec->name + strlen(obj->sections[sec->base].name) + 1;
+            cold = strstr(name, ".cold");
+            if (rank[i] >= obj->options->order_count && cold
+                && (cold[5] == '\0' || cold[5] == '.')) {
+                rank[i] += n;
+            }
+        }
+
+        /* sorted by the section split from, then by rank */
+        family = sec->base ? sec->base : i;
+        for (j = i - 1; j > 0; j--) {
+            other = obj->sections[order[j - 1]].base
+                  ? obj->sections[order[j - 1]].base : order[j - 1];
+            if (other < family
+                || (other == family && rank[order[j - 1]] < rank[i])) {
+                break;
+            }
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+
+    sections = malloc(n * sizeof(section_t));
+    sections[0] = obj->sections[0];
+    where = calloc(n, sizeof(size_t));
+    shift = calloc(n, sizeof(uint64_t));
+    frag_shift = calloc(n, sizeof(size_t));
+    count = 1;
+    for (size_t i = 0; i < n - 1; i++) {
+        size_t index = order[i];
+
+        sec = &(obj->sections[index]);
+        family = sec->base ? sec->base : index;
+        if (obj->options->function_sections) {
+            where[index] = count;
+            sections[count++] = *sec;
+            continue;
+        }
+
+        /* every function is appended to the section it was split from */
+        other = i ? obj->sections[order[i - 1]].base : 0;
+        if (!i || (other ? other : order[i - 1]) != family) {
+            sections[count] = obj->sections[family];
+            sections[count].frags = NULL;
+            sections[count].frag_count = 0;
+            sections[count].size = 0;
+            sections[count].addralign = 1;
+            count++;
+        }
+        out = &(sections[count - 1]);
+
+        pad = -out->size & (sec->addralign - 1);
+        if (pad && out->type != SHT_NOBITS) {
+            frag_t *frag;
+
+            out->frags = realloc(out->frags,
+                                 (out->frag_count + 1) * sizeof(frag_t));
+            frag = &(out->frags[out->frag_count++]);
+            *frag = (frag_t){
+                .type = FRAG_DATA, .data = malloc(pad), .size = pad,
+                .capacity = pad
+            };
+            if (out->flags & SHF_EXECINSTR) {
+                fill_nops(frag->data, pad);
+            }
+            else {
+                memset(frag->data, 0, pad);
+            }
+        }
+        out->size += pad;
+        if (sec->addralign > out->addralign) {
+            out->addralign = sec->addralign;
+        }
+
+        where[index] = count - 1;
+        shift[index] = out->size;
+        frag_shift[index] = out->frag_count;
+        if (sec->frag_count) {
+            out->frags = realloc(out->frags, (out->frag_count + sec->frag_count)
+                                             * sizeof(frag_t));
+            memcpy(out->frags + out->frag_count, sec->frags,
+                   sec->frag_count * sizeof(frag_t));
+            out->frag_count += sec->frag_count;
+        }
+        out->size += sec->size;
+
+        free(sec->frags);
+        if (index != family) {
+            free(sec->name);
+        }
+    }
+
+    /* everything that points into a section moves along with it */
+    for (size_t i = 0; i < obj->sym_count; i++) {
+        Elf64_Sym *sym = &(obj->syms[i].sym);
+
+        if (obj->syms[i].defined && sym->st_shndx && sym->st_shndx < n) {
+            sym->st_value += shift[sym->st_shndx];
+            sym->st_shndx = where[sym->st_shndx];
+        }
+    }
+    for (size_t i = 0; i < obj->deferred_count; i++) {
+        deferred_t *deferred = &(obj->deferred[i]);
+
+        deferred->dot += shift[deferred->section];
+        deferred->section = where[deferred->section];
+    }
+    for (size_t i = 0; i < obj->fixup_count; i++) {
+        fixup_t *fixup = &(obj->fixups[i]);
+
+        fixup->frag += frag_shift[fixup->expr.section];
+        fixup->place += shift[fixup->expr.section];
+        fixup->expr.dot += shift[fixup->expr.section];
+        fixup->expr.section = where[fixup->expr.section];
+    }
+    for (size_t i = 0; i < obj->fde_count; i++) {
+        fde_t *fde = &(obj->fdes[i]);
+
+        fde->start += shift[fde->section];
+        fde->end += shift[fde->section];
+        for (size_t j = 0; j < fde->row_count; j++) {
+            fde->rows[j].loc += shift[fde->section];
+        }
+        fde->section = where[fde->section];
+    }
+    for (size_t i = 1; i < count; i++) {
+        sections[i].base = where[sections[i].base];
+    }
+
+    /* the line rows are grouped the way their sections were laid out */
+    first = calloc(n, sizeof(size_t));
+    for (size_t i = 0; i < obj->line_count; i++) {
+        first[obj->lines[i].section]++;
+    }
+    for (size_t i = 0, start = 0; i < n - 1; i++) {
+        size_t rows = first[order[i]];
+
+        first[order[i]] = start;
+        start += rows;
+    }
+    lines = malloc(obj->line_count * sizeof(line_t));
+    for (size_t i = 0; i < obj->line_count; i++) {
+        line_t *row = &(obj->lines[i]);
+
+        lines[first[row->section]++] = (line_t){
+            .section = where[row->section], .loc = row->loc + shift[row->section],
+            .file = row->file, .line = row->line, .column = row->column,
+            .isa = row->isa, .discriminator = row->discriminator,
+            .flags = row->flags
+        };
+    }
+    free(obj->lines);
+    obj->lines = lines;
+
+    obj->section = where[obj->section];
+    obj->previous = where[obj->previous];
+    obj->section_depth = 0;
+    obj->pad_section = 0;
+
+    free(obj->sections);
+    obj->sections = sections;
+    obj->section_count = count;
+
+    free(first);
+    free(frag_shift);
+    free(shift);
+    free(where);
+    free(order);
+    free(rank);
+    return 0;
+}
+
+/* Like parse_expression, for places that need a plain number. */
+int parse_absolute(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                   int64_t *value)
+{
+    expr_t expr;
+
+    if (parse_expression(unit, obj, token, &expr)) {
+        return 1;
+    }
+    if (expr.pending) {
+        fprintf(stderr, "Error: expression uses symbols that are not defined yet.\n");
+        return 1;
+    }
+    if (expr.section || expr.sym || expr.minus) {
+        fprintf(stderr, "Error: expected an absolute expression.\n");
+        return 1;
+    }
+
+    *value = expr.value;
+    return 0;
+}
+
+/*
+ * .balign/.align align[, fill[, max]] and .p2align with `power` set, where
+ * the alignment is given as a power of 2.
+ */
+int parse_align(unit_t *unit, elf64_obj_t *obj, int power)
+{
+    token_t token;
+    int64_t args[3];
+    int nargs;
+
+    args[1] = -1;
+    args[2] = 0;
+
+    if (lex(unit, &token)) {
+        return 1;
+    }
+    for (nargs = 0; nargs < 3; nargs++) {
+        /* the fill may be left out, `.p2align 4,,10` */
+        if (!(nargs == 1 && token.type == COMMA)
+            && parse_absolute(unit, obj, &token, &(args[nargs]))) {
+            return 1;
+        }
+        if (token.type != COMMA) {
+            break;
+        }
+        if (lex(unit, &token)) {
+            return 1;
+        }
+    }
+
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after alignment.\n");
+        return 1;
+    }
+    if (args[0] < 0 || (power && args[0] > 63)) {
+        fprintf(stderr, "Error: invalid alignment %ld.\n", args[0]);
+        return 1;
+    }
+
+    return emit_align(obj, power ? (uint64_t)1 << args[0] : args[0],
+                      args[1], args[2]);
+}
+
+/*
+ * An AT&T operand: `$imm`, `%reg`, or memory as `%seg:disp(%base, %index,
+ * scale)` with any of its parts left out. A `*` marks the target of an
+ * indirect jump or call.
+ */
+int parse_arg(unit_t *unit, elf64_obj_t *obj, token_t *token, arg_t *arg)
+{
+    static const uint8_t segments[6] = { 0x26, 0x2E, 0x36, 0x3E, 0x64, 0x65 };
+    static const char *roundings[5] = {
+        "rn-sae", "rd-sae", "ru-sae", "rz-sae", "sae"
+    };
+    token_t next;
+    arg_t reg;
+    size_t i;
+
+    *arg = (arg_t){ .base = -1, .index = -1, .scale = 1 };
+
+    if (token->type == OPERATOR && unit->src[token->start] == '{') {
+        /* {rn-sae}, the rounding of an EVEX form, written as an operand */
+        for (int j = 0; j < 5; j++) {
+            size_t len = strlen(roundings[j]);
+
+            if (!strncmp(unit->src + unit->i, roundings[j], len)
+                && unit->src[unit->i + len] == '}') {
+                arg->type = ARG_ROUND;
+                arg->reg = j;
+                unit->i += len + 1;
+                return lex(unit, token);
+            }
+        }
+        fprintf(stderr, "Error: unknown rounding `%.*s`.\n",
+                (int)strcspn(unit->src + token->start, "\n"),
+                unit->src + token->start);
+        return 1;
+    }
+
+    if (token->type == OPERATOR && unit->src[token->start] == '*') {
+        arg->indirect = 1;
+        if (lex(unit, token)) {
+            return 1;
+        }
+    }
+
+    if (token->type == IMMEDIATE) {
+        arg->type = ARG_IMM;
+        if (lex(unit, token)) {
+            return 1;
+        }
+        arg->src = token->start;
+        return parse_expression(unit, obj, token, &(arg->value));
+    }
+
+    if (token->type == REGISTER) {
+        if (parse_register(unit, token, &reg)) {
+            return 1;
+        }
+        if (reg.kind != REG_SEG || unit->src[unit->i] != ':') {
+            if (reg.kind == REG_RIP) {
+                fprintf(stderr, "Error: `%%%.*s` can only be a base register.\n",
+                        token->len, unit->src + token->start);
+                return 1;
+            }
+            reg.indirect = arg->indirect;
+            *arg = reg;
+            if (lex(unit, token)) {
+                return 1;
+            }
+            return parse_decorators(unit, token, arg);
+        }
+
+        /* a segment override */
+        arg->segment = segments[reg.reg];
+        unit->i++;
+        if (lex(unit, token)) {
+            return 1;
+        }
+    }
+
+    arg->type = ARG_MEM;
+
+    /* a displacement, unless `(` starts the registers */
+    i = unit->i;
+    if (lex(unit, &next)) {
+        return 1;
+    }
+    unit->i = i;
+    if (token->type != OPERATOR || unit->src[token->start] != '('
+        || (next.type != REGISTER && next.type != COMMA)) {
+        arg->src = token->start;
+        if (parse_expression(unit, obj, token, &(arg->value))) {
+            return 1;
+        }
+        if (token->type != OPERATOR || unit->src[token->start] != '(') {
+            return parse_decorators(unit, token, arg);
+        }
+    }
+
+    if (lex(unit, token)) {
+        return 1;
+    }
+    if (token->type == REGISTER) {
+        if (parse_register(unit, token, &reg)) {
+            return 1;
+        }
+        if (reg.kind == REG_RIP) {
+            arg->rip = 1;
+        }
+        else if (reg.kind != REG_GPR || reg.size < 4) {
+            fprintf(stderr, "Error: `%%%.*s` is not a base register.\n",
+                    token->len, unit->src + token->start);
+            return 1;
+        }
+        else {
+            arg->base = reg.reg;
+        }
+        arg->addr32 = reg.size == 4;
+        if (lex(unit, token)) {
+            return 1;
+        }
+    }
+    if (token->type == COMMA) {
+        if (lex(unit, token)) {
+            return 1;
+        }
+        if (token->type == REGISTER) {
+            if (parse_register(unit, token, &reg)) {
+                return 1;
+            }
+            /* gathers and scatters index with a vector, VSIB */
+            if (reg.kind >= REG_XMM && reg.kind <= REG_ZMM && !arg->rip) {
+                arg->vsib = reg.kind;
+            }
+            else if (reg.kind != REG_GPR || reg.size < 4 || reg.reg == 4
+                     || arg->rip
+                     || (arg->base >= 0 && arg->addr32 != (reg.size == 4))) {
+                fprintf(stderr, "Error: `%%%.*s` is not an index register.\n",
+                        token->len, unit->src + token->start);
+                return 1;
+            }
+            else {
+                arg->addr32 = reg.size == 4;
+            }
+            arg->index = reg.reg;
+            if (lex(unit, token)) {
+                return 1;
+            }
+        }
+        if (token->type == COMMA) {
+            if (lex(unit, token)) {
+                return 1;
+            }
+            if (token->type != CONSTANT
+                || (token->value != 1 && token->value != 2
+                    && token->value != 4 && token->value != 8)) {
+                fprintf(stderr, "Error: the scale factor must be 1, 2, 4 or 8.\n");
+                return 1;
+            }
+            arg->scale = token->value;
+            if (lex(unit, token)) {
+                return 1;
+            }
+        }
+    }
+    if (token->type != OPERATOR || unit->src[token->start] != ')') {
+        fprintf(stderr, "Error: missing `)` after the address registers.\n");
+        return 1;
+    }
+
+    if (lex(unit, token)) {
+        return 1;
+    }
+    return parse_decorators(unit, token, arg);
+}
+
+int parse_binary(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                 expr_t *value, int level)
+{
+    expr_t rhs;
+    int64_t lhs_offset, rhs_offset;
+    size_t lhs_section, rhs_section;
+    int relocatable;
+    char op;
+
+    if (!level) {
+        return parse_operand(unit, obj, token, value);
+    }
+
+    if (parse_binary(unit, obj, token, value, level - 1)) {
+        return 1;
+    }
+
+    while (operator_level(unit, token) == level) {
+        op = unit->src[token->start];
+        if (token->type == REGISTER) {
+            op = '%';
+            unit->i = token->start;
+        }
+        if (lex(unit, token) || parse_binary(unit, obj, token, &rhs, level - 1)) {
+            return 1;
+        }
+
+        /* it is all worked out again once the symbols are defined */
+        if (value->pending || rhs.pending) {
+            value->pending = 1;
+            continue;
+        }
+
+        /*
+         * Relocatable values may only be offset, or subtracted from one
+         * another within the same section. Subtracting a location in another
+         * section makes the value pc-relative.
+         */
+        relocatable = value->section || value->sym || value->minus;
+        if (rhs.section || rhs.sym || rhs.minus) {
+            if (op == '+' && !relocatable) {
+                rhs.value += value->value;
+                *value = rhs;
+                continue;
+            }
+            if (value->reloc || rhs.reloc) {
+                fprintf(stderr, "Error: invalid operation `%c` on a `@` relocation.\n",
+                        op);
+                return 1;
+            }
+
+            lhs_section = expr_location(obj, value, &lhs_offset);
+            rhs_section = expr_location(obj, &rhs, &rhs_offset);
+            if (op == '-' && rhs_section && lhs_section == rhs_section) {
+                /* the distance may change until relax_branches is done */
+                if (!obj->evaluating
+                    && may_relax(obj, lhs_section, lhs_offset, rhs_offset)) {
+                    *value = (expr_t){ .pending = 1 };
+                    continue;
+                }
+                *value = (expr_t){ .value = lhs_offset - rhs_offset };
+                continue;
+            }
+            if (op == '-' && rhs_section && relocatable && !value->minus) {
+                value->minus = rhs_section;
+                value->value -= rhs_offset;
+                continue;
+            }
+
+            fprintf(stderr, "Error: invalid sections for operation `%c`.\n",
+                    op);
+            return 1;
+        }
+        if (relocatable && op != '+' && op != '-') {
+            fprintf(stderr, "Error: invalid sections for operation `%c`.\n",
+                    op);
+            return 1;
+        }
+
+        switch (op)
+        {
+            case '*': value->value *= rhs.value; break;
+            case '/':
+                if (!rhs.value) {
+                    fprintf(stderr, "Error: division by zero.\n");
+                    return 1;
+                }
+                value->value /= rhs.value;
+                break;
+            case '%':
+                if (!rhs.value) {
+                    fprintf(stderr, "Error: division by zero.\n");
+                    return 1;
+                }
+                value->value %= rhs.value;
+                break;
+            case '<': value->value = (uint64_t)value->value << (rhs.value & 63); break;
+            case '>': value->value = (uint64_t)value->value >> (rhs.value & 63); break;
+            case '|': value->value |= rhs.value; break;
+            case '&': value->value &= rhs.value; break;
+            case '^': value->value ^= rhs.value; break;
+            case '+': value->value += rhs.value; break;
+            case '-': value->value -= rhs.value; break;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * .globl/.weak/.local and the visibility directives, they take a comma
+ * separated list of symbols. A negative binding or visibility is left as is.
+ */
+int parse_binding(unit_t *unit, elf64_obj_t *obj, int binding,
+                  int visibility)
+{
+    token_t token;
+    symbol_t *sym;
+
+    do {
+        if (parse_symbol(unit, obj, &token, &sym)) {
+            return 1;
+        }
+
+        if (binding >= 0) {
+            sym->sym.st_info = ELF64_ST_INFO(binding,
+                                             ELF64_ST_TYPE(sym->sym.st_info));
+            sym->local = binding == STB_LOCAL;
+        }
+        if (visibility >= 0) {
+            sym->sym.st_other = (sym->sym.st_other & ~3) | visibility;
+        }
+    } while (token.type == COMMA);
+
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after symbol list.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * The .cfi_* directives. Each one becomes a row of DW_CFA_* instructions at
+ * the current location, the advances between rows are added by
+ * emit_eh_frame once the function is complete.
+ */
+int parse_cfi(unit_t *unit, elf64_obj_t *obj, const char *directive)
+{
+    token_t token;
+    fde_t *fde;
+    uint8_t insn[32];
+    uint64_t reg, reg2, loc;
+    int64_t offset;
+    size_t len;
+    int initial, flags;
+
+    if (lex(unit, &token)) {
+        return 1;
+    }
+
+    if (!strcmp(directive, ".cfi_sections")) {
+        obj->no_eh_frame = 1;
+        obj->debug_frame = 0;
+        while (token.type == DIRECTIVE) {
+            if (!strncmp(unit->src + token.start, ".eh_frame", token.len)) {
+                obj->no_eh_frame = 0;
+            }
+            else if (!strncmp(unit->src + token.start, ".debug_frame",
+                              token.len)) {
+                obj->debug_frame = 1;
+            }
+            else {
+                fprintf(stderr, "Error: bad .cfi_sections directive.\n");
+                return 1;
+            }
+            if (lex(unit, &token)) {
+                return 1;
+            }
+            if (token.type == COMMA && lex(unit, &token)) {
+                return 1;
+            }
+        }
+        goto END_OF_LINE;
+    }
+
+    if (!strcmp(directive, ".cfi_startproc")) {
+        if (obj->cfi_open) {
+            fprintf(stderr, "Error: previous CFI entry not closed (missing .cfi_endproc).\n");
+            return 1;
+        }
+
+        obj->fdes = realloc(obj->fdes, (obj->fde_count + 1) * sizeof(fde_t));
+        fde = &(obj->fdes[obj->fde_count++]);
+        *fde = (fde_t){
+            .section = obj->section, .start = obj->sections[obj->section].size,
+            .return_column = 16, .personality_encoding = 0xFF,
+            .lsda_encoding = 0xFF, .cfa_offset = 8
+        };
+        obj->cfi_open = 1;
+
+        /* unless `simple`, the CFA is %rsp + 8 with the return address below */
+        if (token.type == ID
+            && !strncmp(unit->src + token.start, "simple", token.len)) {
+            if (lex(unit, &token)) {
+                return 1;
+            }
+        }
+        else {
+            add_cfi_row(fde, fde->start,
+                        (uint8_t[]){ DW_CFA_def_cfa, 7, 8 }, 3, 1);
+            add_cfi_row(fde, fde->start,
+                        (uint8_t[]){ DW_CFA_offset | 16, 1 }, 2, 1);
+        }
+        goto END_OF_LINE;
+    }
+
+    if (!obj->cfi_open) {
+        fprintf(stderr, "Error: CFI instruction used without previous .cfi_startproc.\n");
+        return 1;
+    }
+    fde = &(obj->fdes[obj->fde_count - 1]);
+    if (obj->section != fde->section) {
+        fprintf(stderr, "Error: CFI instruction used outside the section of its .cfi_startproc.\n");
+        return 1;
+    }
+    loc = obj->sections[obj->section].size;
+    len = 0;
+    initial = 1;
+
+    if (!strcmp(directive, ".cfi_endproc")) {
+        fde->end = loc;
+        obj->cfi_open = 0;
+        free(fde->remembered);
+        fde->remembered = NULL;
+        fde->remembered_count = 0;
+    }
+    else if (!strcmp(directive, ".cfi_def_cfa")) {
+        if (parse_dwarf_register(unit, obj, &token, &reg)) {
+            return 1;
+        }
+        if (token.type != COMMA) {
+            fprintf(stderr, "Error: expected `,` after the register.\n");
+            return 1;
+        }
+        if (lex(unit, &token) || parse_absolute(unit, obj, &token, &offset)) {
+            return 1;
+        }
+        if (offset < 0) {
+            fprintf(stderr, "Error: negative CFA offset %ld.\n", offset);
+            return 1;
+        }
+        fde->cfa_offset = offset;
+        insn[len++] = DW_CFA_def_cfa;
+        len += encode_uleb128(insn + len, reg);
+        len += encode_uleb128(insn + len, offset);
+    }
+    else if (!strcmp(directive, ".cfi_def_cfa_register")) {
+        if (parse_dwarf_register(unit, obj, &token, &reg)) {
+            return 1;
+        }
+        insn[len++] = DW_CFA_def_cfa_register;
+        len += encode_uleb128(insn + len, reg);
+    }
+    else if (!strcmp(directive, ".cfi_def_cfa_offset")
+             || !strcmp(directive, ".cfi_adjust_cfa_offset")) {
+        if (parse_absolute(unit, obj, &token, &offset)) {
+            return 1;
+        }
+        if (directive[5] == 'a') {
+            offset += fde->cfa_offset;
+        }
+        if (offset < 0) {
+            fprintf(stderr, "Error: negative CFA offset %ld.\n", offset);
+            return 1;
+        }
+        fde->cfa_offset = offset;
+        insn[len++] = DW_CFA_def_cfa_offset;
+        len += encode_uleb128(insn + len, offset);
+    }
+    else if (!strcmp(directive, ".cfi_offset")
+             || !strcmp(directive, ".cfi_rel_offset")
+             || !strcmp(directive, ".cfi_val_offset")) {
+        if (parse_dwarf_register(unit, obj, &token, &reg)) {
+            return 1;
+        }
+        if (token.type != COMMA) {
+            fprintf(stderr, "Error: expected `,` after the register.\n");
+            return 1;
+        }
+        if (lex(unit, &token) || parse_absolute(unit, obj, &token, &offset)) {
+            return 1;
+        }
+
+        /* .cfi_rel_offset is relative to the CFA register, not the CFA */
+        if (directive[5] == 'r') {
+            offset -= fde->cfa_offset;
+        }
+        if (offset % 8) {
+            fprintf(stderr, "Error: CFA offset %ld is not a multiple of 8.\n",
+                    offset);
+            return 1;
+        }
+        offset /= -8;
+
+        if (directive[5] == 'v') {
+            insn[len++] = offset >= 0 ? DW_CFA_val_offset : DW_CFA_val_offset_sf;
+            len += encode_uleb128(insn + len, reg);
+        }
+        else if (reg < 64 && offset >= 0) {
+            insn[len++] = DW_CFA_offset | reg;
+        }
+        else {
+            insn[len++] = DW_CFA_offset_extended_sf;
+            len += encode_uleb128(insn + len, reg);
+        }
+        if (offset >= 0) {
+            len += encode_uleb128(insn + len, offset);
+        }
+        else {
+            len += encode_sleb128(insn + len, offset);
+        }
+    }
+    else if (!strcmp(directive, ".cfi_restore")
+             || !strcmp(directive, ".cfi_undefined")
+             || !strcmp(directive, ".cfi_same_value")) {
+        if (parse_dwarf_register(unit, obj, &token, &reg)) {
+            return 1;
+        }
+        if (directive[5] == 'u') {
+            insn[len++] = DW_CFA_undefined;
+        }
+        else if (directive[5] == 's') {
+            insn[len++] = DW_CFA_same_value;
+        }
+        else if (reg < 64) {
+            insn[len++] = DW_CFA_restore | reg;
+            goto ROW;
+        }
+        else {
+            insn[len++] = DW_CFA_restore_extended;
+        }
+        len += encode_uleb128(insn + len, reg);
+    }
+    else if (!strcmp(directive, ".cfi_register")) {
+        if (parse_dwarf_register(unit, obj, &token, &reg)) {
+            return 1;
+        }
+        if (token.type != COMMA) {
+            fprintf(stderr, "Error: expected `,` after the register.\n");
+            return 1;
+        }
+        if (lex(unit, &token)
+            || parse_dwarf_register(unit, obj, &token, &reg2)) {
+            return 1;
+        }
+        insn[len++] = DW_CFA_register;
+        len += encode_uleb128(insn + len, reg);
+        len += encode_uleb128(insn + len, reg2);
+    }
+    else if (!strcmp(directive, ".cfi_remember_state")) {
+        fde->remembered = realloc(fde->remembered,
+                                  (fde->remembered_count + 1) * sizeof(int64_t));
+        fde->remembered[fde->remembered_count++] = fde->cfa_offset;
+        insn[len++] = DW_CFA_remember_state;
+        initial = 0;
+    }
+    else if (!strcmp(directive, ".cfi_restore_state")) {
+        if (!fde->remembered_count) {
+            fprintf(stderr, "Error: .cfi_restore_state without previous .cfi_remember_state.\n");
+            return 1;
+        }
+        fde->cfa_offset = fde->remembered[--fde->remembered_count];
+        insn[len++] = DW_CFA_restore_state;
+    }
+    else if (!strcmp(directive, ".cfi_escape")) {
+        do {
+            if (len && lex(unit, &token)) {
+                return 1;
+            }
+            if (parse_absolute(unit, obj, &token, &offset)) {
+                return 1;
+            }
+            if (len == sizeof(insn)) {
+                add_cfi_row(fde, loc, insn, len, 0);
+                len = 0;
+            }
+            insn[len++] = offset;
+        } while (token.type == COMMA);
+        initial = 0;
+    }
+    else if (!strcmp(directive, ".cfi_signal_frame")) {
+        fde->signal_frame = 1;
+    }
+    else if (!strcmp(directive, ".cfi_return_column")) {
+        if (parse_dwarf_register(unit, obj, &token, &fde->return_column)) {
+            return 1;
+        }
+    }
+    else if (!strcmp(directive, ".cfi_personality")
+             || !strcmp(directive, ".cfi_lsda")) {
+        symbol_t *sym;
+        size_t src;
+        expr_t value;
+
+        if (parse_absolute(unit, obj, &token, &offset)) {
+            return 1;
+        }
+        if (offset != 0xFF && !eh_pointer_size(offset, &flags)) {
+            fprintf(stderr, "Error: invalid or unsupported encoding in %s.\n",
+                    directive);
+            return 1;
+        }
+
+        if (directive[5] == 'p') {
+            fde->personality_encoding = offset;
+            fde->personality = 0;
+        }
+        else {
+            fde->lsda_encoding = offset;
+        }
+        if (offset == 0xFF) {
+            goto END_OF_LINE;
+        }
+
+        if (token.type != COMMA) {
+            fprintf(stderr, "Error: %s expected a symbol.\n", directive);
+            return 1;
+        }
+        src = unit->i;
+        if (directive[5] == 'p') {
+            if (parse_symbol(unit, obj, &token, &sym)) {
+                return 1;
+            }
+            fde->personality = sym - obj->syms + 1;
+            fde->personality_src = src;
+        }
+        else {
+            if (lex(unit, &token)
+                || parse_expression(unit, obj, &token, &value)) {
+                return 1;
+            }
+            fde->lsda_src = src;
+        }
+    }
+    else {
+        fprintf(stderr, "Error: unknown pseudo-op: `%s`\n", directive);
+        return 1;
+    }
+
+ROW:
+    if (len) {
+        add_cfi_row(fde, loc, insn, len, initial);
+    }
+
+END_OF_LINE:
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after %s.\n", directive);
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * .comm sym, size[, align] declares a common symbol, .lcomm reserves the
+ * space in .bss instead. Without an alignment the size rounded up to a
+ * power of 2 is used, up to 16 bytes.
+ */
+int parse_comm(unit_t *unit, elf64_obj_t *obj, int local)
+{
+    token_t token;
+    symbol_t *sym;
+    section_t *bss;
+    int64_t size, align;
+    size_t bss_index, offset;
+
+    if (parse_symbol(unit, obj, &token, &sym)) {
+        return 1;
+    }
+    if (token.type != COMMA) {
+        fprintf(stderr, "Error: expected a size for `%s`.\n", sym->name);
+        return 1;
+    }
+    if (lex(unit, &token) || parse_absolute(unit, obj, &token, &size)) {
+        return 1;
+    }
+
+    align = 0;
+    if (token.type == COMMA) {
+        if (lex(unit, &token) || parse_absolute(unit, obj, &token, &align)) {
+            return 1;
+        }
+    }
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after common symbol.\n");
+        return 1;
+    }
+
+    if (size < 0) {
+        fprintf(stderr, "Error: negative size for `%s`.\n", sym->name);
+        return 1;
+    }
+    if (align < 0 || (align & (align - 1))) {
+        fprintf(stderr, "Error: alignment %ld is not a power of 2.\n", align);
+        return 1;
+    }
+    if (!align) {
+        for (align = 1; align < size && align < 16; align <<= 1)
+            ;
+    }
+    if (sym->defined) {
+        fprintf(stderr, "Error: symbol `%s` is already defined.\n", sym->name);
+        return 1;
+    }
+
+    sym->defined = 1;
+    sym->sym.st_size = size;
+
+    /* `.local sym` followed by `.comm sym` is an .lcomm */
+    if (!local && !sym->local) {
+        if (ELF64_ST_BIND(sym->sym.st_info) == STB_WEAK) {
+            fprintf(stderr, "Error: symbol `%s` can not be both weak and common.\n",
+                    sym->name);
+            return 1;
+        }
+        sym->sym.st_info = ELF64_ST_INFO(STB_GLOBAL, STT_OBJECT);
+        sym->sym.st_shndx = SHN_COMMON;
+        sym->sym.st_value = align;
+        return 0;
+    }
+
+    /* the reservation is pure size bookkeeping, .bss has no contents */
+    bss_index = find_section(obj, ".bss");
+    bss = &(obj->sections[bss_index]);
+    offset = (bss->size + align - 1) & ~(align - 1);
+    bss->size = offset + size;
+    if (align > bss->addralign) {
+        bss->addralign = align;
+    }
+
+    sym->sym.st_info = ELF64_ST_INFO(ELF64_ST_BIND(sym->sym.st_info),
+                                     STT_OBJECT);
+    sym->sym.st_shndx = bss_index;
+    sym->sym.st_value = offset;
+    return 0;
+}
+
+/* .byte/.word/.long/.quad and their aliases, `size` bytes per value */
+int parse_data(unit_t *unit, elf64_obj_t *obj, int size)
+{
+    token_t token;
+    section_t *sec;
+    expr_t value;
+    uint64_t dot;
+    uint8_t *p;
+    size_t src;
+
+    sec = &(obj->sections[obj->section]);
+
+    do {
+        src = unit->i;
+        dot = sec->size;
+        if (lex(unit, &token) || parse_expression(unit, obj, &token, &value)) {
+            return 1;
+        }
+        if (sec->type == SHT_NOBITS) {
+            fprintf(stderr, "Error: attempt to store data in section `%s`.\n",
+                    sec->name);
+            return 1;
+        }
+
+        p = reserve_bytes(obj, size);
+        if (value.pending || value.section || value.sym || value.minus) {
+            memset(p, 0, size);
+            add_fixup(obj, src, dot, size, 0, 0);
+        }
+        else {
+            for (int i = 0; i < size; i++) {
+                p[i] = (uint64_t)value.value >> (i * 8);
+            }
+        }
+    } while (token.type == COMMA);
+
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after data.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * The AVX-512 decorators after an operand: `{%k1}` for the write mask, `{z}`
+ * to zero the elements it leaves out, and `{1to16}` to broadcast one element
+ * from memory.
+ */
+int parse_decorators(unit_t *unit, token_t *token, arg_t *arg)
+{
+    const char *s;
+    char *end;
+    size_t len;
+    long count;
+
+    while (token->type == OPERATOR && unit->src[token->start] == '{') {
+        s = unit->src + unit->i;
+        len = strcspn(s, "}\n");
+        if (s[len] != '}') {
+            fprintf(stderr, "Error: missing `}` after `{%.*s`.\n", (int)len, s);
+            return 1;
+        }
+
+        if (len == 3 && s[0] == '%' && tolower(s[1]) == 'k' && s[2] >= '0'
+            && s[2] <= '7') {
+            arg->mask = s[2] - '0';
+            if (!arg->mask) {
+                fprintf(stderr, "Error: `%%k0` can't be used for write mask.\n");
+                return 1;
+            }
+        }
+        else if (len == 1 && s[0] == 'z') {
+            arg->zeroing = 1;
+        }
+        else if (len > 3 && !strncmp(s, "1to", 3) && arg->type == ARG_MEM
+                 && (count = strtol(s + 3, &end, 10), end == s + len)
+                 && (count == 2 || count == 4 || count == 8 || count == 16)) {
+            arg->broadcast = count;
+        }
+        else {
+            fprintf(stderr, "Error: unknown vector operation `{%.*s}`.\n",
+                    (int)len, s);
+            return 1;
+        }
+
+        unit->i += len + 1;
+        if (lex(unit, token)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* A register by name, `%rbp`, or by its DWARF number. */
+int parse_dwarf_register(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                         uint64_t *reg)
+{
+    static const char *regs[17] = {
+        "rax", "rdx", "rcx", "rbx", "rsi", "rdi", "rbp", "rsp",
+        "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "rip"
+    };
+    const char *name;
+    int64_t value;
+    int n;
+
+    if (token->type != REGISTER) {
+        if (parse_absolute(unit, obj, token, &value)) {
+            return 1;
+        }
+        if (value < 0) {
+            fprintf(stderr, "Error: bad register number %ld.\n", value);
+            return 1;
+        }
+        *reg = value;
+        return 0;
+    }
+
+    name = unit->src + token->start;
+    for (int i = 0; i < 17; i++) {
+        if (token->len == strlen(regs[i]) && !strncmp(name, regs[i], token->len)) {
+            *reg = i;
+            return lex(unit, token);
+        }
+    }
+
+    /* %xmm0-15 are 17-32, %xmm16-31 are 67-82 */
+    if (token->len > 3 && token->len <= 5 && !strncmp(name, "xmm", 3)) {
+        n = 0;
+        for (int i = 3; i < token->len && isdigit(name[i]); i++) {
+            n = n * 10 + name[i] - '0';
+            if (i + 1 == token->len && n < 32) {
+                *reg = n < 16 ? 17 + n : 67 + n - 16;
+                return lex(unit, token);
+            }
+        }
+    }
+
+    fprintf(stderr, "Error: bad register `%%%.*s` in CFI directive.\n",
+            token->len, name);
+    return 1;
+}
+
+/*
+ * Parses an expression starting at `token`, leaving the first token after
+ * it in `token`.
+ */
+int parse_expression(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                     expr_t *value)
+{
+    return parse_binary(unit, obj, token, value, 3);
+}
+
+/*
+ * .file "name" names the source file in the symbol table, .file N ["dir"]
+ * "name" [md5 value] adds an entry to the line number program's file table.
+ */
+int parse_file(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    symbol_t *sym;
+    char *strings[2], *slash;
+    int64_t number;
+    size_t count, dir;
+
+    if (lex(unit, &token)) {
+        return 1;
+    }
+
+    if (token.type == STRING) {
+        obj->syms = realloc(obj->syms, (obj->sym_count + 1) * sizeof(symbol_t));
+        sym = &(obj->syms[obj->sym_count++]);
+        *sym = (symbol_t){
+            .name = malloc(token.len - 1), .defined = 1,
+            .sym = (Elf64_Sym){
+                .st_info = ELF64_ST_INFO(STB_LOCAL, STT_FILE),
+                .st_other = STV_DEFAULT, .st_shndx = SHN_ABS
+            }
+        };
+        sym->name[decode_string(unit->src + token.start + 1, token.len - 2,
+                                (uint8_t *)sym->name)] = '\0';
+
+        if (lex(unit, &token)) {
+            return 1;
+        }
+        goto END_OF_LINE;
+    }
+
+    if (parse_absolute(unit, obj, &token, &number)) {
+        return 1;
+    }
+    if (number < 0) {
+        fprintf(stderr, "Error: file number less than zero.\n");
+        return 1;
+    }
+
+    count = 0;
+    while (token.type == STRING && count < 2) {
+        strings[count] = malloc(token.len - 1);
+        strings[count][decode_string(unit->src + token.start + 1, token.len - 2,
+                                     (uint8_t *)strings[count])] = '\0';
+        count++;
+        if (lex(unit, &token)) {
+            goto FREE_STRINGS_ERROR;
+        }
+    }
+    if (!count) {
+        fprintf(stderr, "Error: .file expected a file name.\n");
+        return 1;
+    }
+
+    /* a path alone is split into a directory entry and its base name */
+    slash = strrchr(strings[0], '/');
+    if (count == 1 && number && slash && slash != strings[0]) {
+        strings[1] = strdup(slash + 1);
+        *slash = '\0';
+        count = 2;
+    }
+
+    /* the checksum is accepted, but not written */
+    if (token.type == ID && token_is(unit, &token, "md5")) {
+        while (token.type != NEWLINE && token.type != ENDOFFILE) {
+            if (lex(unit, &token)) {
+                goto FREE_STRINGS_ERROR;
+            }
+        }
+    }
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after .file.\n");
+        goto FREE_STRINGS_ERROR;
+    }
+
+    /* the compiler supplies its own line information, -g steps aside */
+    if (obj->gen_debug) {
+        for (size_t i = 0; i < obj->file_count; i++) {
+            free(obj->files[i].name);
+        }
+        free(obj->files);
+        obj->files = NULL;
+        obj->file_count = 0;
+        obj->line_count = 0;
+        obj->gen_debug = 0;
+    }
+
+    if (!obj->dir_count) {
+        obj->dir_count = 1;
+        obj->dirs = calloc(1, sizeof(char *));
+    }
+    dir = 0;
+    if (count == 2 && number == 0) {
+        free(obj->dirs[0]);
+        obj->dirs[0] = strings[0];
+    }
+    else if (count == 2) {
+        for (dir = 1; dir < obj->dir_count; dir++) {
+            if (!strcmp(obj->dirs[dir], strings[0])) {
+                break;
+            }
+        }
+        if (dir == obj->dir_count) {
+            obj->dirs = realloc(obj->dirs, (obj->dir_count + 1) * sizeof(char *));
+            obj->dirs[obj->dir_count++] = strings[0];
+        }
+        else {
+            free(strings[0]);
+        }
+    }
+
+    if (number >= obj->file_count) {
+        obj->files = realloc(obj->files, (number + 1) * sizeof(file_t));
+        memset(obj->files + obj->file_count, 0,
+               (number + 1 - obj->file_count) * sizeof(file_t));
+        obj->file_count = number + 1;
+    }
+    if (obj->files[number].name) {
+        fprintf(stderr, "Error: file number %ld already allocated.\n", number);
+        free(strings[count - 1]);
+        return 1;
+    }
+    obj->files[number] = (file_t){ .name = strings[count - 1], .dir = dir };
+    return 0;
+
+END_OF_LINE:
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after .file.\n");
+        return 1;
+    }
+    return 0;
+
+FREE_STRINGS_ERROR:
+    for (size_t i = 0; i < count; i++) {
+        free(strings[i]);
+    }
+    return 1;
+}
+
+/* .fill repeat[, size[, value]] or .skip/.space/.zero size[, value] */
+int parse_fill(unit_t *unit, elf64_obj_t *obj, int fill)
+{
+    token_t token;
+    int64_t args[3];
+    uint8_t pattern[8];
+    size_t nargs, size;
+
+    args[1] = fill ? 1 : 0;
+    args[2] = 0;
+
+    if (lex(unit, &token)) {
+        return 1;
+    }
+    for (nargs = 0; nargs < 3; nargs++) {
+        if (parse_absolute(unit, obj, &token, &(args[nargs]))) {
+            return 1;
+        }
+        if (token.type != COMMA) {
+            nargs++;
+            break;
+        }
+        if (lex(unit, &token)) {
+            return 1;
+        }
+    }
+
+    if ((token.type != NEWLINE && token.type != ENDOFFILE)
+        || (!fill && nargs > 2)) {
+        fprintf(stderr, "Error: junk at end of line after fill directive.\n");
+        return 1;
+    }
+    if (args[0] < 0) {
+        fprintf(stderr, "Error: negative repeat count %ld.\n", args[0]);
+        return 1;
+    }
+
+    if (!fill) {
+        pattern[0] = args[1];
+        return emit_fill(obj, pattern, 1, args[0]);
+    }
+
+    /*
+     * .fill writes the value as a 4 byte number whose higher order
+     * bytes are zero, truncated to at most 8 bytes.
+     */
+    if (args[1] <= 0) {
+        return 0;
+    }
+    size = args[1] > 8 ? 8 : args[1];
+    memset(pattern, 0, sizeof(pattern));
+    for (int i = 0; i < 4; i++) {
+        pattern[i] = (uint64_t)args[2] >> (i * 8);
+    }
+
+    return emit_fill(obj, pattern, size, args[0]);
+}
+
+/* .ident "string", kept in .comment after the empty string it starts with */
+int parse_ident(unit_t *unit, elf64_obj_t *obj)
+{
+    size_t section, comment;
+    int return_value;
+
+    section = obj->section;
+    comment = find_section(obj, ".comment");
+    if (!comment) {
+        comment = add_section(obj, ".comment", SHT_PROGBITS,
+                              SHF_MERGE | SHF_STRINGS);
+        obj->sections[comment].entsize = 1;
+        obj->section = comment;
+        *reserve_bytes(obj, 1) = 0;
+    }
+
+    obj->section = comment;
+    return_value = parse_strings(unit, obj, 1);
+    obj->section = section;
+    return return_value;
+}
+
+/*
+ * .incbin "file"[, skip[, count]]. The file is mapped rather than read, and
+ * recorded as a fragment that write_blob copies into the output.
+ */
+int parse_incbin(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    section_t *sec;
+    frag_t *frag;
+    struct stat filestat;
+    char *filename;
+    int64_t skip, count;
+    size_t delta;
+    uint8_t *map;
+    int fd;
+
+    sec = &(obj->sections[obj->section]);
+    skip = 0;
+    count = -1;
+
+    if (lex(unit, &token)) {
+        return 1;
+    }
+    if (token.type != STRING) {
+        fprintf(stderr, "Error: .incbin expected a file name.\n");
+        return 1;
+    }
+    filename = malloc(token.len - 1);
+    filename[decode_string(unit->src + token.start + 1, token.len - 2,
+                           (uint8_t *)filename)] = '\0';
+
+    if (lex(unit, &token)) {
+        goto FREE_FILENAME_ERROR;
+    }
+    if (token.type == COMMA) {
+        if (lex(unit, &token) || parse_absolute(unit, obj, &token, &skip)) {
+            goto FREE_FILENAME_ERROR;
+        }
+        if (token.type == COMMA) {
+            if (lex(unit, &token)
+                || parse_absolute(unit, obj, &token, &count)) {
+                goto FREE_FILENAME_ERROR;
+            }
+            if (count < 0) {
+                fprintf(stderr, "Error: .incbin count of %ld is negative.\n",
+                        count);
+                goto FREE_FILENAME_ERROR;
+            }
+        }
+    }
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after .incbin.\n");
+        goto FREE_FILENAME_ERROR;
+    }
+    if (sec->type == SHT_NOBITS) {
+        fprintf(stderr, "Error: attempt to store data in section `%s`.\n",
+                sec->name);
+        goto FREE_FILENAME_ERROR;
+    }
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open `%s`.\n", filename);
+        goto FREE_FILENAME_ERROR;
+    }
+    if (fstat(fd, &filestat)) {
+        fprintf(stderr, "Failed to stat `%s`.\n", filename);
+        goto CLOSE_FD_ERROR;
+    }
+
+    /* without a count, the rest of the file */
+    if (count < 0) {
+        count = filestat.st_size - skip;
+    }
+    if (skip < 0 || skip > filestat.st_size
+        || count > filestat.st_size - skip) {
+        fprintf(stderr, "Error: skip (%ld) or count (%ld) invalid for file size (%ld).\n",
+                skip, count, (long)filestat.st_size);
+        goto CLOSE_FD_ERROR;
+    }
+    if (!count) {
+        close(fd);
+        free(filename);
+        return 0;
+    }
+
+    /* mappings start on a page boundary */
+    delta = skip % sysconf(_SC_PAGESIZE);
+    map = mmap(NULL, count + delta, PROT_READ, MAP_PRIVATE, fd, skip - delta);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map `%s`.\n", filename);
+        goto CLOSE_FD_ERROR;
+    }
+
+    sec->frags = realloc(sec->frags, (sec->frag_count + 1) * sizeof(frag_t));
+    frag = &(sec->frags[sec->frag_count++]);
+    *frag = (frag_t){
+        .type = FRAG_FILE, .data = map + delta, .size = count, .fd = fd,
+        .offset = skip
+    };
+    sec->size += count;
+
+    free(filename);
+    return 0;
+
+CLOSE_FD_ERROR:
+    close(fd);
+FREE_FILENAME_ERROR:
+    free(filename);
+    return 1;
+}
+
+/*
+ * An instruction and its AT&T operands, encoded in the first form of the
+ * mnemonic that they fit, which the table lists shortest first.
+ */
+int parse_instruction(unit_t *unit, elf64_obj_t *obj, const char *mnemonic)
+{
+    static const struct {
+        const char *name;
+        int         byte;
+    } prefixes[] = {
+        { "lock", 0xF0 }, { "rep", 0xF3 }, { "repe", 0xF3 }, { "repz", 0xF3 },
+        { "repne", 0xF2 }, { "repnz", 0xF2 }
+    };
+    static const struct {
+        const char *name;
+        int         imm;
+    } clmuls[] = {
+        { "pclmullqlqdq", 0x00 }, { "pclmulhqlqdq", 0x01 },
+        { "pclmullqhqdq", 0x10 }, { "pclmulhqhqdq", 0x11 }
+    };
+    const insn_t **forms, **suffixed, *insn;
+    const char *prefix_name;
+    char name[32], prefixed[32];
+    token_t token;
+    arg_t args[4];
+    uint64_t dot;
+    int64_t target;
+    size_t count, suffixed_count, len;
+    int arg_count, size, vector, round, prefix, branch, implied;
+
+    if (lex(unit, &token)) {
+        return 1;
+    }
+
+    /* lock and rep apply to the instruction after them, alone they are just
+       the byte */
+    prefix = 0;
+    prefix_name = mnemonic;
+    for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+        if (token.type == ID && !strcmp(mnemonic, prefixes[i].name)) {
+            prefix = prefixes[i].byte;
+        }
+    }
+    if (prefix) {
+        if (token.len >= sizeof(prefixed)) {
+            fprintf(stderr, "Error: unknown instruction after `%s`.\n",
+                    prefix_name);
+            return 1;
+        }
+        for (size_t i = 0; i < token.len; i++) {
+            prefixed[i] = tolower(unit->src[token.start + i]);
+        }
+        prefixed[token.len] = '\0';
+        mnemonic = prefixed;
+        if (lex(unit, &token)) {
+            return 1;
+        }
+    }
+
+    /* pclmulqdq named after the quadwords it multiplies takes no imm8 */
+    implied = -1;
+    for (size_t i = 0; i < sizeof(clmuls) / sizeof(clmuls[0]); i++) {
+        if (!strcmp(mnemonic + (mnemonic[0] == 'v'), clmuls[i].name)) {
+            implied = clmuls[i].imm;
+            mnemonic = mnemonic[0] == 'v' ? "vpclmulqdq" : "pclmulqdq";
+        }
+    }
+
+    size = 0;
+    forms = find_insns(mnemonic, &count);
+    suffixed = NULL;
+    suffixed_count = 0;
+    len = strlen(mnemonic);
+    if (len > 1 && len < sizeof(name) && strchr("bwlq", mnemonic[len - 1])) {
+        /* the operand size suffix, `addl` */
+        memcpy(name, mnemonic, len - 1);
+        name[len - 1] = '\0';
+        suffixed = find_insns(name, &suffixed_count);
+    }
+    if (!count && !suffixed_count) {
+        fprintf(stderr, "Error: unknown instruction: `%s`\n", mnemonic);
+        return 1;
+    }
+    if (obj->sections[obj->section].type == SHT_NOBITS) {
+        fprintf(stderr, "Error: attempt to store data in section `%s`.\n",
+                obj->sections[obj->section].name);
+        return 1;
+    }
+
+    dot = obj->sections[obj->section].size;
+
+    arg_count = 0;
+    round = -1;
+    while (token.type != NEWLINE && token.type != ENDOFFILE) {
+        arg_t arg;
+
+        if (parse_arg(unit, obj, &token, &arg)) {
+            return 1;
+        }
+        /* the rounding is kept apart, it isn't an operand of the forms */
+        if (arg.type == ARG_ROUND && round >= 0) {
+            fprintf(stderr, "Error: more than one rounding for `%s`.\n",
+                    mnemonic);
+            return 1;
+        }
+        else if (arg.type == ARG_ROUND) {
+            round = arg.reg;
+        }
+        else if (arg_count == 4) {
+            fprintf(stderr, "Error: too many operands for `%s`.\n", mnemonic);
+            return 1;
+        }
+        else {
+            args[arg_count++] = arg;
+        }
+        if (token.type == COMMA) {
+            if (lex(unit, &token)) {
+                return 1;
+            }
+        }
+        else if (token.type != NEWLINE && token.type != ENDOFFILE) {
+            fprintf(stderr, "Error: junk at end of line after `%s`.\n",
+                    mnemonic);
+            return 1;
+        }
+    }
+
+    if (implied >= 0 && arg_count == 4) {
+        fprintf(stderr, "Error: too many operands for `%s`.\n", mnemonic);
+        return 1;
+    }
+    if (implied >= 0) {
+        memmove(args + 1, args, arg_count * sizeof(arg_t));
+        args[0] = (arg_t){ .type = ARG_IMM, .base = -1, .index = -1,
+                           .scale = 1, .value = { .value = implied } };
+        arg_count++;
+    }
+
+    /* only the destination, the last operand, is masked */
+    for (int i = 0; i < arg_count; i++) {
+        if ((args[i].mask || args[i].zeroing) && i != arg_count - 1) {
+            fprintf(stderr, "Error: only the destination of `%s` can be masked.\n",
+                    mnemonic);
+            return 1;
+        }
+        if (args[i].zeroing && !args[i].mask) {
+            fprintf(stderr, "Error: zeroing-masking only allowed with write mask.\n");
+            return 1;
+        }
+        if (args[i].zeroing && args[i].type == ARG_MEM) {
+            fprintf(stderr, "Error: unsupported masking for `%s`.\n",
+                    mnemonic);
+            return 1;
+        }
+    }
+
+    /* movq is also mov with a suffix, unless it moves a vector register */
+    vector = 0;
+    for (int i = 0; i < arg_count; i++) {
+        vector |= args[i].type == ARG_REG && args[i].kind >= REG_XMM
+                  && args[i].kind <= REG_ZMM;
+    }
+    if (suffixed_count && (!count || !vector)) {
+        size = 1 << (strchr("bwlq", mnemonic[len - 1]) - "bwlq");
+        forms = suffixed;
+        count = suffixed_count;
+    }
+
+    /* imul $imm, %reg is imul $imm, %reg, %reg */
+    if (!strcmp(forms[0]->mnemonic, "imul") && arg_count == 2
+        && args[0].type == ARG_IMM) {
+        args[arg_count++] = args[1];
+    }
+
+    if (obj->options->optimize) {
+        const char *optimized;
+
+        optimized = optimize_insn(obj, forms[0]->mnemonic, args, arg_count,
+                                  &size);
+        if (strcmp(optimized, forms[0]->mnemonic)) {
+            forms = find_insns(optimized, &count);
+        }
+    }
+
+    insn = match_insn(forms, count, args, arg_count, round, &size);
+    if (!insn) {
+        return 1;
+    }
+    if (prefix == 0xF0 && !lockable(insn, args, arg_count)) {
+        fprintf(stderr, "Error: expecting lockable instruction after `lock`.\n");
+        return 1;
+    }
+    if (prefix && prefix != 0xF0 && !repeatable(insn)) {
+        fprintf(stderr, "Error: invalid instruction `%s` after `%s`.\n",
+                insn->mnemonic, prefix_name);
+        return 1;
+    }
+
+    /* jmp and jcc, call and xbegin keep their rel32 */
+    branch = insn->operands[0] == OPERAND_REL32 && insn->opcode != 0xE8
+             && insn->opcode != 0xC7F8;
+
+    /* a jump back to a label in this section closes a loop */
+    if (obj->options->align_loops && branch
+        && expr_location(obj, &(args[0].value), &target) == obj->section
+        && target <= dot) {
+        obj->loop_heads = realloc(obj->loop_heads,
+                                  (obj->loop_head_count + 1) * sizeof(expr_t));
+        obj->loop_heads[obj->loop_head_count++] = (expr_t){
+            .value = target, .section = obj->section
+        };
+    }
+
+    if (encode_insn(obj, insn, args, prefix, round, size, dot)) {
+        return 1;
+    }
+
+    /* the code after them is only reached by a jump */
+    if (!strcmp(insn->mnemonic, "jmp") || !strcmp(insn->mnemonic, "ret")
+        || !strcmp(insn->mnemonic, "ud2")) {
+        obj->stop_section = obj->section;
+        obj->stop_end = obj->sections[obj->section].size;
+    }
+
+    /* jmp and jcc, made short by relax_branches when they can be */
+    if (branch) {
+        obj->branches = realloc(obj->branches, (obj->branch_count + 1)
+                                               * sizeof(branch_t));
+        obj->branches[obj->branch_count++] = (branch_t){
+            .fixup = obj->fixup_count - 1,
+            .opcode = insn->opcode == 0xE9 ? 0xEB : 0x70 | (insn->opcode & 0xF)
+        };
+    }
+
+    return 0;
+}
+
+/*
+ * .uleb128/.sleb128 expression[, ...]. A value that relaxation may still
+ * change takes a byte for now, size_leb128 gives it its length.
+ */
+int parse_leb128(unit_t *unit, elf64_obj_t *obj, int is_signed)
+{
+    token_t token;
+    section_t *sec;
+    expr_t value;
+    uint8_t bytes[10];
+    uint64_t dot;
+    size_t src, len;
+
+    sec = &(obj->sections[obj->section]);
+
+    do {
+        src = unit->i;
+        dot = sec->size;
+        if (lex(unit, &token) || parse_expression(unit, obj, &token, &value)) {
+            return 1;
+        }
+        if (sec->type == SHT_NOBITS) {
+            fprintf(stderr, "Error: attempt to store data in section `%s`.\n",
+                    sec->name);
+            return 1;
+        }
+
+        if (value.pending || value.section || value.sym || value.minus) {
+            *reserve_bytes(obj, 1) = 0;
+            add_fixup(obj, src, dot, 1,
+                      FIXUP_LEB128 | (is_signed ? FIXUP_SIGNED : 0), 0);
+        }
+        else {
+            len = is_signed ? encode_sleb128(bytes, value.value)
+                            : encode_uleb128(bytes, value.value);
+            emit_bytes(obj, bytes, len);
+        }
+    } while (token.type == COMMA);
+
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after data.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * .loc file line [column] [options], the row is added at the next
+ * instruction.
+ */
+int parse_loc(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    symbol_t *sym;
+    int64_t file, line, value;
+    uint64_t size;
+    const char *option;
+    char *name;
+
+    if (lex(unit, &token) || parse_absolute(unit, obj, &token, &file)
+        || parse_absolute(unit, obj, &token, &line)) {
+        return 1;
+    }
+    if (file < 0 || line < 0) {
+        fprintf(stderr, "Error: .loc expected a file number and a line.\n");
+        return 1;
+    }
+    if (file >= obj->file_count || !obj->files[file].name) {
+        fprintf(stderr, "Error: unassigned file number %ld.\n", file);
+        return 1;
+    }
+
+    /* two in a row, the first one still gets its row */
+    if (obj->loc_pending) {
+        add_line(unit, obj, unit->i);
+    }
+
+    obj->loc.file = file;
+    obj->loc.line = line;
+    obj->loc.column = 0;
+    obj->loc.discriminator = 0;
+    obj->loc_pending = 1;
+
+    /* the rows at one address are told apart by their view number */
+    size = obj->sections[obj->section].size;
+    if (obj->view_section == obj->section && obj->view_end == size) {
+        obj->view++;
+    }
+    else {
+        obj->view = 0;
+    }
+    obj->view_section = obj->section;
+    obj->view_end = size;
+
+    if (token.type == CONSTANT
+        && parse_absolute(unit, obj, &token, (int64_t *)&obj->loc.column)) {
+        return 1;
+    }
+
+    while (token.type == ID) {
+        if (token_is(unit, &token, "basic_block")) {
+            obj->loc.flags |= LINE_BASIC_BLOCK;
+        }
+        else if (token_is(unit, &token, "prologue_end")) {
+            obj->loc.flags |= LINE_PROLOGUE_END;
+        }
+        else if (token_is(unit, &token, "epilogue_begin")) {
+            obj->loc.flags |= LINE_EPILOGUE_BEGIN;
+        }
+        else if (token_is(unit, &token, "view")) {
+            expr_t view;
+
+            /* a new symbol is set to the view number, `-0` is only parsed */
+            if (lex(unit, &token)) {
+                return 1;
+            }
+            if (token.type == ID || token.type == DIRECTIVE) {
+                name = strndup(unit->src + token.start, token.len);
+                sym = get_symbol(obj, name);
+                free(name);
+                if (!sym->defined) {
+                    sym->defined = 1;
+                    sym->sym.st_shndx = SHN_ABS;
+                    sym->sym.st_value = obj->view;
+                    if (lex(unit, &token)) {
+                        return 1;
+                    }
+                    continue;
+                }
+            }
+            if (parse_expression(unit, obj, &token, &view)) {
+                return 1;
+            }
+            continue;
+        }
+        else if (token_is(unit, &token, "is_stmt")
+                 || token_is(unit, &token, "isa")
+                 || token_is(unit, &token, "discriminator")) {
+            option = unit->src + token.start;
+            if (lex(unit, &token) || parse_absolute(unit, obj, &token, &value)) {
+                return 1;
+            }
+            if (value < 0 || (option[2] == '_' && value > 1)) {
+                fprintf(stderr, "Error: bad value %ld in .loc.\n", value);
+                return 1;
+            }
+
+            if (option[2] == '_') {
+                obj->loc.flags = value ? obj->loc.flags | LINE_STMT
+                                       : obj->loc.flags & ~LINE_STMT;
+            }
+            else if (option[1] == 's') {
+                obj->loc.isa = value;
+            }
+            else {
+                obj->loc.discriminator = value;
+            }
+            continue;
+        }
+        else {
+            fprintf(stderr, "Error: unknown .loc sub-directive `%.*s`.\n",
+                    token.len, unit->src + token.start);
+            return 1;
+        }
+
+        if (lex(unit, &token)) {
+            return 1;
+        }
+    }
+
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after .loc.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+int parse_operand(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                  expr_t *value)
+{
+    symbol_t *sym;
+    char *name;
+    char op;
+
+    switch (token->type)
+    {
+        case CONSTANT:
+            *value = (expr_t){ .value = token->value };
+            return lex(unit, token);
+        case ID:
+        case DIRECTIVE:
+            if (token->len == 1 && unit->src[token->start] == '.') {
+                /* the current location */
+                if (obj->evaluating) {
+                    *value = (expr_t){ .value = obj->evaluating->dot,
+                                       .section = obj->evaluating->section };
+                }
+                else {
+                    *value = (expr_t){
+                        .value = obj->sections[obj->section].size,
+                        .section = obj->section
+                    };
+                }
+                return lex(unit, token);
+            }
+
+            name = malloc(token->len + 1);
+            memcpy(name, unit->src + token->start, token->len);
+            name[token->len] = '\0';
+            sym = get_symbol(obj, name);
+            free(name);
+
+            /*
+             * Local labels are section offsets. Anything the linker may
+             * resolve differently, like global, undefined or indirect
+             * function symbols, stays relative to the symbol itself.
+             */
+            if (!sym->defined) {
+                *value = (expr_t){ .sym = sym - obj->syms + 1,
+                                   .pending = !obj->evaluating };
+            }
+            else if (sym->sym.st_shndx == SHN_ABS) {
+                *value = (expr_t){ .value = sym->sym.st_value };
+            }
+            else if (ELF64_ST_BIND(sym->sym.st_info) == STB_LOCAL
+                     && ELF64_ST_TYPE(sym->sym.st_info) != STT_GNU_IFUNC
+                     && sym->sym.st_shndx != SHN_COMMON) {
+                *value = (expr_t){ .value = sym->sym.st_value,
+                                   .section = sym->sym.st_shndx };
+            }
+            else {
+                *value = (expr_t){ .sym = sym - obj->syms + 1 };
+            }
+            if (lex(unit, token)) {
+                return 1;
+            }
+
+            /*
+             * `foo@PLT` and `foo@GOTPCREL`, how the linker is to reach the
+             * symbol. The GOT entry is always the symbol's own.
+             */
+            if (token->type == ID && unit->src[token->start] == '@') {
+                if (token->len == 4
+                    && !strncasecmp(unit->src + token->start, "@PLT", 4)) {
+                    value->reloc = R_X86_64_PLT32;
+                }
+                else if (token->len == 9
+                         && !strncasecmp(unit->src + token->start,
+                                         "@GOTPCREL", 9)) {
+                    *value = (expr_t){ .sym = sym - obj->syms + 1,
+                                       .pending = value->pending,
+                                       .reloc = R_X86_64_GOTPCREL };
+                    get_symbol(obj, "_GLOBAL_OFFSET_TABLE_");
+                }
+                else {
+                    fprintf(stderr, "Error: unknown relocation `%.*s`.\n",
+                            token->len, unit->src + token->start);
+                    return 1;
+                }
+                return lex(unit, token);
+            }
+            return 0;
+        case OPERATOR:
+            op = unit->src[token->start];
+            if (lex(unit, token)) {
+                return 1;
+            }
+
+            if (op == '(') {
+                if (parse_expression(unit, obj, token, value)) {
+                    return 1;
+                }
+                if (token->type != OPERATOR || unit->src[token->start] != ')') {
+                    fprintf(stderr, "Error: missing `)`.\n");
+                    return 1;
+                }
+                return lex(unit, token);
+            }
+
+            if (parse_operand(unit, obj, token, value)) {
+                return 1;
+            }
+            if ((value->section || value->sym || value->minus) && op != '+') {
+                fprintf(stderr, "Error: invalid section for operation `%c`.\n",
+                        op);
+                return 1;
+            }
+            switch (op)
+            {
+                case '-': value->value = -value->value; return 0;
+                case '~': value->value = ~value->value; return 0;
+                case '!': value->value = !value->value; return 0;
+                case '+': return 0;
+            }
+            /* fallthrough */
+        default:
+            fprintf(stderr, "Error: expected an expression.\n");
+            return 1;
+    }
+}
+
+/* A register operand, its name after the `%` in `token`. */
+int parse_register(unit_t *unit, token_t *token, arg_t *arg)
+{
+    static const char *segments[6] = { "es", "cs", "ss", "ds", "fs", "gs" };
+    static const char *high[4] = { "ah", "ch", "dh", "bh" };
+    const char *name;
+    int len;
+
+    name = unit->src + token->start;
+    len = token->len;
+    *arg = (arg_t){ .type = ARG_REG, .kind = REG_GPR, .base = -1,
+                    .index = -1, .scale = 1 };
+
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 16; j++) {
+            if (strlen(gpr_names[i][j]) == len
+                && !strncasecmp(gpr_names[i][j], name, len)) {
+                arg->reg = j;
+                arg->size = 1 << i;
+                /* %spl, %bpl, %sil and %dil exist only with REX */
+                arg->rex = i == 0 && j >= 4 && j < 8;
+                return 0;
+            }
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        if (len == 2 && !strncasecmp(high[i], name, len)) {
+            arg->reg = i + 4;
+            arg->size = 1;
+            arg->high = 1;
+            return 0;
+        }
+    }
+    for (int i = 0; i < 6; i++) {
+        if (len == 2 && !strncasecmp(segments[i], name, len)) {
+            arg->kind = REG_SEG;
+            arg->reg = i;
+            return 0;
+        }
+    }
+    if (len == 3 && !strncasecmp("rip", name, len)) {
+        arg->kind = REG_RIP;
+        arg->size = 8;
+        return 0;
+    }
+    for (int i = 0; i < 96; i++) {
+        char vector[6];
+
+        sprintf(vector, "%cmm%d", "xyz"[i / 32], i & 31);
+        if (strlen(vector) == len && !strncasecmp(vector, name, len)) {
+            arg->kind = REG_XMM + i / 32;
+            arg->reg = i & 31;
+            arg->size = 16 << i / 32;
+            return 0;
+        }
+    }
+    if (len == 2 && tolower(name[0]) == 'k' && name[1] >= '0'
+        && name[1] <= '7') {
+        /* the AVX-512 mask registers */
+        arg->kind = REG_K;
+        arg->reg = name[1] - '0';
+        return 0;
+    }
+
+    fprintf(stderr, "Error: bad register name `%%%.*s`.\n", len, name);
+    return 1;
+}
+
+int parse_section(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    char *name;
+    uint32_t type;
+    uint64_t flags;
+    int64_t entsize;
+    size_t index;
+
+    entsize = 0;
+    if (lex(unit, &token)) {
+        return 1;
+    }
+    if (token.type != ID && token.type != DIRECTIVE && token.type != STRING) {
+        fprintf(stderr, "Error: .section directive expected a section name.\n");
+        return 1;
+    }
+
+    if (token.type == STRING) {
+        token.start++;
+        token.len -= 2;
+    }
+    else {
+        /* the name runs up to a comma or a space, like .note.GNU-stack */
+        token.len = strcspn(unit->src + token.start, " \t,;\n");
+        unit->i = token.start + token.len;
+    }
+    name = malloc(token.len + 1);
+    memcpy(name, unit->src + token.start, token.len);
+    name[token.len] = '\0';
+
+    section_defaults(name, &type, &flags);
+
+    if (lex(unit, &token)) {
+        goto FREE_NAME_ERROR;
+    }
+
+    if (token.type == COMMA) {
+        if (lex(unit, &token)) {
+            goto FREE_NAME_ERROR;
+        }
+        if (token.type != STRING) {
+            fprintf(stderr, "Error: .section expected a flags string.\n");
+            goto FREE_NAME_ERROR;
+        }
+
+        /* explicit flags replace the ones implied by the name */
+        flags = 0;
+        for (int i = 1; i < token.len - 1; i++) {
+            switch (unit->src[token.start + i])
+            {
+                case 'a': flags |= SHF_ALLOC; break;
+                case 'w': flags |= SHF_WRITE; break;
+                case 'x': flags |= SHF_EXECINSTR; break;
+                case 'M': flags |= SHF_MERGE; break;
+                case 'S': flags |= SHF_STRINGS; break;
+                case 'T': flags |= SHF_TLS; break;
+                case 'e': flags |= SHF_EXCLUDE; break;
+                default:
+                    fprintf(stderr, "Error: unknown section flag `%c`.\n",
+                            unit->src[token.start + i]);
+                    goto FREE_NAME_ERROR;
+            }
+        }
+
+        if (lex(unit, &token)) {
+            goto FREE_NAME_ERROR;
+        }
+        if (token.type == COMMA) {
+            if (lex(unit, &token)) {
+                goto FREE_NAME_ERROR;
+            }
+            if ((token.type != ID && token.type != REGISTER) || token.len < 2) {
+                fprintf(stderr, "Error: .section expected a section type.\n");
+                goto FREE_NAME_ERROR;
+            }
+            if (token.type == ID) {
+                /* skip the `@` */
+                token.start++;
+                token.len--;
+            }
+
+            if (!strncmp(unit->src + token.start, "progbits", token.len)) {
+                type = SHT_PROGBITS;
+            }
+            else if (!strncmp(unit->src + token.start, "nobits", token.len)) {
+                type = SHT_NOBITS;
+            }
+            else if (!strncmp(unit->src + token.start, "note", token.len)) {
+                type = SHT_NOTE;
+            }
+            else if (!strncmp(unit->src + token.start, "init_array", token.len)) {
+                type = SHT_INIT_ARRAY;
+            }
+            else if (!strncmp(unit->src + token.start, "fini_array", token.len)) {
+                type = SHT_FINI_ARRAY;
+            }
+            else if (!strncmp(unit->src + token.start, "unwind", token.len)) {
+                type = SHT_X86_64_UNWIND;
+            }
+            else {
+                fprintf(stderr, "Error: unknown section type `%.*s`.\n",
+                        token.len, unit->src + token.start);
+                goto FREE_NAME_ERROR;
+            }
+
+            if (lex(unit, &token)) {
+                goto FREE_NAME_ERROR;
+            }
+
+            /* mergeable sections carry their entry size */
+            if (token.type == COMMA) {
+                if (lex(unit, &token)
+                    || parse_absolute(unit, obj, &token, &entsize)) {
+                    goto FREE_NAME_ERROR;
+                }
+            }
+        }
+    }
+
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after .section.\n");
+        goto FREE_NAME_ERROR;
+    }
+
+    index = find_section(obj, name);
+    if (!index) {
+        index = add_section(obj, name, type, flags);
+        obj->sections[index].entsize = entsize;
+    }
+    set_section(obj, index);
+
+    free(name);
+    return 0;
+
+FREE_NAME_ERROR:
+    free(name);
+    return 1;
+}
+
+/* .size sym, expression */
+int parse_size(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    symbol_t *sym;
+    deferred_t *deferred;
+
+    if (parse_symbol(unit, obj, &token, &sym)) {
+        return 1;
+    }
+    if (token.type != COMMA) {
+        fprintf(stderr, "Error: expected a size for `%s`.\n", sym->name);
+        return 1;
+    }
+
+    /*
+     * The expression usually refers to labels after the symbol, `.-sym`,
+     * so it is parsed again once every label has its final value.
+     */
+    obj->deferred = realloc(obj->deferred,
+                            (obj->deferred_count + 1) * sizeof(deferred_t));
+    deferred = &(obj->deferred[obj->deferred_count++]);
+    *deferred = (deferred_t){
+        .sym = sym - obj->syms, .src = unit->i, .section = obj->section,
+        .dot = obj->sections[obj->section].size
+    };
+
+    /* skip it for now */
+    do {
+        if (lex(unit, &token)) {
+            return 1;
+        }
+    } while (token.type != NEWLINE && token.type != ENDOFFILE
+             && token.type != COMMA);
+
+    if (token.type == COMMA) {
+        fprintf(stderr, "Error: junk at end of line after .size.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+int parse_strings(unit_t *unit, elf64_obj_t *obj, int terminate)
+{
+    token_t token;
+    section_t *sec;
+    uint8_t *out;
+    size_t raw_len, len;
+
+    sec = &(obj->sections[obj->section]);
+
+    do {
+        if (lex(unit, &token)) {
+            return 1;
+        }
+        if (token.type != STRING) {
+            fprintf(stderr, "Error: expected a string.\n");
+            return 1;
+        }
+        if (sec->type == SHT_NOBITS) {
+            fprintf(stderr, "Error: attempt to store data in section `%s`.\n",
+                    sec->name);
+            return 1;
+        }
+
+        /*
+         * Decode straight into the section, the decoded string is never
+         * longer than its source.
+         */
+        raw_len = token.len - 2;
+        out = reserve_bytes(obj, raw_len + (terminate != 0));
+        if (token.value) {
+            len = decode_string(unit->src + token.start + 1, raw_len, out);
+        }
+        else {
+            memcpy(out, unit->src + token.start + 1, raw_len);
+            len = raw_len;
+        }
+        if (terminate) {
+            out[len++] = '\0';
+        }
+        shrink_bytes(obj, raw_len + (terminate != 0) - len);
+
+        if (lex(unit, &token)) {
+            return 1;
+        }
+    } while (token.type == COMMA);
+
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after string.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Lexes a symbol name and the token after it. */
+int parse_symbol(unit_t *unit, elf64_obj_t *obj, token_t *token,
+                 symbol_t **sym)
+{
+    char *name;
+
+    if (lex(unit, token)) {
+        return 1;
+    }
+    if (token->type != ID && token->type != DIRECTIVE) {
+        fprintf(stderr, "Error: expected a symbol.\n");
+        return 1;
+    }
+
+    name = malloc(token->len + 1);
+    memcpy(name, unit->src + token->start, token->len);
+    name[token->len] = '\0';
+    *sym = get_symbol(obj, name);
+    free(name);
+
+    return lex(unit, token);
+}
+
+/* .type sym, @function, also spelled %function, STT_FUNC or "function" */
+int parse_type(unit_t *unit, elf64_obj_t *obj)
+{
+    static const struct {
+        const char *name;
+        int         type;
+    } types[] = {
+        { "function", STT_FUNC }, { "object", STT_OBJECT },
+        { "notype", STT_NOTYPE }, { "tls_object", STT_TLS },
+        { "common", STT_COMMON }, { "gnu_indirect_function", STT_GNU_IFUNC },
+        { "STT_FUNC", STT_FUNC }, { "STT_OBJECT", STT_OBJECT },
+        { "STT_NOTYPE", STT_NOTYPE }, { "STT_TLS", STT_TLS },
+        { "STT_COMMON", STT_COMMON }, { "STT_GNU_IFUNC", STT_GNU_IFUNC }
+    };
+    token_t token;
+    symbol_t *sym;
+    const char *name;
+    int len, type;
+
+    if (parse_symbol(unit, obj, &token, &sym)) {
+        return 1;
+    }
+    if (token.type != COMMA) {
+        fprintf(stderr, "Error: expected a type for `%s`.\n", sym->name);
+        return 1;
+    }
+    if (lex(unit, &token)) {
+        return 1;
+    }
+
+    name = unit->src + token.start;
+    len = token.len;
+    if (token.type == STRING || (token.type == ID && *name == '@')) {
+        name++;
+        len -= token.type == STRING ? 2 : 1;
+    }
+    else if (token.type != ID && token.type != REGISTER) {
+        fprintf(stderr, "Error: expected a type for `%s`.\n", sym->name);
+        return 1;
+    }
+
+    type = -1;
+    for (int i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+        if (strlen(types[i].name) == len && !strncmp(types[i].name, name, len)) {
+            type = types[i].type;
+            break;
+        }
+    }
+    if (type < 0) {
+        fprintf(stderr, "Error: unrecognized symbol type `%.*s`.\n", len, name);
+        return 1;
+    }
+
+    if (lex(unit, &token)) {
+        return 1;
+    }
+    if (token.type != NEWLINE && token.type != ENDOFFILE) {
+        fprintf(stderr, "Error: junk at end of line after .type.\n");
+        return 1;
+    }
+
+    sym->sym.st_info = ELF64_ST_INFO(ELF64_ST_BIND(sym->sym.st_info), type);
+    return 0;
+}
+
+int parse_x86_64(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    char *buff;
+
+    while (!lex(unit, &token)) {
+        buff = malloc(token.len + 1);
+        memcpy(buff, unit->src + token.start, token.len);
+        buff[token.len] = '\0';
+
+        switch (token.type)
+        {
+            case ID:
+            {
+                for (char *p = buff; *p; ++p) {
+                    *p = tolower(*p);
+                }
+
+                add_line(unit, obj, token.start);
+                if (parse_instruction(unit, obj, buff)) {
+                    goto FREE_BUFF_ERROR;
+                }
+                free(buff);
+                break;
+            }
+            case LABEL:
+            {
+                symbol_t *sym;
+
+                sym = get_symbol(obj, buff);
+                free(buff);
+
+                if (sym->defined) {
+                    fprintf(stderr, "Error: symbol `%s` is already defined.\n",
+                            sym->name);
+                    return 1;
+                }
+
+                if ((obj->options->function_sections
+                     || obj->options->order_count) && !obj->cfi_open) {
+                    function_section(obj, sym);
+                }
+                obj->pad_section = 0; /* the padding now leads up to a label */
+
+                sym->defined = 1;
+                sym->sym.st_shndx = obj->section;
+                sym->sym.st_value = obj->sections[obj->section].size;
+
+                if (obj->label_section != obj->section
+                    || obj->label_end != sym->sym.st_value) {
+                    obj->label_count = 0;
+                }
+                obj->labels = realloc(obj->labels, (obj->label_count + 1)
+                                                   * sizeof(size_t));
+                obj->labels[obj->label_count++] = sym - obj->syms;
+                obj->label_section = obj->section;
+                obj->label_end = sym->sym.st_value;
+                break;
+            }
+            case DIRECTIVE:
+            {
+                if (!strcmp(buff, ".globl") || !strcmp(buff, ".global")) {
+                    if (parse_binding(unit, obj, STB_GLOBAL, -1)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".weak")) {
+                    if (parse_binding(unit, obj, STB_WEAK, -1)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".local")) {
+                    if (parse_binding(unit, obj, STB_LOCAL, -1)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".hidden")) {
+                    if (parse_binding(unit, obj, -1, STV_HIDDEN)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".protected")) {
+                    if (parse_binding(unit, obj, -1, STV_PROTECTED)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".internal")) {
+                    if (parse_binding(unit, obj, -1, STV_INTERNAL)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".type")) {
+                    if (parse_type(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".size")) {
+                    if (parse_size(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".text")) {
+                    set_section(obj, find_section(obj, ".text"));
+                }
+                else if (!strcmp(buff, ".data")) {
+                    set_section(obj, find_section(obj, ".data"));
+                }
+                else if (!strcmp(buff, ".bss")) {
+                    set_section(obj, find_section(obj, ".bss"));
+                }
+                else if (!strcmp(buff, ".previous")) {
+                    if (!obj->previous) {
+                        fprintf(stderr, "Warning: .previous without corresponding .section; ignored.\n");
+                    }
+                    else {
+                        set_section(obj, obj->previous);
+                    }
+                }
+                else if (!strcmp(buff, ".pushsection")) {
+                    obj->section_stack = realloc(obj->section_stack,
+                                                 (obj->section_depth + 2) * sizeof(size_t));
+                    obj->section_stack[obj->section_depth++] = obj->section;
+                    obj->section_stack[obj->section_depth++] = obj->previous;
+                    if (parse_section(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".popsection")) {
+                    if (!obj->section_depth) {
+                        fprintf(stderr, "Error: .popsection without corresponding .pushsection.\n");
+                        goto FREE_BUFF_ERROR;
+                    }
+                    obj->previous = obj->section_stack[--obj->section_depth];
+                    obj->section = obj->section_stack[--obj->section_depth];
+                }
+                else if (!strcmp(buff, ".section")) {
+                    if (parse_section(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".ascii")) {
+                    if (parse_strings(unit, obj, 0)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".asciz") || !strcmp(buff, ".string")) {
+                    if (parse_strings(unit, obj, 1)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".zero") || !strcmp(buff, ".skip")
+                         || !strcmp(buff, ".space")) {
+                    if (parse_fill(unit, obj, 0)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".fill")) {
+                    if (parse_fill(unit, obj, 1)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".byte")) {
+                    if (parse_data(unit, obj, 1)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".word") || !strcmp(buff, ".short")
+                         || !strcmp(buff, ".value") || !strcmp(buff, ".2byte")) {
+                    if (parse_data(unit, obj, 2)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".long") || !strcmp(buff, ".int")
+                         || !strcmp(buff, ".4byte")) {
+                    if (parse_data(unit, obj, 4)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".quad") || !strcmp(buff, ".8byte")) {
+                    if (parse_data(unit, obj, 8)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".uleb128")
+                         || !strcmp(buff, ".sleb128")) {
+                    if (parse_leb128(unit, obj, buff[1] == 's')) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".ident")) {
+                    if (parse_ident(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strncmp(buff, ".cfi_", 5)) {
+                    if (parse_cfi(unit, obj, buff)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".file")) {
+                    if (parse_file(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".loc")) {
+                    if (parse_loc(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".incbin")) {
+                    if (parse_incbin(unit, obj)) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".comm") || !strcmp(buff, ".lcomm")) {
+                    if (parse_comm(unit, obj, buff[1] == 'l')) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else if (!strcmp(buff, ".align") || !strcmp(buff, ".balign")
+                         || !strcmp(buff, ".p2align")) {
+                    if (parse_align(unit, obj, buff[1] == 'p')) {
+                        goto FREE_BUFF_ERROR;
+                    }
+                }
+                else {
+                    fprintf(stderr, "Error: unknown pseudo-op: `%s`\n", buff);
+                    goto FREE_BUFF_ERROR;
+                }
+                free(buff);
+                break;
+            }
+            case ENDOFFILE:
+            {
+                free(buff);
+                if (obj->cfi_open) {
+                    fprintf(stderr, "Error: open CFI at the end of file; missing .cfi_endproc directive.\n");
+                    return 1;
+                }
+                return 0;
+            }
+            default:
+                free(buff);
+                break;
+        }
+    }
+
+    return 1;
+
+FREE_BUFF_ERROR:
+    free(buff);
+    return 1;
+}
+
+/*
+ * Reads a symbol ordering file: a function name per line, `#` starts a
+ * comment. The format is the one lld and gold take.
+ */
+int read_symbol_order(options_t *options, const char *filename)
+{
+    FILE *fd;
+    char *line, *name, *end;
+    size_t capacity;
+
+    fd = fopen(filename, "r");
+    if (fd == NULL) {
+        fprintf(stderr, "Failed to open `%s`.\n", filename);
+        return 1;
+    }
+
+    line = NULL;
+    capacity = 0;
+    while (getline(&line, &capacity, fd) != -1) {
+        end = strchr(line, '#');
+        if (!end) {
+            end = line + strlen(line);
+        }
+        name = line;
+        while (name < end && isspace(*name)) {
+            name++;
+        }
+        while (end > name && isspace(end[-1])) {
+            end--;
+        }
+        if (end == name) {
+            continue;
+        }
+
+        options->order = realloc(options->order, (options->order_count + 1)
+                                                 * sizeof(char *));
+        options->order[options->order_count++] = strndup(name, end - name);
+    }
+    free(line);
+    fclose(fd);
+
+    return 0;
+}
+
+/*
+ * Makes each jmp and jcc whose target is near enough in its own section
+ * two bytes long, the way the GNU assembler relaxes them. They all start
+ * short and only grow back, until every short one reaches its target, so
+ * this ends. The .align and -falign-loops padding is sized again as the
+ * code before it moves.
+ */
+int relax_branches(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    expr_t value;
+    int64_t *targets, disp, target;
+    uint64_t *at, *added, *pads, delta, start, pad;
+    size_t *branches, *aligns, *seqs, *before, branch_count, align_count,
+           count, n, b, a;
+    splice_t *splices;
+    section_t *sec;
+    symbol_t *sym;
+    uint8_t *p;
+    char *name;
+    int *near, changed;
+
+    if (!obj->branch_count) {
+        return 0;
+    }
+
+    /* the branches to a label of their own section start out short */
+    targets = malloc(obj->branch_count * sizeof(int64_t));
+    near = malloc(obj->branch_count * sizeof(int));
+    before = calloc(obj->branch_count, sizeof(size_t));
+    for (size_t i = 0; i < obj->branch_count; i++) {
+        fixup_t *fixup = &(obj->fixups[obj->branches[i].fixup]);
+
+        obj->evaluating = &(fixup->expr);
+        unit->i = fixup->expr.src;
+        if (lex(unit, &token) || parse_expression(unit, obj, &token, &value)) {
+            obj->evaluating = NULL;
+            free(before);
+            free(near);
+            free(targets);
+            return 1;
+        }
+        obj->evaluating = NULL;
+
+        targets[i] = value.value;
+        near[i] = value.section == fixup->expr.section && !value.sym
+                  && !value.minus;
+
+        /* a label on its own may be one kept in front of an .align */
+        unit->i = fixup->expr.src;
+        if (!lex(unit, &token) && token.type == ID) {
+            name = strndup(unit->src + token.start, token.len);
+            sym = find_symbol(obj, name);
+            free(name);
+            if (sym && !lex(unit, &token)
+                && (token.type == NEWLINE || token.type == ENDOFFILE)) {
+                before[i] = sym->pad_seq;
+            }
+        }
+    }
+
+    /* without alignments the array is still NULL, which qsort can't take */
+    if (obj->align_count) {
+        qsort(obj->aligns, obj->align_count, sizeof(align_t),
+              compare_aligns);
+    }
+
+    n = obj->branch_count + obj->align_count;
+    branches = malloc(obj->branch_count * sizeof(size_t));
+    aligns = malloc((obj->align_count + 1) * sizeof(size_t));
+    pads = malloc((obj->align_count + 1) * sizeof(uint64_t));
+    at = malloc(n * sizeof(uint64_t));
+    seqs = malloc(n * sizeof(size_t));
+    added = malloc(n * sizeof(uint64_t));
+    splices = malloc(n * sizeof(splice_t));
+    for (size_t section = 1; section < obj->section_count; section++) {
+        sec = &(obj->sections[section]);
+
+        branch_count = 0;
+        for (size_t i = 0; i < obj->branch_count; i++) {
+            if (obj->fixups[obj->branches[i].fixup].expr.section == section
+                && near[i]) {
+                branches[branch_count++] = i;
+            }
+        }
+        if (!branch_count) {
+            continue;
+        }
+        align_count = 0;
+        for (size_t i = 0; i < obj->align_count; i++) {
+            if (obj->aligns[i].section == section) {
+                aligns[align_count++] = i;
+            }
+        }
+
+        do {
+            /* where the bytes each branch and .align gains or loses go */
+            n = delta = 0;
+            b = a = 0;
+            while (b < branch_count || a < align_count) {
+                fixup_t *fixup;
+                align_t *align;
+
+                fixup = b < branch_count
+                      ? &(obj->fixups[obj->branches[branches[b]].fixup])
+                      : NULL;
+                align = a < align_count ? &(obj->aligns[aligns[a]]) : NULL;
+                if (fixup && (!align || fixup->expr.dot < align->start)) {
+                    if (near[branches[b]]) {
+                        delta += 2 - (fixup->place + 4 - fixup->expr.dot);
+                        at[n] = fixup->expr.dot + 2;
+                        seqs[n] = 0;
+                        added[n++] = delta;
+                    }
+                    b++;
+                    continue;
+                }
+
+                pad = -(align->start + delta) & (align->align - 1);
+                if (align->max > 0 && pad > align->max) {
+                    pad = 0;
+                }
+                pads[a++] = pad;
+                delta += pad - align->len;
+                at[n] = align->start + align->len;
+                /* only an empty one may have labels before it there */
+                seqs[n] = align->len ? 0 : align->seq;
+                added[n++] = delta;
+            }
+
+            /* the short ones that don't reach grow back */
+            changed = 0;
+            for (b = 0; b < branch_count; b++) {
+                size_t i = branches[b];
+                uint64_t dot = obj->fixups[obj->branches[i].fixup].expr.dot;
+
+                if (!near[i]) {
+                    continue;
+                }
+                target = before[i]
+                       ? shift_before(at, seqs, added, n, targets[i],
+                                      before[i])
+                       : shift_offset(at, added, n, targets[i]);
+                disp = target - shift_offset(at, added, n, dot) - 2;
+                if (disp < INT8_MIN || disp > INT8_MAX) {
+                    near[i] = 0;
+                    changed = 1;
+                }
+            }
+        } while (changed);
+
+        /* the new bytes, then what follows them moves as worked out last */
+        count = 0;
+        for (b = a = 0; b < branch_count || a < align_count;) {
+            fixup_t *fixup;
+            align_t *align;
+
+            fixup = b < branch_count
+                  ? &(obj->fixups[obj->branches[branches[b]].fixup])
+                  : NULL;
+            align = a < align_count ? &(obj->aligns[aligns[a]]) : NULL;
+            if (fixup && (!align || fixup->expr.dot < align->start)) {
+                if (near[branches[b]]) {
+                    start = fixup->expr.dot;
+                    splices[count] = (splice_t){
+                        .start = start, .len = fixup->place + 4 - start,
+                        .frag = (frag_t){
+                            .type = FRAG_DATA, .data = malloc(2), .size = 2,
+                            .capacity = 2
+                        }
+                    };
+                    p = splices[count++].frag.data;
+                    p[0] = obj->branches[branches[b]].opcode;
+                    p[1] = 0;
+
+                    /* rel8, in the byte after the opcode */
+                    fixup->place = start + 1;
+                    fixup->size = 1;
+                    fixup->flags &= ~FIXUP_BRANCH;
+                    fixup->adjust = -1;
+                }
+                b++;
+                continue;
+            }
+
+            pad = pads[a++];
+            if (pad == align->len) {
+                continue;
+            }
+            splices[count] = (splice_t){ .start = align->start,
+                                         .len = align->len };
+            if (align->fill < 0 && (sec->flags & SHF_EXECINSTR)) {
+                splices[count].frag = (frag_t){
+                    .type = FRAG_DATA, .data = malloc(pad), .size = pad,
+                    .capacity = pad
+                };
+                fill_nops(splices[count].frag.data, pad);
+            }
+            else {
+                splices[count].frag = (frag_t){
+                    .type = FRAG_FILL, .size = pad, .pattern_len = 1,
+                    .pattern = { align->fill < 0 ? 0 : align->fill }
+                };
+            }
+            count++;
+            align->len = pad;
+        }
+
+        if (count) {
+            splice_section(sec, splices, count);
+            shift_section(obj, section, at, seqs, added, n);
+        }
+    }
+
+    free(splices);
+    free(added);
+    free(seqs);
+    free(at);
+    free(pads);
+    free(aligns);
+    free(branches);
+    free(before);
+    free(near);
+    free(targets);
+    return 0;
+}
+
+/*
+ * Whether rep and its condition forms may go before the instruction. Those
+ * of nop, bsf and bsr make pause, tzcnt and lzcnt, as written by compilers
+ * for processors that might not have them.
+ */
+int repeatable(const insn_t *insn)
+{
+    static const char *mnemonics[] = {
+        "cmps", "cmpsd", "lods", "movs", "movsd", "nop", "ret", "scas", "stos"
+    };
+    static const char *with_operands[] = { "bsf", "bsr", "ret" };
+
+    if (insn->operand_count) {
+        for (size_t i = 0;
+             i < sizeof(with_operands) / sizeof(with_operands[0]); i++) {
+            if (!strcmp(insn->mnemonic, with_operands[i])) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(mnemonics) / sizeof(mnemonics[0]); i++) {
+        if (!strcmp(insn->mnemonic, mnemonics[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+uint8_t *reserve_bytes(elf64_obj_t *obj, size_t len)
+{
+    section_t *sec;
+    frag_t *frag;
+    uint8_t *p;
+
+    sec = &(obj->sections[obj->section]);
+
+    if (!sec->frag_count || sec->frags[sec->frag_count - 1].type != FRAG_DATA) {
+        sec->frags = realloc(sec->frags, (sec->frag_count + 1) * sizeof(frag_t));
+        sec->frags[sec->frag_count++] = (frag_t){ .type = FRAG_DATA };
+    }
+    frag = &(sec->frags[sec->frag_count - 1]);
+
+    if (frag->size + len > frag->capacity) {
+        if (!frag->capacity) {
+            frag->capacity = 64;
+        }
+        while (frag->size + len > frag->capacity) {
+            frag->capacity *= 2;
+        }
+        frag->data = realloc(frag->data, frag->capacity);
+    }
+
+    p = frag->data + frag->size;
+    frag->size += len;
+    sec->size += len;
+    return p;
+}
+
+/*
+ * Fills in every fixup whose value is now known, and turns the others into
+ * relocations. Pc-relative values within their own section are resolved,
+ * anything the linker may resolve differently gets a relocation against
+ * its symbol, and other section offsets are relocated against the
+ * section symbol.
+ */
+int resolve_fixups(unit_t *unit, elf64_obj_t *obj)
+{
+    static const uint32_t absolute[9] = {
+        [1] = R_X86_64_8, [2] = R_X86_64_16, [4] = R_X86_64_32,
+        [8] = R_X86_64_64
+    };
+    static const uint32_t pcrel[9] = {
+        [1] = R_X86_64_PC8, [2] = R_X86_64_PC16, [4] = R_X86_64_PC32,
+        [8] = R_X86_64_PC64
+    };
+    token_t token;
+    expr_t value;
+
+    for (size_t i = 0; i < obj->fixup_count; i++) {
+        fixup_t *fixup;
+        section_t *sec;
+        uint8_t *p;
+        int is_pcrel;
+
+        fixup = &(obj->fixups[i]);
+        sec = &(obj->sections[fixup->expr.section]);
+        p = sec->frags[fixup->frag].data + fixup->offset;
+
+        obj->evaluating = &(fixup->expr);
+        unit->i = fixup->expr.src;
+        if (lex(unit, &token) || parse_expression(unit, obj, &token, &value)) {
+            obj->evaluating = NULL;
+            return 1;
+        }
+        obj->evaluating = NULL;
+
+        /* sized by size_leb128, which made sure it is a constant */
+        if (fixup->flags & FIXUP_LEB128) {
+            for (int j = 0; j < fixup->size; j++) {
+                p[j] = (value.value & 0x7F) | (j + 1 < fixup->size ? 0x80 : 0);
+                value.value = fixup->flags & FIXUP_SIGNED
+                            ? value.value >> 7
+                            : (int64_t)((uint64_t)value.value >> 7);
+            }
+            continue;
+        }
+
+        is_pcrel = fixup->flags & FIXUP_PCREL;
+        if (is_pcrel) {
+            value.value += fixup->adjust;
+        }
+        if (value.minus) {
+            if (is_pcrel || value.minus != fixup->expr.section) {
+                fprintf(stderr, "Error: can't resolve a value relative to section `%s`.\n",
+                        obj->sections[value.minus].name);
+                return 1;
+            }
+            /* S + A - L, where L sits at -A within this section */
+            value.value += fixup->place;
+            is_pcrel = 1;
+        }
+
+        if (is_pcrel && !value.sym && value.section == fixup->expr.section) {
+            value = (expr_t){ .value = value.value - fixup->place };
+        }
+        else if (is_pcrel || value.sym || value.section) {
+            sec->relocs = realloc(sec->relocs,
+                                  (sec->reloc_count + 1) * sizeof(reloc_t));
+            sec->relocs[sec->reloc_count++] = (reloc_t){
+                .offset = fixup->place,
+                .type = is_pcrel ? pcrel[fixup->size] : absolute[fixup->size],
+                .section = value.section, .sym = value.sym,
+                .addend = value.value
+            };
+            if (value.reloc == R_X86_64_GOTPCREL) {
+                sec->relocs[sec->reloc_count - 1].type =
+                    fixup->size == 8 ? R_X86_64_GOTPCREL64
+                    : !(fixup->flags & FIXUP_GOTPCRELX) ? R_X86_64_GOTPCREL
+                    : fixup->flags & FIXUP_REX ? R_X86_64_REX_GOTPCRELX
+                    : R_X86_64_GOTPCRELX;
+            }
+            else if (value.reloc
+                     || (is_pcrel && value.sym
+                         && (fixup->flags & FIXUP_BRANCH)
+                         && !(obj->syms[value.sym - 1].defined
+                              && ELF64_ST_BIND(obj->syms[value.sym - 1]
+                                               .sym.st_info) == STB_LOCAL))) {
+                /*
+                 * a branch to a local symbol, an IFUNC that kept its
+                 * relocation, stays PC32 as with the GNU assembler
+                 */
+                sec->relocs[sec->reloc_count - 1].type = R_X86_64_PLT32;
+            }
+            else if (!is_pcrel && fixup->size == 4
+                     && (fixup->flags & FIXUP_SIGNED)) {
+                sec->relocs[sec->reloc_count - 1].type = R_X86_64_32S;
+            }
+            continue;
+        }
+
+        if (fixup->size < 8) {
+            int64_t min, max;
+
+            min = -((int64_t)1 << (fixup->size * 8 - 1));
+            max = is_pcrel ? ((int64_t)1 << (fixup->size * 8 - 1)) - 1
+                           : ((int64_t)1 << (fixup->size * 8)) - 1;
+            if (value.value < min || value.value > max) {
+                fprintf(stderr, "Error: value %ld does not fit in %d bytes.\n",
+                        value.value, fixup->size);
+                return 1;
+            }
+        }
+        for (int j = 0; j < fixup->size; j++) {
+            p[j] = (uint64_t)value.value >> (j * 8);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Returns the length of the run at `s` that needs no escape processing,
+ * stopping at a quote, a backslash, a newline or the end of the source.
+ */
+size_t scan_string(const char *s)
+{
+    size_t i;
+
+    i = 0;
+#ifdef __SSE2__
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+
+    for (;;) {
+        __m128i chunk, stop;
+        int mask;
+
+        chunk = _mm_loadu_si128((const __m128i *)(s + i));
+        stop = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                         _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, newline),
+                         _mm_cmpeq_epi8(chunk, zero))
+        );
+        mask = _mm_movemask_epi8(stop);
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 16;
+    }
+#else
+    while (s[i] != '"' && s[i] != '\\' && s[i] != '\n' && s[i] != '\0') {
+        i++;
+    }
+    return i;
+#endif
+}
+
+void section_defaults(const char *name, uint32_t *type, uint64_t *flags)
+{
+    *type = SHT_PROGBITS;
+    *flags = 0;
+
+    if (!strncmp(name, ".text", 5)) {
+        *flags = SHF_ALLOC | SHF_EXECINSTR;
+    }
+    else if (!strncmp(name, ".data", 5)) {
+        *flags = SHF_ALLOC | SHF_WRITE;
+    }
+    else if (!strncmp(name, ".bss", 4)) {
+        *type = SHT_NOBITS;
+        *flags = SHF_ALLOC | SHF_WRITE;
+    }
+    else if (!strncmp(name, ".rodata", 7)) {
+        *flags = SHF_ALLOC;
+    }
+    else if (!strncmp(name, ".tdata", 6)) {
+        *flags = SHF_ALLOC | SHF_WRITE | SHF_TLS;
+    }
+    else if (!strncmp(name, ".tbss", 5)) {
+        *type = SHT_NOBITS;
+        *flags = SHF_ALLOC | SHF_WRITE | SHF_TLS;
+    }
+    else if (!strncmp(name, ".note", 5)) {
+        *type = SHT_NOTE;
+    }
+    else if (!strcmp(name, ".eh_frame")) {
+        *flags = SHF_ALLOC;
+    }
+}
+
+void set_section(elf64_obj_t *obj, size_t index)
+{
+    obj->previous = obj->section;
+    obj->section = index;
+}
+
+/*
+ * Moves whatever refers to a location in the section once its contents
+ * changed size: a location at or after at[i] moves by added[i], the change
+ * up to there, which wraps around when the section got shorter. An .align,
+ * or a label in front of one, only moves by the paddings written before it.
+ */
+void shift_section(elf64_obj_t *obj, size_t section, const uint64_t *at,
+                   const size_t *seqs, const uint64_t *added, size_t n)
+{
+    section_t *sec;
+    uint64_t *starts, start;
+
+    for (size_t s = 0; s < obj->sym_count; s++) {
+        Elf64_Sym *sym = &(obj->syms[s].sym);
+
+        if (!obj->syms[s].defined || sym->st_shndx != section) {
+            continue;
+        }
+        if (obj->syms[s].pad_seq) {
+            sym->st_value = shift_before(at, seqs, added, n, sym->st_value,
+                                         obj->syms[s].pad_seq);
+        }
+        else {
+            sym->st_value = shift_offset(at, added, n, sym->st_value);
+        }
+    }
+    for (size_t d = 0; d < obj->deferred_count; d++) {
+        deferred_t *deferred = &(obj->deferred[d]);
+
+        if (deferred->section == section) {
+            deferred->dot = shift_offset(at, added, n, deferred->dot);
+        }
+    }
+    for (size_t l = 0; l < obj->line_count; l++) {
+        line_t *row = &(obj->lines[l]);
+
+        if (row->section == section) {
+            row->loc = shift_offset(at, added, n, row->loc);
+        }
+    }
+    for (size_t e = 0; e < obj->fde_count; e++) {
+        fde_t *fde = &(obj->fdes[e]);
+
+        if (fde->section != section) {
+            continue;
+        }
+        /* a function ending where padding starts doesn't take it in */
+        if (fde->end > fde->start) {
+            fde->end = shift_offset(at, added, n, fde->end - 1) + 1;
+        }
+        fde->start = shift_offset(at, added, n, fde->start);
+        for (size_t r = 0; r < fde->row_count; r++) {
+            fde->rows[r].loc = shift_offset(at, added, n, fde->rows[r].loc);
+        }
+    }
+    for (size_t a = 0; a < obj->align_count; a++) {
+        align_t *align = &(obj->aligns[a]);
+
+        if (align->section == section) {
+            align->start = shift_before(at, seqs, added, n, align->start,
+                                        align->seq);
+        }
+    }
+
+    /* fixups also need the fragment their field is in now */
+    sec = &(obj->sections[section]);
+    starts = malloc((sec->frag_count + 1) * sizeof(uint64_t));
+    start = 0;
+    for (size_t f = 0; f < sec->frag_count; f++) {
+        starts[f] = start;
+        start += sec->frags[f].size;
+    }
+    for (size_t x = 0; x < obj->fixup_count; x++) {
+        fixup_t *fixup = &(obj->fixups[x]);
+        size_t low, high;
+
+        if (fixup->expr.section != section) {
+            continue;
+        }
+        fixup->expr.dot = shift_offset(at, added, n, fixup->expr.dot);
+        fixup->place = shift_offset(at, added, n, fixup->place);
+
+        low = 0;
+        high = sec->frag_count;
+        while (high - low > 1) {
+            size_t middle = (low + high) / 2;
+
+            if (starts[middle] <= fixup->place) {
+                low = middle;
+            }
+            else {
+                high = middle;
+            }
+        }
+        fixup->frag = low;
+        fixup->offset = fixup->place - starts[low];
+    }
+    free(starts);
+}
+
+/*
+ * shift_offset for what is in front of the .align numbered `seq` at
+ * `offset`: the paddings there of the ones written after it come later.
+ */
+uint64_t shift_before(const uint64_t *at, const size_t *seqs,
+                      const uint64_t *added, size_t n, uint64_t offset,
+                      size_t seq)
+{
+    size_t low, high;
+
+    /* the number of changes before `offset` */
+    low = 0;
+    high = n;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+
+        if (at[middle] < offset) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    while (low < n && at[low] == offset && seqs[low] < seq) {
+        low++;
+    }
+
+    return low ? offset + added[low - 1] : offset;
+}
+
+/* Where `offset` is once the change at each of `at` is added before it. */
+uint64_t shift_offset(const uint64_t *at, const uint64_t *added, size_t n,
+                      uint64_t offset)
+{
+    size_t low, high;
+
+    /* the number of changes at or before `offset` */
+    low = 0;
+    high = n;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+
+        if (at[middle] <= offset) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    return low ? offset + added[low - 1] : offset;
+}
+
+/* Gives back the last `len` bytes handed out by reserve_bytes. */
+void shrink_bytes(elf64_obj_t *obj, size_t len)
+{
+    section_t *sec;
 
-                    buff = malloc(token.len + 1);
-                    memcpy(buff, unit->src + token.start, token.len);
-                    buff[token.len] = '\0';
+    sec = &(obj->sections[obj->section]);
+    sec->frags[sec->frag_count - 1].size -= len;
+    sec->size -= len;
+}
 
-                    if (lex(unit, &token)) {
-                        return 1;
-                    }
-                    if (token.type != NEWLINE && token.type != ENDOFFILE) {
-                        fprintf(stderr, "Error: junk at end of line after .globl.\n");
-                        return 1;
-                    }
+/*
+ * Gives each .uleb128 and .sleb128 value parse_leb128 couldn't work out
+ * the bytes it takes, now that the code is relaxed. They start a byte long
+ * and only grow, so this ends; one longer than it needs is padded with
+ * continuation bytes.
+ */
+int size_leb128(unit_t *unit, elf64_obj_t *obj)
+{
+    token_t token;
+    expr_t value;
+    uint64_t *at, *added, delta;
+    size_t *seqs, count, len, n;
+    splice_t *splices;
+    uint8_t bytes[10];
+    int changed, return_value;
 
-                    obj->syms = realloc(obj->syms,
-                                        (syms_index + 1) * sizeof(Elf64_Sym));
-                    obj->syms[syms_index] = (Elf64_Sym){
-                        .st_name = 0x01,
-                        .st_info = ELF64_ST_INFO(STB_GLOBAL, STT_NOTYPE),
-                        .st_other = STV_DEFAULT, .st_shndx = 0, .st_value = 0,
-                        .st_size = 0
-                    };
-                    obj->strtab = realloc(obj->strtab,
-                                         (obj->strtab_count + 1) * sizeof(char *));
-                    obj->strtab[obj->strtab_count] = buff;
+    count = 0;
+    for (size_t i = 0; i < obj->fixup_count; i++) {
+        count += !!(obj->fixups[i].flags & FIXUP_LEB128);
+    }
+    if (!count) {
+        return 0;
+    }
+
+    at = malloc(count * sizeof(uint64_t));
+    seqs = calloc(count, sizeof(size_t));
+    added = malloc(count * sizeof(uint64_t));
+    splices = malloc(count * sizeof(splice_t));
+    return_value = 0;
+    do {
+        changed = 0;
+        for (size_t section = 1; section < obj->section_count; section++) {
+            n = delta = 0;
+            for (size_t i = 0; i < obj->fixup_count; i++) {
+                fixup_t *fixup = &(obj->fixups[i]);
 
-                    obj->strtab_count++;
-                    obj->glabel_count++;
+                if (!(fixup->flags & FIXUP_LEB128)
+                    || fixup->expr.section != section) {
+                    continue;
                 }
-                else {
-                    fprintf(stderr, "Error: unknown pseudo-op: `%s`\n", buff);
-                    goto FREE_BUFF_ERROR;
+
+                obj->evaluating = &(fixup->expr);
+                unit->i = fixup->expr.src;
+                if (lex(unit, &token)
+                    || parse_expression(unit, obj, &token, &value)) {
+                    return_value = 1;
+                    goto FREE;
                 }
-                break;
+                if (value.sym || value.section || value.minus) {
+                    fprintf(stderr, "Error: %s value does not evaluate to a constant.\n",
+                            fixup->flags & FIXUP_SIGNED ? ".sleb128"
+                                                        : ".uleb128");
+                    return_value = 1;
+                    goto FREE;
+                }
+
+                len = fixup->flags & FIXUP_SIGNED
+                    ? encode_sleb128(bytes, value.value)
+                    : encode_uleb128(bytes, value.value);
+                if (len <= fixup->size) {
+                    continue;
+                }
+                splices[n] = (splice_t){
+                    .start = fixup->place, .len = fixup->size,
+                    .frag = (frag_t){
+                        .type = FRAG_DATA, .data = calloc(len, 1), .size = len,
+                        .capacity = len
+                    }
+                };
+                delta += len - fixup->size;
+                at[n] = fixup->place + fixup->size;
+                added[n++] = delta;
+                fixup->size = len;
             }
-            case ENDOFFILE:
-            {
-                free(buff);
-                return 0;
+
+            if (n) {
+                splice_section(&(obj->sections[section]), splices, n);
+                shift_section(obj, section, at, seqs, added, n);
+                changed = 1;
             }
-            default:
-                free(buff);
-                break;
         }
-    }
-
-    return 1;
+    } while (changed);
 
-FREE_BUFF_ERROR:
-    free(buff);
-    return 1;
+FREE:
+    obj->evaluating = NULL;
+    free(splices);
+    free(added);
+    free(seqs);
+    free(at);
+    return return_value;
 }
 
 void skip_comments(unit_t *unit)
@@ -657,105 +8896,618 @@ void skip_comments(unit_t *unit)
     }
 }
 
+/*
+ * Replaces ranges of the section's contents, sorted and apart, by the
+ * fragments given, which the section takes over. The fragments around the
+ * ranges are split when needed, those are data and fill fragments only,
+ * as no label falls inside an .incbin.
+ */
+void splice_section(section_t *sec, splice_t *splices, size_t n)
+{
+    frag_t *frags, *frag;
+    uint64_t size, from, to, start, end, frag_start;
+    size_t count, f;
+
+    frags = malloc((sec->frag_count + 2 * n + 1) * sizeof(frag_t));
+    count = f = 0;
+    frag_start = from = 0;
+    size = sec->size;
+    for (size_t k = 0; k <= n; k++) {
+        to = k < n ? splices[k].start : size;
+
+        /* the fragments, or the parts of them, kept up to the range */
+        for (; f < sec->frag_count; f++) {
+            frag = &(sec->frags[f]);
+            start = from > frag_start ? from : frag_start;
+            end = frag_start + frag->size < to ? frag_start + frag->size : to;
+            if (start >= to) {
+                break;
+            }
+
+            if (start == frag_start && end == frag_start + frag->size) {
+                frags[count++] = *frag;
+                frag->data = NULL;
+            }
+            else if (start < end) {
+                frags[count] = (frag_t){ .type = FRAG_DATA,
+                                         .size = end - start,
+                                         .capacity = end - start };
+                if (frag->type == FRAG_FILL) {
+                    frags[count].type = FRAG_FILL;
+                    frags[count].pattern_len = frag->pattern_len;
+                    for (size_t i = 0; i < frag->pattern_len; i++) {
+                        frags[count].pattern[i] = frag->pattern[
+                            (start - frag_start + i) % frag->pattern_len];
+                    }
+                }
+                else {
+                    frags[count].data = malloc(end - start);
+                    memcpy(frags[count].data,
+                           frag->data + (start - frag_start), end - start);
+                }
+                count++;
+            }
+
+            if (frag_start + frag->size > to) {
+                break;
+            }
+            frag_start += frag->size;
+        }
+        if (k == n) {
+            break;
+        }
+
+        if (splices[k].frag.size) {
+            frags[count++] = splices[k].frag;
+        }
+        else {
+            free(splices[k].frag.data);
+        }
+        sec->size += splices[k].frag.size - splices[k].len;
+        from = to + splices[k].len;
+    }
+
+    for (f = 0; f < sec->frag_count; f++) {
+        if (sec->frags[f].type != FRAG_FILE) {
+            free(sec->frags[f].data);
+        }
+    }
+    free(sec->frags);
+    sec->frags = frags;
+    sec->frag_count = count;
+}
+
+int token_is(unit_t *unit, token_t *token, const char *text)
+{
+    return token->len == strlen(text)
+           && !strncmp(unit->src + token->start, text, token->len);
+}
+
 void usage()
 {
     puts("Usage: pasm [options] asmfile\n"
          "Options:\n"
          "  --help      Display this information.\n"
+         "  -g          Generate line information for the assembly source.\n"
+         "  --compress-debug-sections[=none|zlib|zstd]\n"
+         "              Compress the DWARF debug sections. (zlib by default)\n"
+         "  -ffunction-sections\n"
+         "              Place each function in a .text.NAME section of its own.\n"
+         "  -falign-loops[=N[:M]]\n"
+         "              Align the targets of backward jumps to N bytes (16 by\n"
+         "              default) when that takes less than M bytes of padding.\n"
+         "  -O[0|1|2|s]\n"
+         "              Use shorter encodings that do the same, as the GNU\n"
+         "              assembler does at that level.\n"
+         "  --symbol-ordering-file FILE\n"
+         "              Lay out the functions listed in FILE first, in its order.\n"
          "  -o OUTFILE  Specify the output file name. (default is "OUTFILE_DEFAULT")"
     );
 }
 
 int write_file_x86_64(char *outfile, elf64_obj_t *obj)
 {
-    uint8_t *raw_obj;
-    size_t raw_obj_len, syms_count, strtab_len, shstrtab_len;
+    Elf64_Shdr *shdrs;
+    Elf64_Sym *symtab;
+    Elf64_Rela *rela;
+    char *strtab, *shstrtab;
+    size_t *symmap, *rela_of;
+    size_t shnum, rela_count, symtab_index, syms_count, locals, strtab_len,
+           shstrtab_len, sh_offset, written;
+    compress_job_t *jobs;
     FILE *fd;
-    int to8;
+    int seekable, failed;
+
+    /*
+     * Debug sections are compressed by worker threads while the rest of the
+     * file is laid out and written, they go after the other sections.
+     */
+    jobs = calloc(obj->section_count, sizeof(compress_job_t));
+    for (int i = 1; i < obj->section_count; i++) {
+        section_t *sec = &(obj->sections[i]);
+
+        if (!obj->options->compress_debug || sec->type == SHT_NOBITS
+            || (sec->flags & SHF_ALLOC) || !sec->size
+            || strncmp(sec->name, ".debug_", 7)) {
+            continue;
+        }
 
-    syms_count = obj->section_count + obj->label_count + obj->glabel_count;
-    to8 = 0;
+        jobs[i] = (compress_job_t){
+            .sec = sec, .type = obj->options->compress_debug
+        };
+        jobs[i].started = !pthread_create(&(jobs[i].thread), NULL,
+                                          compress_section, &(jobs[i]));
+        if (!jobs[i].started) {
+            compress_section(&(jobs[i]));
+        }
+    }
 
-    strtab_len = 1; /* first zero */
-    for (int i = 0; i < obj->strtab_count; i++) {
-        strtab_len += strlen(obj->strtab[i]) + 1;
+    /*
+     * The sections, a .rela section for every one with relocations, then
+     * .symtab, .strtab and .shstrtab.
+     */
+    rela_of = malloc(obj->section_count * sizeof(size_t));
+    rela_count = 0;
+    for (int i = 1; i < obj->section_count; i++) {
+        if (obj->sections[i].reloc_count) {
+            rela_of[rela_count++] = i;
+        }
     }
+    symtab_index = obj->section_count + rela_count;
+    shnum = symtab_index + 3;
 
     shstrtab_len = 1; /* first zero */
-    for (int i = 0; i < obj->shstrtab_count; i++) {
-        shstrtab_len += strlen(obj->shstrtab[i]) + 1;
+    for (int i = 1; i < obj->section_count; i++) {
+        shstrtab_len += strlen(obj->sections[i].name) + 1;
     }
+    for (int i = 0; i < rela_count; i++) {
+        shstrtab_len += strlen(".rela") + strlen(obj->sections[rela_of[i]].name) + 1;
+    }
+    shstrtab_len += sizeof(".symtab") + sizeof(".strtab") + sizeof(".shstrtab");
 
-    raw_obj = malloc(sizeof(Elf64_Ehdr) + ALIGNTO8(obj->assembly_size)
-                     + (sizeof(Elf64_Sym) * syms_count)
-                     + strtab_len + shstrtab_len
-                     + (sizeof(Elf64_Shdr) * obj->shdr_count)
-    );
-    raw_obj_len = 0;
-    memcpy(raw_obj, obj->ehdr, sizeof(Elf64_Ehdr));
-    raw_obj_len += sizeof(Elf64_Ehdr);
+    shdrs = calloc(shnum, sizeof(Elf64_Shdr));
+    shstrtab = malloc(shstrtab_len);
+    shstrtab_len = 0;
+    shstrtab[shstrtab_len++] = '\0';
+    for (int i = 1; i < shnum; i++) {
+        shdrs[i].sh_name = shstrtab_len;
+        if (i < obj->section_count) {
+            strcpy(shstrtab + shstrtab_len, obj->sections[i].name);
+        }
+        else if (i < symtab_index) {
+            strcpy(shstrtab + shstrtab_len, ".rela");
+            strcat(shstrtab + shstrtab_len,
+                   obj->sections[rela_of[i - obj->section_count]].name);
+        }
+        else {
+            strcpy(shstrtab + shstrtab_len,
+                   (const char *[]){ ".symtab", ".strtab", ".shstrtab" }
+                                   [i - symtab_index]);
+        }
+        shstrtab_len += strlen(shstrtab + shstrtab_len) + 1;
+    }
+
+    /*
+     * The symbol table starts with the null and section symbols, then every
+     * other LOCAL symbol, then the GLOBAL ones. Assembler locals (`.L*`)
+     * are not written, and symbols that are never defined are GLOBAL.
+     */
+    strtab_len = 1;
+    for (int i = 0; i < obj->sym_count; i++) {
+        strtab_len += strlen(obj->syms[i].name) + 1;
+    }
+    strtab = malloc(strtab_len);
+    strtab_len = 0;
+    strtab[strtab_len++] = '\0';
+
+    symmap = calloc(obj->sym_count + 1, sizeof(size_t));
+    symtab = malloc((obj->section_count + obj->sym_count) * sizeof(Elf64_Sym));
+    syms_count = locals = 0;
+    symtab[syms_count++] = (Elf64_Sym){};
+    for (int i = 1; i < obj->section_count; i++) {
+        symtab[syms_count++] = (Elf64_Sym){
+            .st_name = 0, .st_info = ELF64_ST_INFO(STB_LOCAL, STT_SECTION),
+            .st_other = STV_DEFAULT, .st_shndx = i, .st_value = 0, .st_size = 0
+        };
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass) {
+            locals = syms_count;
+        }
+
+        for (int i = 0; i < obj->sym_count; i++) {
+            symbol_t *sym;
+            int local;
+
+            sym = &(obj->syms[i]);
+            if (sym->local && !sym->defined) {
+                fprintf(stderr, "Error: local symbol `%s` is never defined.\n",
+                        sym->name);
+                goto FREE_TABS_ERROR;
+            }
+            local = ELF64_ST_BIND(sym->sym.st_info) == STB_LOCAL
+                    && sym->defined;
+            if (local == pass) {
+                continue;
+            }
+            if (local && !strncmp(sym->name, ".L", 2)) {
+                continue;
+            }
 
-    if (obj->assembly) {
-        memcpy(raw_obj + raw_obj_len, obj->assembly, obj->assembly_size);
-        raw_obj_len += obj->assembly_size;
-        free(obj->assembly);
-        /* align the assembly code */
-        if (obj->assembly_size % 8) {
-            to8 = 8 - (obj->assembly_size % 8);
-            for (int i = 0; i < to8; i++) {
-                raw_obj[raw_obj_len] = 0;
-                raw_obj_len++;
+            symmap[i] = syms_count;
+            symtab[syms_count] = sym->sym;
+            symtab[syms_count].st_name = strtab_len;
+            if (!sym->defined) {
+                symtab[syms_count].st_info =
+                    ELF64_ST_INFO(ELF64_ST_BIND(sym->sym.st_info) == STB_WEAK
+                                  ? STB_WEAK : STB_GLOBAL,
+                                  ELF64_ST_TYPE(sym->sym.st_info));
             }
+            strcpy(strtab + strtab_len, sym->name);
+            strtab_len += strlen(sym->name) + 1;
+            syms_count++;
         }
     }
 
-    for (int i = 0; i < syms_count; i++) {
-        memcpy(raw_obj + raw_obj_len, &(obj->syms[i]), sizeof(Elf64_Sym));
-        raw_obj_len += sizeof(Elf64_Sym);
+    sh_offset = sizeof(Elf64_Ehdr);
+    for (int i = 1; i < obj->section_count; i++) {
+        section_t *sec;
+
+        sec = &(obj->sections[i]);
+        if (jobs[i].sec) {
+            continue;
+        }
+        if (sh_offset % sec->addralign) {
+            sh_offset += sec->addralign - (sh_offset % sec->addralign);
+        }
+
+        shdrs[i].sh_type = sec->type;
+        shdrs[i].sh_flags = sec->flags;
+        shdrs[i].sh_offset = sh_offset;
+        shdrs[i].sh_size = sec->size;
+        shdrs[i].sh_addralign = sec->addralign;
+        shdrs[i].sh_entsize = sec->entsize;
+        if (sec->type != SHT_NOBITS) {
+            sh_offset += sec->size;
+        }
     }
 
-    raw_obj[raw_obj_len] = '\0';
-    raw_obj_len++;
-    for (int i = 0; i < obj->strtab_count; i++) {
-        size_t current_str_len = strlen(obj->strtab[i]) + 1;
-        memcpy(raw_obj + raw_obj_len, obj->strtab[i], current_str_len);
-        raw_obj_len += current_str_len;
+    fd = fopen(outfile, "w");
+    if (fd == NULL) {
+        fprintf(stderr, "Failed to open `%s`.\n", outfile);
+        goto FREE_TABS_ERROR;
     }
-    
-    raw_obj[raw_obj_len] = '\0';
-    raw_obj_len++;
-    for (int i = 0; i < obj->shstrtab_count; i++) {
-        size_t current_str_len = strlen(obj->shstrtab[i]) + 1;
-        memcpy(raw_obj + raw_obj_len, obj->shstrtab[i], current_str_len);
-        raw_obj_len += current_str_len;
+
+    /*
+     * The header is written last, once e_shoff is known, and the other
+     * sections while the debug ones are still being compressed. A pipe
+     * can't be rewound to the header, so there the compression is waited
+     * for and the header goes first.
+     */
+    seekable = !fseeko(fd, 0, SEEK_CUR);
+    failed = 0;
+    written = 0;
+    if (seekable) {
+        failed |= write_padding(fd, sizeof(Elf64_Ehdr));
+        written = sizeof(Elf64_Ehdr);
+        failed |= write_sections(fd, obj, shdrs, jobs, 0, &written);
     }
-    /* align the assembly code */
-    if (obj->assembly_size % 8) {
-        to8 = 8 - (obj->assembly_size % 8) - 1;
-        for (int i = 0; i < to8; i++) {
-            raw_obj[raw_obj_len] = 0;
-            raw_obj_len++;
+
+    for (int i = 1; i < obj->section_count; i++) {
+        section_t *sec = &(obj->sections[i]);
+
+        if (!jobs[i].sec) {
+            continue;
+        }
+        if (jobs[i].started) {
+            pthread_join(jobs[i].thread, NULL);
+            jobs[i].started = 0;
+        }
+
+        shdrs[i].sh_type = sec->type;
+        shdrs[i].sh_flags = sec->flags;
+        shdrs[i].sh_size = sec->size;
+        shdrs[i].sh_addralign = sec->addralign;
+        shdrs[i].sh_entsize = sec->entsize;
+        if (jobs[i].data) {
+            /* the Elf64_Chdr keeps the section's own alignment */
+            shdrs[i].sh_flags |= SHF_COMPRESSED;
+            shdrs[i].sh_size = jobs[i].size;
+            shdrs[i].sh_addralign = 8;
+        }
+        if (sh_offset % shdrs[i].sh_addralign) {
+            sh_offset += shdrs[i].sh_addralign
+                       - (sh_offset % shdrs[i].sh_addralign);
         }
+        shdrs[i].sh_offset = sh_offset;
+        sh_offset += shdrs[i].sh_size;
     }
 
-    for (int i = 0; i < obj->shdr_count; i++) {
-        memcpy(raw_obj + raw_obj_len, &(obj->shdrs[i]), sizeof(Elf64_Shdr));
-        raw_obj_len += sizeof(Elf64_Shdr);
+    for (int i = 0; i < rela_count; i++) {
+        Elf64_Shdr *shdr = &(shdrs[obj->section_count + i]);
+
+        sh_offset = ALIGNTO8(sh_offset);
+        shdr->sh_type = SHT_RELA;
+        shdr->sh_flags = SHF_INFO_LINK;
+        shdr->sh_offset = sh_offset;
+        shdr->sh_size = obj->sections[rela_of[i]].reloc_count
+                      * sizeof(Elf64_Rela);
+        shdr->sh_link = symtab_index;
+        shdr->sh_info = rela_of[i];
+        shdr->sh_addralign = 8;
+        shdr->sh_entsize = sizeof(Elf64_Rela);
+        sh_offset += shdr->sh_size;
     }
 
-    fd = fopen(outfile, "w");
-    fwrite(raw_obj, raw_obj_len, 1, fd);
-    fclose(fd);
+    sh_offset = ALIGNTO8(sh_offset);
+    shdrs[symtab_index] = (Elf64_Shdr){
+        .sh_name = shdrs[symtab_index].sh_name, .sh_type = SHT_SYMTAB,
+        .sh_flags = 0, .sh_addr = 0, .sh_offset = sh_offset,
+        .sh_size = sizeof(Elf64_Sym) * syms_count, .sh_link = symtab_index + 1,
+        .sh_info = locals, /* The number of LOCAL symtabs */
+        .sh_addralign = 8, .sh_entsize = sizeof(Elf64_Sym)
+    };
+    sh_offset += shdrs[symtab_index].sh_size;
+
+    shdrs[symtab_index + 1] = (Elf64_Shdr){
+        .sh_name = shdrs[symtab_index + 1].sh_name, .sh_type = SHT_STRTAB,
+        .sh_flags = 0, .sh_addr = 0, .sh_offset = sh_offset,
+        .sh_size = strtab_len, .sh_link = 0, .sh_info = 0,
+        .sh_addralign = 1, .sh_entsize = 0
+    };
+    sh_offset += strtab_len;
+
+    shdrs[symtab_index + 2] = (Elf64_Shdr){
+        .sh_name = shdrs[symtab_index + 2].sh_name, .sh_type = SHT_STRTAB,
+        .sh_flags = 0, .sh_addr = 0, .sh_offset = sh_offset,
+        .sh_size = shstrtab_len, .sh_link = 0, .sh_info = 0,
+        .sh_addralign = 1, .sh_entsize = 0
+    };
+    sh_offset += shstrtab_len;
+
+    obj->ehdr->e_shoff = ALIGNTO8(sh_offset);
+    obj->ehdr->e_shnum = shnum;
+    obj->ehdr->e_shstrndx = symtab_index + 2;
+
+    if (!seekable) {
+        failed |= fwrite(obj->ehdr, sizeof(Elf64_Ehdr), 1, fd) != 1;
+        written = sizeof(Elf64_Ehdr);
+        failed |= write_sections(fd, obj, shdrs, jobs, 0, &written);
+    }
+    failed |= write_sections(fd, obj, shdrs, jobs, 1, &written);
+
+    for (int i = 0; i < rela_count; i++) {
+        section_t *sec = &(obj->sections[rela_of[i]]);
+
+        failed |= write_padding(fd, shdrs[obj->section_count + i].sh_offset
+                                    - written);
+        rela = malloc(sec->reloc_count * sizeof(Elf64_Rela));
+        for (int j = 0; j < sec->reloc_count; j++) {
+            reloc_t *reloc = &(sec->relocs[j]);
+
+            rela[j] = (Elf64_Rela){
+                .r_offset = reloc->offset,
+                .r_info = ELF64_R_INFO(reloc->sym ? symmap[reloc->sym - 1]
+                                                  : reloc->section,
+                                       reloc->type),
+                .r_addend = reloc->addend
+            };
+        }
+        failed |= fwrite(rela, sizeof(Elf64_Rela), sec->reloc_count, fd)
+                  != sec->reloc_count;
+        free(rela);
+        written = shdrs[obj->section_count + i].sh_offset
+                + shdrs[obj->section_count + i].sh_size;
+    }
+
+    failed |= write_padding(fd, shdrs[symtab_index].sh_offset - written);
+    failed |= fwrite(symtab, sizeof(Elf64_Sym), syms_count, fd) != syms_count;
+    failed |= fwrite(strtab, 1, strtab_len, fd) != strtab_len;
+    failed |= fwrite(shstrtab, 1, shstrtab_len, fd) != shstrtab_len;
+    failed |= write_padding(fd, obj->ehdr->e_shoff - sh_offset);
+    failed |= fwrite(shdrs, sizeof(Elf64_Shdr), shnum, fd) != shnum;
+    if (seekable) {
+        failed |= fseeko(fd, 0, SEEK_SET) != 0;
+        failed |= fwrite(obj->ehdr, sizeof(Elf64_Ehdr), 1, fd) != 1;
+    }
+
+    failed |= fclose(fd) != 0;
+    if (failed) {
+        fprintf(stderr, "Failed to write `%s`.\n", outfile);
+        goto FREE_TABS_ERROR;
+    }
+
+    for (int i = 1; i < obj->section_count; i++) {
+        free(jobs[i].data);
+    }
+    free(jobs);
+    free(symmap);
+    free(rela_of);
+    free(symtab);
+    free(strtab);
+    free(shstrtab);
+    free(shdrs);
+    return 0;
+
+FREE_TABS_ERROR:
+    for (int i = 1; i < obj->section_count; i++) {
+        if (jobs[i].started) {
+            pthread_join(jobs[i].thread, NULL);
+        }
+        free(jobs[i].data);
+    }
+    free(jobs);
+    free(symmap);
+    free(rela_of);
+    free(symtab);
+    free(strtab);
+    free(shstrtab);
+    free(shdrs);
+    return 1;
+}
+
+/*
+ * Copies an .incbin fragment into the output inside the kernel, with
+ * copy_file_range() or else sendfile(), falling back to writing the mapping.
+ */
+int write_blob(FILE *fd, frag_t *frag)
+{
+    off_t offset, position;
+    size_t left;
+    ssize_t n;
+    int out;
+
+    if (fflush(fd)) {
+        return 1;
+    }
+
+    out = fileno(fd);
+    offset = frag->offset;
+    left = frag->size;
+
+    while (left > 0) {
+        n = copy_file_range(frag->fd, &offset, out, NULL, left, 0);
+        if (n <= 0) {
+            break;
+        }
+        left -= n;
+    }
+    while (left > 0) {
+        n = sendfile(out, frag->fd, &offset, left);
+        if (n <= 0) {
+            break;
+        }
+        left -= n;
+    }
+    if (left > 0 && fwrite(frag->data + frag->size - left, 1, left, fd) != left) {
+        return 1;
+    }
+
+    /* bring the stream back in sync with the descriptor */
+    position = lseek(out, 0, SEEK_CUR);
+    if (position >= 0) {
+        fseeko(fd, position, SEEK_SET);
+    }
+
+    return 0;
+}
+
+int write_frags(FILE *fd, section_t *sec)
+{
+    for (size_t i = 0; i < sec->frag_count; i++) {
+        frag_t *frag = &(sec->frags[i]);
+
+        if (frag->type == FRAG_FILL) {
+            if (write_fill(fd, frag->pattern, frag->pattern_len,
+                           frag->size)) {
+                return 1;
+            }
+        }
+        else if (frag->type == FRAG_FILE) {
+            if (write_blob(fd, frag)) {
+                return 1;
+            }
+        }
+        else if (fwrite(frag->data, 1, frag->size, fd) != frag->size) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Writes `len` bytes of the repeated pattern without materializing them. */
+int write_fill(FILE *fd, const uint8_t *pattern, size_t pattern_len,
+               size_t len)
+{
+    uint8_t chunk[4096];
+    size_t chunk_len;
+    int zero;
+
+    zero = 1;
+    for (int i = 0; i < pattern_len; i++) {
+        zero &= !pattern[i];
+    }
+
+    /*
+     * Long runs of zeroes become a hole when the output is seekable, the
+     * section headers always follow so the file still gets extended.
+     */
+    if (zero && len >= sizeof(chunk) && !fflush(fd)
+        && !fseeko(fd, len, SEEK_CUR)) {
+        return 0;
+    }
+
+    chunk_len = sizeof(chunk) - sizeof(chunk) % pattern_len;
+    for (size_t i = 0; i < chunk_len; i += pattern_len) {
+        memcpy(chunk + i, pattern, pattern_len);
+    }
+
+    while (len > 0) {
+        size_t n = len < chunk_len ? len : chunk_len;
+
+        if (fwrite(chunk, 1, n, fd) != n) {
+            return 1;
+        }
+        len -= n;
+    }
+
+    return 0;
+}
+
+int write_padding(FILE *fd, size_t len)
+{
+    static const uint8_t zeros[64];
+
+    while (len > 0) {
+        size_t chunk = len < sizeof(zeros) ? len : sizeof(zeros);
+
+        if (fwrite(zeros, 1, chunk, fd) != chunk) {
+            return 1;
+        }
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+/*
+ * Writes the sections in the order of their offsets, the ones being
+ * compressed or the others, `written` the end of the file so far.
+ */
+int write_sections(FILE *fd, elf64_obj_t *obj, const Elf64_Shdr *shdrs,
+                   const compress_job_t *jobs, int compressed, size_t *written)
+{
+    for (int i = 1; i < obj->section_count; i++) {
+        if (shdrs[i].sh_type == SHT_NOBITS || !jobs[i].sec != !compressed) {
+            continue;
+        }
+        if (write_padding(fd, shdrs[i].sh_offset - *written)) {
+            return 1;
+        }
+        if (jobs[i].data) {
+            if (fwrite(jobs[i].data, 1, jobs[i].size, fd) != jobs[i].size) {
+                return 1;
+            }
+        }
+        else if (write_frags(fd, &(obj->sections[i]))) {
+            return 1;
+        }
+        *written = shdrs[i].sh_offset + shdrs[i].sh_size;
+    }
 
-    free(raw_obj);
     return 0;
 }
 
 int main(int argc, char **argv)
 {
     char *filename, *outfile;
+    options_t options;
+    int return_value;
 
     filename = outfile = NULL;
+    options = (options_t){};
 
     for (int i = 1; i < argc; i++) {
         if (argv[i][0] == '-') {
@@ -763,6 +9515,90 @@ int main(int argc, char **argv)
                 usage();
                 return 0;
             }
+            else if (!strcmp(argv[i], "-g") || !strcmp(argv[i], "--gen-debug")) {
+                options.debug = 1;
+            }
+            else if (!strcmp(argv[i], "--compress-debug-sections")
+                     || !strcmp(argv[i], "--compress-debug-sections=zlib")
+                     || !strcmp(argv[i], "--compress-debug-sections=zlib-gabi")) {
+                options.compress_debug = ELFCOMPRESS_ZLIB;
+            }
+            else if (!strcmp(argv[i], "--compress-debug-sections=zstd")) {
+                if (load_zstd()) {
+                    return 1;
+                }
+                options.compress_debug = ELFCOMPRESS_ZSTD;
+            }
+            else if (!strcmp(argv[i], "--compress-debug-sections=none")
+                     || !strcmp(argv[i], "--nocompress-debug-sections")) {
+                options.compress_debug = 0;
+            }
+            else if (!strcmp(argv[i], "-ffunction-sections")) {
+                options.function_sections = 1;
+            }
+            else if (!strcmp(argv[i], "--symbol-ordering-file")
+                     || !strncmp(argv[i], "--symbol-ordering-file=", 23)) {
+                char *order_file;
+
+                if (argv[i][22] == '=') {
+                    order_file = argv[i] + 23;
+                }
+                else if (++i < argc) {
+                    order_file = argv[i];
+                }
+                else {
+                    fprintf(stderr, "Option `--symbol-ordering-file` requires an argument.\n");
+                    return 1;
+                }
+
+                if (read_symbol_order(&options, order_file)) {
+                    return 1;
+                }
+            }
+            else if (!strcmp(argv[i], "-falign-loops")
+                     || !strncmp(argv[i], "-falign-loops=", 14)) {
+                char *end;
+
+                options.align_loops = 16;
+                if (argv[i][13] == '=') {
+                    options.align_loops = strtoull(argv[i] + 14, &end, 10);
+                    options.align_loops_max = options.align_loops;
+                    if (*end == ':') {
+                        options.align_loops_max = strtoull(end + 1, &end, 10);
+                    }
+                    if (*end || !options.align_loops
+                        || (options.align_loops & (options.align_loops - 1))) {
+                        fprintf(stderr, "Invalid value `%s` for `-falign-loops`.\n",
+                                argv[i] + 14);
+                        return 1;
+                    }
+                }
+                else {
+                    options.align_loops_max = options.align_loops;
+                }
+                if (options.align_loops_max) {
+                    options.align_loops_max--;
+                }
+
+                /*
+                 * N=1, or M=0 or 1, allows no padding at all, which the
+                 * aligns would take for `.p2align` without a limit
+                 */
+                if (!options.align_loops_max) {
+                    options.align_loops = 0;
+                }
+            }
+            else if (!strcmp(argv[i], "-O") || !strcmp(argv[i], "-O1")) {
+                options.optimize = 1;
+                options.optimize_space = 0;
+            }
+            else if (!strcmp(argv[i], "-O0")) {
+                options.optimize = options.optimize_space = 0;
+            }
+            else if (!strcmp(argv[i], "-O2") || !strcmp(argv[i], "-Os")) {
+                options.optimize = 2;
+                options.optimize_space = argv[i][2] == 's';
+            }
             else if (!strcmp(argv[i], "-o")) {
                 i++;
 
@@ -801,5 +9637,11 @@ int main(int argc, char **argv)
         outfile = OUTFILE_DEFAULT;
     }
 
-    return assemble_file(filename, outfile);
+    return_value = assemble_file(filename, outfile, &options);
+
+    for (size_t i = 0; i < options.order_count; i++) {
+        free(options.order[i]);
+    }
+    free(options.order);
+    return return_value;
 }
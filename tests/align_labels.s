@@ -0,0 +1,20 @@
+// labels right before an .align stay in front of the padding it gets once
+// the jumps before it are made short
+f:
+    jmp L2
+    .fill 11, 1, 0x90
+Lend:
+    .balign 16, 0xcc
+L2:
+    jmp L4
+    .fill 11, 1, 0x90
+    .p2align 5,, 8
+L3:
+    .p2align 5,, 10
+L4:
+    ret
+    .data
+    .quad Lend - f
+    .quad L2 - f
+    .quad L3 - f
+    .quad L4 - f
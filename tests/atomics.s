@@ -0,0 +1,40 @@
+// lock on every instruction that takes it, xadd, cmpxchg, cmpxchg8b and
+// cmpxchg16b with and without lock, and the fences
+    .text
+    lock addw $1, %fs:(%rax)
+    lock addl $1, (%eax)
+    lock xchg %rax, (%rdi)
+    lock
+    addl $1, (%rax)
+    lock incq (%rdi)
+    lock decb 4(%rsi)
+    lock notl (%rax)
+    lock negq (%r9)
+    lock orb $3, (%rbx)
+    lock andq %rax, (%rbx)
+    lock subl %r9d, 0x40(%rsp)
+    lock sbbw $300, (%rax)
+    lock adcq $-1, (%r12)
+    lock xorl $5, (%rcx)
+    lock btsq %rax, (%rdi)
+    lock btrl $3, (%rdi)
+    lock btcw %ax, (%rdi)
+    lock xaddq %rax, (%rdi)
+    lock xadd %r10d, 8(%r11)
+    lock xaddb %al, (%rdi)
+    lock cmpxchg %rcx, (%rdi)
+    lock cmpxchgl %r8d, (%r9,%r10,4)
+    lock cmpxchg %cl, (%rdi)
+    lock cmpxchgw %cx, (%rdi)
+    lock cmpxchg8b (%rdi)
+    lock cmpxchg16b (%rdi)
+    cmpxchg16b 16(%r8)
+    cmpxchg8b (%r8)
+    xadd %eax, %ebx
+    cmpxchg %rax, %rbx
+    xaddw %ax, %bx
+    lfence
+    mfence
+    sfence
+    pause
+    LOCK incl (%rax)
@@ -0,0 +1,146 @@
+// AVX, AVX2 and FMA3: two and three byte VEX prefixes, VEX.L for ymm, the
+// non-destructive vvvv source, and the registers that need the three byte form
+    .text
+    // AVX
+    vaddps %ymm1, %ymm2, %ymm3
+    vaddps %xmm1, %xmm2, %xmm3
+    vaddpd (%rax), %ymm2, %ymm3
+    vaddss %xmm1, %xmm2, %xmm3
+    vaddsd 8(%rax), %xmm2, %xmm3
+    vsubps %ymm8, %ymm9, %ymm10
+    vmulpd %ymm1, %ymm15, %ymm3
+    vdivps (%r8), %ymm2, %ymm3
+    vsqrtps %ymm1, %ymm2
+    vsqrtsd %xmm1, %xmm2, %xmm3
+    vrsqrtps %ymm1, %ymm2
+    vmaxps %ymm1, %ymm2, %ymm3
+    vandps %ymm1, %ymm2, %ymm3
+    vxorps %ymm0, %ymm0, %ymm0
+    vmovaps %ymm0, (%rsp)
+    vmovups (%rsi), %ymm1
+    vmovapd %ymm8, %ymm1
+    vmovdqa %ymm1, %ymm8
+    vmovdqu (%rdi,%rcx,4), %ymm12
+    vmovss (%rax), %xmm1
+    vmovss %xmm1, %xmm2, %xmm3
+    vmovsd %xmm1, (%rax)
+    vmovd %eax, %xmm1
+    vmovq %rax, %xmm1
+    vmovq %xmm1, %rax
+    vmovq %xmm1, %xmm2
+    vmovmskps %ymm1, %eax
+    vmovntps %ymm0, (%rdi)
+    vmovntdq %ymm0, (%rdi)
+    vmovddup %ymm1, %ymm2
+    vmovshdup (%rax), %ymm2
+    vbroadcastss (%rax), %ymm1
+    vbroadcastsd (%rax), %ymm1
+    vbroadcastf128 (%rax), %ymm1
+    vinsertf128 $1, %xmm1, %ymm2, %ymm3
+    vextractf128 $1, %ymm1, %xmm2
+    vextractf128 $1, %ymm1, (%rax)
+    vperm2f128 $0x31, %ymm1, %ymm2, %ymm3
+    vpermilps $0x1b, %ymm1, %ymm2
+    vpermilpd %ymm1, %ymm2, %ymm3
+    vshufps $0x44, %ymm1, %ymm2, %ymm3
+    vunpcklpd %ymm1, %ymm2, %ymm3
+    vblendps $0x0f, %ymm1, %ymm2, %ymm3
+    vblendvps %ymm4, %ymm1, %ymm2, %ymm3
+    vblendvpd %xmm12, (%rax), %xmm2, %xmm3
+    vcmpps $1, %ymm1, %ymm2, %ymm3
+    vcmpsd $0, %xmm1, %xmm2, %xmm3
+    vroundps $4, %ymm1, %ymm2
+    vdpps $0xff, %ymm1, %ymm2, %ymm3
+    vcvtdq2ps %ymm1, %ymm2
+    vcvtps2pd %xmm1, %ymm2
+    vcvtpd2psy %ymm1, %xmm2
+    vcvttpd2dqx %xmm1, %xmm2
+    vcvtsi2sd %rax, %xmm1, %xmm2
+    vcvttss2si %xmm1, %eax
+    vucomiss %xmm1, %xmm2
+    vtestps %ymm1, %ymm2
+    vptest %ymm1, %ymm2
+    vmaskmovps (%rax), %ymm1, %ymm2
+    vmaskmovpd %ymm1, %ymm2, (%rax)
+    vzeroupper
+    vzeroall
+    vldmxcsr (%rax)
+    vstmxcsr (%rax)
+    vpextrd $1, %xmm1, %eax
+    vpinsrq $1, %rax, %xmm1, %xmm2
+    vpshufb %xmm1, %xmm2, %xmm3
+
+    // AVX2
+    vpaddd %ymm1, %ymm2, %ymm3
+    vpaddq (%rax), %ymm2, %ymm3
+    vpsubb %ymm1, %ymm2, %ymm3
+    vpmulld %ymm1, %ymm2, %ymm3
+    vpmuludq %ymm1, %ymm2, %ymm3
+    vpmaddubsw %ymm1, %ymm2, %ymm3
+    vpsadbw %ymm1, %ymm2, %ymm3
+    vpxor %ymm9, %ymm9, %ymm9
+    vpand %ymm1, %ymm2, %ymm3
+    vpor %ymm1, %ymm2, %ymm3
+    vpcmpeqb %ymm1, %ymm2, %ymm3
+    vpcmpgtq %ymm1, %ymm2, %ymm3
+    vpminud %ymm1, %ymm2, %ymm3
+    vpmovmskb %ymm1, %eax
+    vpshufb %ymm1, %ymm2, %ymm3
+    vpshufd $0x1b, %ymm1, %ymm2
+    vpalignr $8, %ymm1, %ymm2, %ymm3
+    vpblendd $0xf0, %ymm1, %ymm2, %ymm3
+    vpblendvb %ymm4, %ymm1, %ymm2, %ymm3
+    vpslld $3, %ymm1, %ymm2
+    vpsrlq $1, %ymm1, %ymm2
+    vpsraw %xmm1, %ymm2, %ymm3
+    vpsllvd %ymm1, %ymm2, %ymm3
+    vpsrlvq %ymm1, %ymm2, %ymm3
+    vpsravd (%rax), %ymm2, %ymm3
+    vpslldq $4, %ymm1, %ymm2
+    vpermd %ymm1, %ymm2, %ymm3
+    vpermq $0x4e, %ymm1, %ymm2
+    vpermps %ymm1, %ymm2, %ymm3
+    vpermpd $0x1b, (%rax), %ymm2
+    vperm2i128 $0x20, %ymm1, %ymm2, %ymm3
+    vinserti128 $1, (%rax), %ymm2, %ymm3
+    vextracti128 $1, %ymm1, %xmm2
+    vpbroadcastb %xmm1, %ymm2
+    vpbroadcastd (%rax), %ymm2
+    vpbroadcastq %xmm1, %xmm2
+    vbroadcasti128 (%rax), %ymm1
+    vpmovzxbd %xmm1, %ymm2
+    vpmovsxwd (%rax), %ymm2
+    vpunpcklbw %ymm1, %ymm2, %ymm3
+    vpackusdw %ymm1, %ymm2, %ymm3
+    vpmaskmovd (%rax), %ymm1, %ymm2
+    vpmaskmovq %ymm1, %ymm2, (%rax)
+    vmovntdqa (%rax), %ymm1
+
+    // FMA3
+    vfmadd132ps %ymm1, %ymm2, %ymm3
+    vfmadd213pd (%rax), %ymm2, %ymm3
+    vfmadd231ss %xmm1, %xmm2, %xmm3
+    vfmadd231sd %xmm9, %xmm10, %xmm11
+    vfmsub132pd %ymm1, %ymm2, %ymm3
+    vfnmadd213ps %ymm1, %ymm2, %ymm3
+    vfnmsub231sd (%rax), %xmm2, %xmm3
+    vfmaddsub132ps %ymm1, %ymm2, %ymm3
+    vfmsubadd231pd %ymm1, %ymm2, %ymm3
+
+    // gathers address with a vector index, VSIB
+    vpgatherdd %ymm1, (%rax,%ymm2,4), %ymm3
+    vpgatherdd %xmm1, 8(%rax,%xmm2,4), %xmm3
+    vpgatherdq %ymm1, (%rax,%xmm2,8), %ymm3
+    vpgatherdq %xmm1, (%rax,%xmm2), %xmm3
+    vpgatherqd %xmm1, (%rax,%ymm2,4), %xmm3
+    vpgatherqd %xmm1, (%rax,%xmm2,4), %xmm3
+    vpgatherqq %ymm1, (%rax,%ymm2,8), %ymm3
+    vpgatherqq %xmm1, (%rax,%xmm2,8), %xmm3
+    vgatherdps %ymm9, 0x100(%r9,%ymm12,4), %ymm13
+    vgatherdps %xmm1, (%rax,%xmm4,4), %xmm3
+    vgatherdpd %ymm1, (%r13,%xmm2,8), %ymm3
+    vgatherdpd %xmm1, (,%xmm2,8), %xmm3
+    vgatherqps %xmm1, (%eax,%ymm2,4), %xmm3
+    vgatherqps %xmm1, -8(%rsp,%xmm10,4), %xmm3
+    vgatherqpd %ymm1, (%rbp,%ymm2,8), %ymm3
+    vgatherqpd %xmm1, sym(,%xmm2,8), %xmm3
@@ -0,0 +1,143 @@
+// EVEX forms: masking and zeroing, broadcasts, embedded rounding and SAE,
+// the upper 16 vector registers, and disp8*N scaled by the memory operand
+    .text
+    // masking, merging and zeroing
+    vaddps %zmm1, %zmm2, %zmm3
+    vaddps %zmm1, %zmm2, %zmm3{%k1}
+    vaddps %zmm1, %zmm2, %zmm3{%k7}{z}
+    vaddpd %ymm1, %ymm2, %ymm3{%k2}
+    vaddpd %xmm1, %xmm2, %xmm3{%k3}{z}
+    vmovdqu32 (%rax), %zmm0{%k1}{z}
+    vmovdqu64 %zmm0, (%rax){%k1}
+    vmovdqu8 %zmm1, %zmm2{%k4}
+    vmovdqu16 (%rcx,%rdx,2), %ymm5{%k5}{z}
+    vpaddd %zmm16, %zmm17, %zmm18{%k6}
+    vpaddq %zmm1, %zmm2, %zmm3{%k1}{z}
+    vpcmpeqd %zmm1, %zmm2, %k1
+    vpcmpeqd %zmm1, %zmm2, %k1{%k2}
+    vpcmpd $4, %zmm1, %zmm2, %k3
+    vpcmpuq $1, (%rax), %zmm2, %k3{%k4}
+    vpternlogd $0xff, %zmm1, %zmm2, %zmm3
+    vpternlogq $0x96, (%rax), %ymm2, %ymm3{%k1}
+    kmovw %k1, %k2
+    kmovq %k1, %rax
+    kmovd %eax, %k3
+    kmovb (%rax), %k4
+    kandw %k1, %k2, %k3
+    korq %k1, %k2, %k3
+    kxnord %k4, %k5, %k6
+    knotw %k1, %k2
+    kortestw %k1, %k2
+    kshiftlw $3, %k1, %k2
+    vpmovm2d %k1, %zmm0
+    vpmovd2m %zmm0, %k1
+    vpblendmd %zmm1, %zmm2, %zmm3{%k1}
+    vcompressps %zmm1, (%rax){%k1}
+    vexpandps (%rax), %zmm1{%k1}{z}
+
+    // broadcasts
+    vaddps (%rax){1to16}, %zmm1, %zmm2
+    vaddps (%rax){1to8}, %ymm1, %ymm2
+    vaddps (%rax){1to4}, %xmm1, %xmm2
+    vaddpd (%rax){1to8}, %zmm1, %zmm2
+    vaddpd (%rax){1to4}, %ymm1, %ymm2
+    vaddpd (%rax){1to2}, %xmm1, %xmm2
+    vpaddd 4(%rax){1to16}, %zmm1, %zmm2{%k1}
+    vpandq -8(%rax){1to8}, %zmm1, %zmm2
+    vfmadd231ps (%rax){1to16}, %zmm1, %zmm2
+    vcvtdq2ps (%rax){1to16}, %zmm1
+    vcvtpd2psy (%rax){1to4}, %xmm1
+    vcvtpd2ps (%rax){1to8}, %ymm1
+    vpbroadcastd %xmm1, %zmm2
+    vpbroadcastq %rax, %zmm2
+    vbroadcastss (%rax), %zmm3
+    vbroadcasti32x4 (%rax), %zmm3
+    vbroadcastf64x4 (%rax), %zmm3
+
+    // embedded rounding and suppress all exceptions
+    vaddps {rn-sae}, %zmm1, %zmm2, %zmm3
+    vaddps {rd-sae}, %zmm1, %zmm2, %zmm3
+    vaddps {ru-sae}, %zmm1, %zmm2, %zmm3
+    vaddps {rz-sae}, %zmm1, %zmm2, %zmm3
+    vaddsd {rn-sae}, %xmm1, %xmm2, %xmm3
+    vmulss {rz-sae}, %xmm1, %xmm2, %xmm3{%k1}{z}
+    vsqrtpd {ru-sae}, %zmm1, %zmm2
+    vcvtsi2ss %eax, {rn-sae}, %xmm1, %xmm2
+    vcvtps2dq {rd-sae}, %zmm1, %zmm2
+    vcvttps2dq {sae}, %zmm1, %zmm2
+    vmaxps {sae}, %zmm1, %zmm2, %zmm3
+    vcmpps $0, {sae}, %zmm1, %zmm2, %k1
+    vucomiss {sae}, %xmm1, %xmm2
+    vgetexpps {sae}, %zmm1, %zmm2
+    vrndscaleps $1, {sae}, %zmm1, %zmm2
+
+    // the upper registers
+    vaddps %xmm16, %xmm17, %xmm31
+    vaddps %ymm16, %ymm24, %ymm31
+    vaddps %zmm31, %zmm0, %zmm15
+    vmovaps %zmm16, %zmm8
+    vmovdqa64 %xmm31, %xmm0
+    vmovdqu32 (%r15), %ymm20
+    vpxord %zmm30, %zmm29, %zmm28
+    vmovd %eax, %xmm16
+    vmovq %xmm17, %rax
+    vpextrd $1, %xmm16, %eax
+    vpinsrq $1, %rax, %xmm17, %xmm18
+    vpshufd $0x1b, %zmm20, %zmm21
+    vpermd %zmm1, %zmm25, %zmm26
+    vaddps (%r8,%r9,4), %zmm17, %zmm18
+    vfmadd213pd %zmm16, %zmm17, %zmm18
+
+    // disp8*N: the displacement is scaled by the memory operand size
+    vmovaps 64(%rax), %zmm1
+    vmovaps -8192(%rax), %zmm1
+    vmovaps -8256(%rax), %zmm1
+    vmovaps 8128(%rax), %zmm1
+    vmovaps 8192(%rax), %zmm1
+    vmovaps 65(%rax), %zmm1
+    vmovaps 4064(%rax), %ymm1
+    vmovaps 4096(%rax), %ymm1
+    vmovaps 2032(%rax), %xmm17
+    vmovaps 2048(%rax), %xmm17
+    vaddps 508(%rax){1to16}, %zmm1, %zmm2
+    vaddps 512(%rax){1to16}, %zmm1, %zmm2
+    vaddpd 1016(%rax){1to8}, %zmm1, %zmm2
+    vaddpd 1024(%rax){1to8}, %zmm1, %zmm2
+    vaddss 508(%rax), %xmm16, %xmm17
+    vaddss 512(%rax), %xmm16, %xmm17
+    vaddsd -1024(%rax), %xmm16, %xmm17
+    vaddsd -1032(%rax), %xmm16, %xmm17
+    vpmovzxbd 1008(%rax), %zmm1
+    vpmovzxbd 1024(%rax), %zmm1
+    vbroadcasti32x4 2032(%rax), %zmm3
+    vbroadcasti32x4 2048(%rax), %zmm3
+    vextracti64x4 $1, %zmm1, 4064(%rax)
+    vextracti64x4 $1, %zmm1, 4096(%rax)
+    vmovddup 1016(%rax), %xmm17
+    vmovddup 1024(%rax), %xmm17
+
+    // gathers and scatters take a write mask
+    vpgatherdd (%rax,%zmm2,4), %zmm3{%k1}
+    vpgatherdd 64(%rax,%ymm18,4), %ymm3{%k1}
+    vpgatherdd -512(%r8,%xmm2,4), %xmm19{%k2}
+    vpgatherdd (%rax,%xmm2,4), %xmm3{%k1}
+    vpgatherdq 128(%rax,%ymm2,8), %zmm3{%k1}
+    vpgatherdq (%rax,%xmm2,8), %ymm3{%k1}
+    vpgatherdq (%rax,%xmm2,8), %xmm3{%k1}
+    vpgatherqd (%rax,%zmm2,4), %ymm3{%k1}
+    vpgatherqd (%rax,%ymm2,4), %xmm3{%k1}
+    vpgatherqd (%rax,%xmm2,4), %xmm3{%k1}
+    vpgatherqq (%rax,%zmm31,8), %zmm30{%k7}
+    vgatherdps (%rax,%zmm2,4), %zmm3{%k1}
+    vgatherdpd (%rax,%ymm2,8), %zmm3{%k1}
+    vgatherqps (%rax,%zmm2,4), %ymm3{%k1}
+    vgatherqpd (%rax,%zmm2,8), %zmm3{%k1}
+    vpscatterdd %zmm3, (%rax,%zmm2,4){%k1}
+    vpscatterdq %zmm3, 8(%rax,%ymm2,8){%k1}
+    vpscatterqd %ymm3, (%rax,%zmm2,4){%k1}
+    vpscatterqd %xmm3, (%rax,%ymm2,4){%k1}
+    vpscatterqq %zmm3, (%rax,%zmm20,8){%k1}
+    vscatterdps %zmm3, (%rax,%zmm2,4){%k1}
+    vscatterdpd %ymm3, (%rax,%xmm2,8){%k1}
+    vscatterqps %xmm3, (%rax,%xmm2,4){%k1}
+    vscatterqpd %zmm23, 1024(%r15,%zmm2,8){%k1}
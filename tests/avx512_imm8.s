@@ -0,0 +1,29 @@
+// the AVX-512F and AVX-512DQ forms with an imm8 selecting the operation,
+// with {sae}, masking, broadcast and disp8*N
+    .text
+    vfixupimmps $5, %zmm1, %zmm2, %zmm3
+    vfixupimmps $5, {sae}, %zmm1, %zmm2, %zmm3{%k1}{z}
+    vfixupimmpd $5, (%rax){1to4}, %ymm22, %ymm3
+    vfixupimmpd $5, 64(%rax), %xmm2, %xmm3
+    vfixupimmss $5, {sae}, %xmm1, %xmm2, %xmm3
+    vfixupimmsd $5, 8(%rax), %xmm2, %xmm19{%k2}
+    vrangeps $1, %zmm1, %zmm2, %zmm3
+    vrangepd $1, {sae}, %zmm1, %zmm2, %zmm3
+    vrangeps $1, 32(%rax), %ymm2, %ymm3
+    vrangess $1, 4(%rax), %xmm2, %xmm3
+    vrangesd $1, {sae}, %xmm1, %xmm2, %xmm3
+    vreduceps $2, %zmm1, %zmm2
+    vreducepd $2, {sae}, %zmm1, %zmm2
+    vreduceps $2, (%rax){1to8}, %ymm2
+    vreducess $2, %xmm1, %xmm2, %xmm3
+    vreducesd $2, {sae}, %xmm1, %xmm2, %xmm3{%k1}
+    vfpclassps $1, %zmm1, %k1
+    vfpclassps $1, %xmm1, %k1{%k2}
+    vfpclasspsx $1, (%rax), %k1
+    vfpclasspsy $1, 64(%rax), %k1
+    vfpclasspsz $1, (%rax), %k1
+    vfpclasspdz $1, (%rax){1to8}, %k1
+    vfpclasspdy $1, (%rax){1to4}, %k1
+    vfpclasspd $1, %ymm25, %k7
+    vfpclassss $1, (%rax), %k1
+    vfpclasssd $1, %xmm3, %k1{%k2}
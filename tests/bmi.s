@@ -0,0 +1,41 @@
+// POPCNT, LZCNT, TZCNT and ADX with their F3 and 66 prefixes, and the VEX
+// encoded BMI1 and BMI2, where VEX.W picks the 64-bit form
+    .text
+    popcnt %eax, %ebx
+    popcnt %ax, %r9w
+    popcntq (%rax), %r10
+    popcnt 0x10(%r12), %rcx
+    lzcnt %r8d, %eax
+    lzcntw (%rdx), %si
+    tzcnt %rax, %rbx
+    tzcntl 4(%rsp), %r15d
+    adcx %eax, %ebx
+    adcx (%r9), %r11
+    adox %rax, %rbx
+    adoxl (%rax), %ecx
+    andn %eax, %ebx, %ecx
+    andn (%r9), %r10, %r11
+    andn %r12, %r13, %rax
+    bextr %eax, %ebx, %ecx
+    bextr %r10, (%rsi), %r11
+    blsi %eax, %ebx
+    blsi (%rax), %r12
+    blsmsk %r9d, %r10d
+    blsr 8(%rbp), %rdx
+    bzhi %ecx, %ebx, %eax
+    bzhi %r15, 0x100(%r8,%r9,2), %rdi
+    pdep %eax, %ebx, %ecx
+    pdep (%r9), %r10, %r11
+    pext %r12d, %r13d, %r14d
+    pext %rax, %rbx, %rcx
+    mulx %eax, %ebx, %ecx
+    mulx (%r9), %r10, %r11
+    rorx $5, %eax, %ebx
+    rorx $63, (%r8), %r9
+    sarx %eax, %ebx, %ecx
+    sarx %r10, (%rsi), %r11
+    shlx %r9d, %r10d, %r11d
+    shlx %rax, %rbx, %rcx
+    shrx %eax, %ebx, %ecx
+    shrx %r15, %r14, %r13
+    andnl (%rax), %ebx, %ecx
@@ -0,0 +1,31 @@
+// prefetches, cache line flushes and non-temporal stores, with the
+// registers and addressing that need REX and a SIB byte
+    .text
+    prefetcht0 (%rax)
+    prefetcht1 64(%rdi)
+    prefetcht2 (%r8,%rcx,8)
+    prefetchnta 64(%rdi)
+    prefetchw (%rax)
+    prefetchw 128(%r12)
+    clflush (%rax)
+    clflush 0x40(%r9)
+    clflushopt (%rax)
+    clflushopt (%r11,%rdx)
+    clwb (%rax)
+    clwb -64(%r15)
+    movnti %eax, (%rdi)
+    movnti %rax, 8(%rdi)
+    movnti %r10d, (%r11)
+    movntdq %xmm0, (%rdi)
+    movntdq %xmm9, 16(%rdi)
+    movntps %xmm0, (%rdi)
+    movntpd %xmm1, (%rsi)
+    movntdqa (%rdi), %xmm0
+    vmovntdq %ymm0, (%rdi)
+    vmovntps %ymm12, 32(%rdi)
+    vmovntpd %xmm1, (%rsi)
+    vmovntdqa (%rdi), %ymm2
+    vmovntdq %zmm0, (%rdi)
+    vmovntdq %zmm17, 64(%rdi)
+    vmovntdqa 128(%rdi), %zmm3
+    sfence
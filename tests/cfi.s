@@ -0,0 +1,66 @@
+// .eh_frame and .debug_frame from the .cfi_* directives: functions with the
+// same leading instructions share a CIE, a personality or LSDA needs its own,
+// and the gaps between rows take advance_loc, advance_loc1 and advance_loc2
+    .cfi_sections .eh_frame, .debug_frame
+    .text
+f:
+    .cfi_startproc
+    pushq %rbp
+    .cfi_def_cfa_offset 16
+    .cfi_offset %rbp, -16
+    movq %rsp, %rbp
+    .cfi_def_cfa_register %rbp
+    .skip 100
+    popq %rbp
+    .cfi_def_cfa %rsp, 8
+    ret
+    .cfi_endproc
+
+g:
+    .cfi_startproc
+    .cfi_personality 0x9b, DW.ref.__gxx_personality_v0
+    .cfi_lsda 0x1b, .LLSDA0
+    subq $8, %rsp
+    .cfi_def_cfa_offset 16
+    .cfi_remember_state
+    je .Lslow
+    addq $8, %rsp
+    .cfi_def_cfa_offset 8
+    ret
+.Lslow:
+    .cfi_restore_state
+    .skip 300
+    pushq %rbx
+    .cfi_adjust_cfa_offset 8
+    .cfi_rel_offset %rbx, 0
+    popq %rbx
+    .cfi_adjust_cfa_offset -8
+    .cfi_restore %rbx
+    addq $8, %rsp
+    .cfi_def_cfa_offset 8
+    ret
+    .cfi_endproc
+
+h:
+    .cfi_startproc
+    .cfi_signal_frame
+    nop
+    .cfi_endproc
+
+k:
+    .cfi_startproc
+    .cfi_personality 0x9b, DW.ref.__gxx_personality_v0
+    .cfi_lsda 0x1b, .LLSDA1
+    nop
+    .cfi_endproc
+
+    .section .gcc_except_table, "a", @progbits
+.LLSDA0:
+    .byte 0xff
+.LLSDA1:
+    .byte 0xff
+
+    .data
+    .align 8
+DW.ref.__gxx_personality_v0:
+    .quad __gxx_personality_v0
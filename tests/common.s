@@ -0,0 +1,51 @@
+// .comm and .lcomm, with and without an alignment, and the alignment
+// directives with a fill value and a limit on the padding
+    .bss
+    .zero 1
+    .align 32
+b32:
+    .zero 3
+    .balign 16
+b16:
+
+    .comm buf, 4096, 64
+    .comm counter, 8
+    .comm flag, 1, 1
+    .local table
+    .comm table, 256, 32
+    .lcomm scratch, 100
+    .lcomm odd, 3
+
+    .text
+f:
+    ret
+    .align 16
+g:
+    ret
+    .p2align 5
+h:
+    ret
+    .p2align 4, , 3
+k:
+    ret
+    .p2align 4, , 15
+l:
+    ret
+    .balign 8, 0xcc
+m:
+    ret
+    movl table(%rip), %eax
+    movl counter(%rip), %eax
+
+    .data
+    .byte 1
+    .align 8
+d8:
+    .byte 2
+    .balign 4, 0xff
+d4:
+    .byte 3
+    .p2align 6
+d64:
+    .byte 4
+    .quad scratch, odd, buf
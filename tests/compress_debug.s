@@ -0,0 +1,48 @@
+// debug sections compressed with zlib and zstd, relocations included
+// compress: zlib zstd
+    .cfi_sections .debug_frame
+    .text
+    .globl f
+f:
+    .cfi_startproc
+    pushq %rbx
+    .cfi_def_cfa_offset 16
+    .cfi_offset %rbx, -16
+    movl %edi, %ebx
+    addl %ebx, %ebx
+    movl %ebx, %eax
+    popq %rbx
+    .cfi_def_cfa_offset 8
+    ret
+    .cfi_endproc
+.Lend:
+
+    .section .debug_str, "MS", @progbits, 1
+.Lproducer:
+    .string "GNU C17 -O2 -g -fno-asynchronous-unwind-tables"
+.Lname:
+    .string "compress.c compress.c compress.c compress.c compress.c"
+    .string "compress.c compress.c compress.c compress.c compress.c"
+    .string "compress.c compress.c compress.c compress.c compress.c"
+
+    .section .debug_aranges, "", @progbits
+    .long 0x2c
+    .value 2
+    .long 0
+    .byte 8
+    .byte 0
+    .value 0
+    .value 0
+    .quad f
+    .quad .Lend - f
+    .quad 0
+    .quad 0
+
+    .section .debug_ranges, "", @progbits
+    .quad f
+    .quad .Lend
+    .fill 32, 8, 0
+    .quad f
+    .quad .Lend
+    .quad 0
+    .quad 0
@@ -0,0 +1,49 @@
+// crc32 of each operand size, AES-NI, PCLMULQDQ and SHA, and the VEX and
+// EVEX forms of VAES and VPCLMULQDQ
+    .text
+    crc32b %al, %ecx
+    crc32b %r9b, %rcx
+    crc32b (%rdi), %r8d
+    crc32b %sil, %eax
+    crc32w %ax, %ecx
+    crc32w (%rax), %r15d
+    crc32l %eax, %ecx
+    crc32l 4(%rsp), %ecx
+    crc32q %rax, %rcx
+    crc32q (%r8), %r9
+    crc32 %al, %ecx
+    crc32 %ax, %ecx
+    crc32 %r10d, %ecx
+    crc32 %rax, %rbx
+    aesenc %xmm1, %xmm2
+    aesenclast (%rax), %xmm10
+    aesdec %xmm9, %xmm2
+    aesdeclast 16(%rdi), %xmm2
+    aesimc %xmm3, %xmm4
+    aeskeygenassist $1, %xmm1, %xmm2
+    pclmulqdq $0x11, %xmm1, %xmm2
+    pclmulqdq $0, (%rax), %xmm12
+    sha1rnds4 $3, %xmm1, %xmm2
+    sha1nexte %xmm1, %xmm2
+    sha1msg1 (%rax), %xmm9
+    sha1msg2 %xmm1, %xmm2
+    sha256rnds2 %xmm0, %xmm1, %xmm2
+    sha256rnds2 %xmm1, %xmm12
+    sha256msg1 %xmm1, %xmm2
+    sha256msg2 %xmm11, %xmm2
+    vaesenc %xmm1, %xmm2, %xmm3
+    vaesenc %ymm1, %ymm2, %ymm3
+    vaesenc %zmm1, %zmm2, %zmm3
+    vaesenc %xmm17, %xmm2, %xmm3
+    vaesenc 64(%rax), %zmm2, %zmm3
+    vaesenclast (%rax), %ymm12, %ymm3
+    vaesenclast %ymm21, %ymm2, %ymm3
+    vaesdec %zmm1, %zmm2, %zmm30
+    vaesdeclast 32(%rax), %ymm22, %ymm3
+    vaesimc %xmm1, %xmm2
+    vaeskeygenassist $4, (%rax), %xmm9
+    vpclmulqdq $1, %xmm1, %xmm2, %xmm3
+    vpclmulqdq $0x10, (%r9), %ymm2, %ymm13
+    vpclmulqdq $0x11, %zmm1, %zmm2, %zmm3
+    vpclmulqdq $0x11, 128(%rax), %zmm2, %zmm3
+    vpclmulqdq $0, %xmm16, %xmm2, %xmm3
@@ -0,0 +1,34 @@
+// .zero, .skip, .space and .fill, small ones written in place and large
+// ones kept as fill fragments, in code, data and .bss
+    .text
+f:
+    ret
+    .skip 3
+    .space 2, 0x90
+    .fill 3, 2, 0x1234
+    ret
+    .skip 300, 0xcc
+    ret
+
+    .data
+    .byte 1
+    .zero 5
+    .byte 2
+    .fill 2, 4, 0x11223344
+    .fill 3, 8, -1
+    .fill 2, 3, 0xabcdef
+    .fill 1, 1
+    .fill 0, 8, 1
+    .space 1000, 0x5a
+    .byte 3
+    .fill 100, 8, 0x01020304
+    .zero 4096
+    .byte 4
+    .fill 600, 3, 0x010203
+
+    .bss
+bss_start:
+    .zero 16
+    .skip 1 << 20
+    .fill 64, 4, 0
+bss_end:
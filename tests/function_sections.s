@@ -0,0 +1,15 @@
+// flags: -ffunction-sections
+// f falls through into g, so the two share .text.f; h starts after a ret
+    .text
+    .globl f, g, h
+    .type f, @function
+    .type g, @function
+    .type h, @function
+f:
+    mov $1, %eax
+g:
+    add $1, %eax
+    ret
+    .p2align 4
+h:
+    ret
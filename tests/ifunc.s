@@ -0,0 +1,37 @@
+// a GNU indirect function and its resolver, called, jumped to and taken the
+// address of from code and data, defined here and elsewhere
+    .text
+    .globl kernel
+    .type kernel, @gnu_indirect_function
+kernel:
+    leaq kernel_avx2(%rip), %rax
+    ret
+    .size kernel, .-kernel
+
+    .type local_kernel, %gnu_indirect_function
+local_kernel:
+    leaq kernel_avx512(%rip), %rax
+    ret
+
+    .type kernel_avx2, @function
+kernel_avx2:
+    ret
+    .type kernel_avx512, @function
+kernel_avx512:
+    ret
+
+    .globl caller
+    .type caller, @function
+caller:
+    call kernel
+    call local_kernel
+    call external_kernel@PLT
+    leaq kernel(%rip), %rax
+    movq external_kernel@GOTPCREL(%rip), %rax
+    jmp kernel
+    .size caller, .-caller
+
+    .type external_kernel, @gnu_indirect_function
+
+    .data
+    .quad kernel, local_kernel
@@ -0,0 +1,12 @@
+// .incbin of a whole file, from an offset, and a part of it, here this file
+    .data
+whole:
+    .incbin "incbin.s"
+    .byte 0
+from:
+    .incbin "incbin.s", 3
+    .balign 8
+part:
+    .incbin "incbin.s", 100, 10
+    .byte 1
+after:
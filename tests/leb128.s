@@ -0,0 +1,25 @@
+// .uleb128 and .sleb128 of constants and of label differences that only
+// settle once the jumps are relaxed, as in compiler generated DWARF
+    .text
+f:
+    jmp L2
+    .fill 120, 1, 0x90
+L1:
+    jmp f
+    .fill 200, 1, 0x90
+L2:
+    ret
+
+    .section .debug_loclists,"",@progbits
+    .uleb128 0, 127, 128, 624485
+    .sleb128 0, 63, 64, -64, -65, -123456
+    .uleb128 L1 - f, L2 - f, L2 - L1
+    .sleb128 f - L2
+    .uleb128 Lend - Lstart
+Lstart:
+    .uleb128 L2 - f
+    .value 0x1234
+Lend:
+
+    .ident "pasm test"
+    .section .note.GNU-stack,"",@progbits
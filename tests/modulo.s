@@ -0,0 +1,10 @@
+// `%` after an operand is the modulo, binding like `*` and `/`
+    .text
+f:
+    jmp L2
+    .fill 10, 1, 0x90
+L2:
+    movl $10%3, %eax
+    movl 17 % 5(%rax), %eax
+    addl $(L2-f)%8, %ecx
+    .long 10%3, 10 % 4, -7 % 3, (1+2)%2, 2*7%4, 9%4*3, 1+7%3
@@ -0,0 +1,55 @@
+// -O2 on vector code: zeroing idioms drop to 128 bits, EVEX forms that VEX
+// also has are made VEX, and commutative sources are swapped for the 2-byte
+// VEX prefix
+// flags: -O2
+    .text
+zeroing:
+    vpxor %ymm8, %ymm8, %ymm8
+    vpxor %ymm1, %ymm1, %ymm2
+    vxorps %ymm3, %ymm3, %ymm3
+    vxorpd %zmm3, %zmm3, %zmm3
+    vandnps %zmm1, %zmm1, %zmm1
+    vpandnq %ymm9, %ymm9, %ymm10
+    vpxord %zmm1, %zmm1, %zmm1
+    vpxord %zmm1, %zmm1, %zmm1{%k1}{z}
+    vpsubq %zmm1, %zmm1, %zmm1
+    vxorps %ymm23, %ymm23, %ymm3
+    kxorq %k1, %k1, %k2
+    kandnd %k3, %k3, %k1
+    // these keep what they are
+    vpxor %ymm1, %ymm2, %ymm2
+    vpxord %zmm1, %zmm1, %zmm1{%k1}
+    vpxorq %zmm17, %zmm17, %zmm17
+    vxorps %zmm3, %zmm3, %zmm20
+    vpaddq %zmm1, %zmm1, %zmm1
+
+evex:
+    vmovdqa64 %xmm1, %xmm2
+    vmovdqa32 %ymm1, %ymm2
+    vmovdqu8 %xmm1, %xmm2
+    vmovdqu16 (%rax), %ymm2
+    vmovdqu32 %ymm2, (%rax)
+    vmovdqu64 258(%rax), %xmm2
+    vpandq %ymm1, %ymm2, %ymm3
+    vpandnd %xmm1, %xmm2, %xmm3
+    vporq (%rax), %xmm2, %xmm3
+    vpxorq 32(%rax), %ymm2, %ymm3
+    // these keep what they are
+    vmovdqa64 %zmm1, %zmm2
+    vmovdqa64 %xmm17, %xmm2
+    vmovdqa64 %xmm1, %xmm2{%k1}
+    vmovdqu64 256(%rax), %xmm2
+    vmovdqa64 -4096(%rax), %ymm2
+    vpxord (%rax){1to8}, %ymm2, %ymm3
+    vpord %xmm1, %xmm2, %xmm19
+
+commutative:
+    vpand %xmm8, %xmm1, %xmm2
+    vpaddd %ymm8, %ymm1, %ymm2
+    vandps %xmm10, %xmm7, %xmm1
+    vpandd %xmm8, %xmm1, %xmm2
+    // these keep what they are
+    vpand %xmm8, %xmm1, %xmm9
+    vpand %xmm8, %xmm9, %xmm2
+    vaddps %xmm8, %xmm1, %xmm2
+    vpsubd %xmm8, %xmm1, %xmm2
@@ -0,0 +1,11 @@
+// pclmulqdq and vpclmulqdq named after the quadwords they multiply
+    .text
+    pclmullqlqdq %xmm1, %xmm2
+    pclmulhqlqdq (%rax), %xmm2
+    pclmullqhqdq %xmm9, %xmm2
+    pclmulhqhqdq %xmm1, %xmm10
+    vpclmullqlqdq %xmm1, %xmm2, %xmm3
+    vpclmulhqlqdq (%rax), %ymm2, %ymm3
+    vpclmullqhqdq %zmm1, %zmm2, %zmm3
+    vpclmulhqhqdq %xmm17, %xmm2, %xmm3
+    vpclmulhqhqdq 64(%rax), %zmm2, %zmm23
@@ -0,0 +1,27 @@
+// `@PLT` and `@GOTPCREL` pick the relocation, the linker may relax the GOT
+// loads that get R_X86_64_GOTPCRELX or R_X86_64_REX_GOTPCRELX
+    .text
+    .globl g
+g:
+    call foo@PLT
+    jmp foo@PLT
+    je foo@plt
+    call g@PLT
+    jmp l@PLT
+    movq foo@GOTPCREL(%rip), %rax
+    movl foo@GOTPCREL(%rip), %eax
+    movl foo@GOTPCREL(%rip), %r8d
+    movq foo@gotpcrel+8(%rip), %rax
+    call *foo@GOTPCREL(%rip)
+    jmp *foo@GOTPCREL(%rip)
+    addq foo@GOTPCREL(%rip), %rax
+    subl foo@GOTPCREL(%rip), %r9d
+    testq %rax, foo@GOTPCREL(%rip)
+    leaq foo@GOTPCREL(%rip), %rax
+    pushq foo@GOTPCREL(%rip)
+    movq %rax, foo@GOTPCREL(%rip)
+    movw foo@GOTPCREL(%rip), %ax
+    vmovq foo@GOTPCREL(%rip), %xmm0
+    movq l@GOTPCREL(%rip), %rax
+l:
+    ret
@@ -0,0 +1,14 @@
+// rep before nop, bsf and bsr, which makes pause, tzcnt and lzcnt
+    .text
+    rep nop
+    repe nop
+    repz nop
+    repnz nop
+    rep bsf %eax, %ecx
+    rep bsf (%rax), %cx
+    repz bsfq (%rax), %rcx
+    rep bsf %r9, %r10
+    rep bsr %eax, %ecx
+    rep bsrw %ax, %r8w
+    rep ret $8
+    rep ret
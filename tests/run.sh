@@ -0,0 +1,79 @@
+#!/bin/sh
+# Assembles each tests/*.s with pasm and compares what objdump and readelf -wf
+# make of it, symbols included, with tests/<name>.d, or with the output of GNU
+# as when there is none. The flags on a "// flags:" line of the source are
+# passed to the assemblers. For each method on a "// compress:" line, the
+# output with compressed debug sections, written to a file and to a pipe, must
+# decompress to the uncompressed output.
+
+dir=$(cd "$(dirname "$0")" && pwd)
+pasm=${PASM:-$dir/../pasm}
+tmp=$(mktemp -d)
+failed=0
+
+dump() {
+    objdump -drs "$1" | tail -n +3
+    readelf -wf "$1"
+
+    # without section symbols, pasm has one for each section
+    objdump -t "$1" | tail -n +5 | grep -v ' d  \|^no symbols$'
+}
+
+cd "$dir" || exit 1
+for src in *.s; do
+    name=${src%.s}
+    flags=$(sed -n 's|^// flags: *||p' "$src")
+
+    if ! "$pasm" $flags "$src" -o "$tmp/$name.o" > "$tmp/$name.out"; then
+        echo "FAIL $name: pasm failed"
+        failed=$((failed + 1))
+        continue
+    fi
+    if [ -s "$tmp/$name.out" ]; then
+        echo "FAIL $name: pasm wrote to stdout"
+        failed=$((failed + 1))
+        continue
+    fi
+    dump "$tmp/$name.o" > "$tmp/$name.pasm"
+
+    if [ -f "$name.d" ]; then
+        cp "$name.d" "$tmp/$name.want"
+    elif as $flags "$src" -o "$tmp/$name.gas.o"; then
+        dump "$tmp/$name.gas.o" > "$tmp/$name.want"
+    else
+        echo "FAIL $name: as failed"
+        failed=$((failed + 1))
+        continue
+    fi
+
+    if ! diff -u "$tmp/$name.want" "$tmp/$name.pasm"; then
+        echo "FAIL $name"
+        failed=$((failed + 1))
+        continue
+    fi
+
+    methods=$(sed -n 's|^// compress: *||p' "$src")
+    for method in $methods; do
+        flag=--compress-debug-sections=$method
+        objcopy --decompress-debug-sections "$tmp/$name.o" \
+            "$tmp/$name.plain.o" &&
+        "$pasm" $flags $flag "$src" -o "$tmp/$name.$method.o" &&
+        "$pasm" $flags $flag "$src" -o /dev/fd/1 | cat > "$tmp/$name.pipe.o" &&
+        objcopy --decompress-debug-sections "$tmp/$name.$method.o" \
+            "$tmp/$name.file.o" &&
+        objcopy --decompress-debug-sections "$tmp/$name.pipe.o" \
+            "$tmp/$name.pipe.o" &&
+        cmp "$tmp/$name.plain.o" "$tmp/$name.file.o" &&
+        cmp "$tmp/$name.plain.o" "$tmp/$name.pipe.o"
+        if [ $? -ne 0 ]; then
+            echo "FAIL $name: $method"
+            failed=$((failed + 1))
+            continue 2
+        fi
+    done
+
+    echo "ok   $name"
+done
+
+rm -rf "$tmp"
+[ "$failed" -eq 0 ]
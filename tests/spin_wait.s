@@ -0,0 +1,24 @@
+// pause, tpause, umonitor and umwait, and xbegin whose rel32 target may be
+// behind, ahead, global or undefined
+    .text
+    .globl g
+f:
+    pause
+    tpause %eax
+    tpause %r9d
+    umonitor %rax
+    umonitor %r10
+    umwait %ecx
+    umwait %r11d
+    xbegin .Lfallback
+    xbegin f
+    nop
+.Lfallback:
+    xbegin g
+    xbegin ext
+    xend
+    xabort $5
+    xabort $0xff
+    xtest
+g:
+    ret
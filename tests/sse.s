@@ -0,0 +1,153 @@
+// SSE through SSE4.2: the 66, F2 and F3 prefixes before REX, the 0F38 and
+// 0F3A maps, immediates, and the registers that need REX.R or REX.B
+    .text
+    // SSE
+    addps %xmm1, %xmm2
+    addss (%rax), %xmm9
+    subps 16(%rsp), %xmm3
+    mulss %xmm15, %xmm0
+    divps (%rdi,%rcx,4), %xmm4
+    sqrtss %xmm1, %xmm2
+    rsqrtps %xmm1, %xmm2
+    rcpss (%rax), %xmm2
+    maxps %xmm8, %xmm9
+    minss %xmm1, %xmm2
+    andps %xmm1, %xmm2
+    andnps %xmm1, %xmm2
+    orps %xmm1, %xmm2
+    xorps %xmm10, %xmm10
+    movaps %xmm0, 16(%rsp)
+    movups (%rsi), %xmm1
+    movss %xmm1, %xmm2
+    movss (%rax), %xmm12
+    movss %xmm3, (%rax)
+    movhlps %xmm1, %xmm2
+    movlhps %xmm1, %xmm2
+    movlps (%rax), %xmm1
+    movhps %xmm1, (%rax)
+    movmskps %xmm9, %eax
+    shufps $0x44, %xmm1, %xmm2
+    unpcklps %xmm1, %xmm2
+    unpckhps (%rax), %xmm2
+    cmpps $1, %xmm1, %xmm2
+    cmpss $7, (%rax), %xmm2
+    comiss %xmm1, %xmm2
+    ucomiss (%rax), %xmm2
+    cvtsi2ss %eax, %xmm0
+    cvtsi2ss %rax, %xmm8
+    cvtss2si %xmm0, %eax
+    cvttss2si %xmm0, %r9
+    ldmxcsr (%rax)
+    stmxcsr 4(%rsp)
+
+    // SSE2
+    addpd (%rax), %xmm3
+    addsd %xmm1, %xmm2
+    movapd %xmm1, %xmm2
+    movupd %xmm1, (%rax)
+    movsd (%rax), %xmm1
+    movsd %xmm14, %xmm15
+    movdqa (%rdi,%rcx,8), %xmm12
+    movdqu %xmm1, (%rsi)
+    movd %eax, %xmm0
+    movd %xmm0, (%rax)
+    movq %rax, %xmm0
+    movq %xmm0, %rax
+    movq %xmm1, %xmm2
+    movq (%rax), %xmm8
+    movq %xmm8, (%rax)
+    pxor %xmm0, %xmm0
+    paddb %xmm1, %xmm2
+    paddw %xmm1, %xmm2
+    paddd %xmm1, %xmm2
+    paddq (%rax), %xmm2
+    psubusb %xmm1, %xmm2
+    pmullw %xmm1, %xmm2
+    pmuludq %xmm1, %xmm2
+    pmaddwd %xmm1, %xmm2
+    psadbw %xmm1, %xmm2
+    pcmpeqb %xmm1, %xmm2
+    pcmpgtd %xmm1, %xmm2
+    pand %xmm1, %xmm2
+    pandn %xmm1, %xmm2
+    por %xmm1, %xmm2
+    pmovmskb %xmm0, %eax
+    pshufd $0x1b, %xmm1, %xmm2
+    pshuflw $0x1b, (%rax), %xmm2
+    pshufhw $0x1b, %xmm1, %xmm10
+    psllw $3, %xmm1
+    psrld $4, %xmm9
+    psraw %xmm1, %xmm2
+    psllq $63, %xmm1
+    pslldq $8, %xmm1
+    psrldq $4, %xmm15
+    punpcklbw %xmm1, %xmm2
+    punpckhqdq %xmm1, %xmm2
+    packsswb %xmm1, %xmm2
+    packuswb %xmm1, %xmm2
+    pextrw $3, %xmm1, %eax
+    pinsrw $3, %eax, %xmm1
+    shufpd $1, %xmm1, %xmm2
+    cvtsi2sd %rax, %xmm0
+    cvttsd2si %xmm0, %rax
+    cvtsd2ss %xmm1, %xmm2
+    cvtss2sd (%rax), %xmm2
+    cvtdq2ps %xmm1, %xmm2
+    cvttps2dq %xmm1, %xmm2
+    cvtpd2dq %xmm1, %xmm2
+    sqrtpd %xmm1, %xmm2
+    ucomisd %xmm1, %xmm2
+    maskmovdqu %xmm1, %xmm2
+
+    // SSE3 and SSSE3
+    addsubps %xmm1, %xmm2
+    haddpd %xmm1, %xmm2
+    hsubps (%rax), %xmm2
+    movddup %xmm1, %xmm2
+    movshdup %xmm1, %xmm2
+    movsldup (%rax), %xmm2
+    lddqu (%rax), %xmm1
+    pshufb %xmm1, %xmm2
+    pshufb (%rax), %xmm10
+    phaddd %xmm1, %xmm2
+    pmaddubsw %xmm1, %xmm2
+    pmulhrsw %xmm1, %xmm2
+    pabsb %xmm1, %xmm2
+    psignd %xmm1, %xmm2
+    palignr $8, %xmm1, %xmm2
+    palignr $15, (%rax), %xmm11
+
+    // SSE4.1 and SSE4.2
+    pmulld %xmm3, %xmm4
+    pmuldq %xmm1, %xmm2
+    pminsb %xmm1, %xmm2
+    pmaxud %xmm1, %xmm2
+    ptest %xmm1, %xmm2
+    pcmpeqq %xmm1, %xmm2
+    pcmpgtq %xmm1, %xmm2
+    packusdw %xmm1, %xmm2
+    pmovzxbw %xmm1, %xmm2
+    pmovsxdq (%rax), %xmm2
+    phminposuw %xmm1, %xmm2
+    blendps $5, %xmm1, %xmm2
+    pblendw $0xaa, %xmm1, %xmm2
+    blendvps %xmm0, %xmm1, %xmm2
+    blendvpd %xmm0, (%rax), %xmm2
+    pblendvb %xmm0, %xmm1, %xmm2
+    roundsd $4, %xmm1, %xmm2
+    roundps $1, (%rax), %xmm2
+    dpps $0xff, %xmm1, %xmm2
+    mpsadbw $0, %xmm1, %xmm2
+    insertps $0x10, %xmm1, %xmm2
+    extractps $1, %xmm1, %eax
+    pextrb $3, %xmm0, (%rax)
+    pextrd $1, %xmm0, %eax
+    pextrq $1, %xmm0, %rax
+    pinsrb $1, %eax, %xmm1
+    pinsrd $2, (%rax), %xmm1
+    pinsrq $1, %rax, %xmm0
+    movntdqa (%rdi), %xmm0
+    pcmpistri $0x0c, (%rdi), %xmm1
+    pcmpistrm $0x40, %xmm1, %xmm2
+    pcmpestri $0x0c, %xmm1, %xmm2
+    pcmpestrm $0, (%rax), %xmm2
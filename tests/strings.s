@@ -0,0 +1,15 @@
+// .ascii, .asciz and .string with several strings a line, strings long
+// enough for the block scan with escapes on and across block boundaries
+    .data
+    .ascii "plain"
+    .ascii "two", "strings"
+    .asciz "terminated"
+    .string "also terminated", ""
+    .ascii "\n\t\r\b\f\\\"\e"
+    .ascii "\0\7\101\1011\377\x41\x7e\xFF"
+    .asciz "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+    .asciz "0123456789abcde\n0123456789abcdef\t123456789abcdef0123456789abcde\\"
+    .asciz "\"0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcd\""
+    .ascii "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ\x30"
+    .ascii "a \"quoted\" word, a comma; a # sign and a // in a string"
+    .string "tab\there", "newline\n"
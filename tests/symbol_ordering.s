@@ -0,0 +1,15 @@
+// flags: --symbol-ordering-file=symbol_ordering.txt
+// g is listed, but f falls through into it, so f comes along right before
+    .text
+    .globl f, g, h
+    .type f, @function
+    .type g, @function
+    .type h, @function
+f:
+    mov $1, %eax
+g:
+    add $1, %eax
+    ret
+    .p2align 4
+h:
+    ret
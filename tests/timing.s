@@ -0,0 +1,16 @@
+// the instructions that fence and read the time stamp and performance
+// counters around a measured region
+    .text
+    cpuid
+    lfence
+    rdtsc
+    shlq $32, %rdx
+    orq %rdx, %rax
+    movq %rax, %r8
+    rdtscp
+    lfence
+    rdpmc
+    serialize
+    mfence
+    RDTSC
+    RDTSCP
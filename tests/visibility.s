@@ -0,0 +1,41 @@
+// .globl, .weak and .local bindings and the .hidden, .protected and
+// .internal visibilities, on defined and undefined symbols
+    .text
+    .globl f
+    .hidden f
+f:
+    call weak_undefined
+    call hidden_undefined
+    ret
+
+    .weak w
+w:
+    ret
+
+    .globl p
+    .protected p
+p:
+    ret
+
+    .globl i
+    .internal i
+i:
+    ret
+
+    .local l
+l:
+    ret
+
+    .globl g
+    .weak g
+    .hidden g
+g:
+    ret
+
+    .weak weak_undefined
+    .hidden hidden_undefined
+    .globl global_undefined, also_global
+    .hidden also_global
+
+    .data
+    .quad global_undefined, also_global